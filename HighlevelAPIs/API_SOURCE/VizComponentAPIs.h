@@ -355,6 +355,15 @@ namespace vzm
         LINEAR = 1,                 //!< Box filtering. Weighted average of 4 neighbors is used.
     };
 
+    //! Block compression of the images read by VzTexture (encoded on the CPU before the upload)
+    enum class TextureCompression : uint8_t {
+        NONE = 0,   //!< Uncompressed upload, the mipmaps are generated by the GPU (8-bit images) or stored as float levels.
+        BC7,        //!< Desktop GPUs.
+        ETC2,       //!< Mobile GPUs (OpenGL ES 3.0 and above).
+        ASTC,       //!< Mobile GPUs (4x4 blocks).
+        // the image is stored uncompressed (RGBA8) when the format is not supported by the device
+    };
+
     struct HitResult {
         float distance = FLT_MAX;
         float point[3] = {};
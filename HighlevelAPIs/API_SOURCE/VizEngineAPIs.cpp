@@ -21,6 +21,7 @@
 //#include "FIncludes.h"
 #include "backend/VzAssetLoader.h"
 #include "backend/VzAssetExporter.h"
+#include "backend/VzMappedFile.h"
 using namespace vzm;
 
 //////////////////////////////
@@ -193,9 +194,14 @@ namespace vzm
             gConfig.backend = filament::Engine::Backend::VULKAN;
             gConfig.vulkanGPUHint = arguments.GetParam("vulkan-gpu-hint", std::string("0"));
         }
+        else if (api == "noop")
+        {
+            // no rendering, for measuring the CPU side (benchmarks)
+            gConfig.backend = filament::Engine::Backend::NOOP;
+        }
         else
         {
-            backlog::post("Unrecognized backend. Must be 'opengl'|'vulkan'.", backlog::LogLevel::Error);
+            backlog::post("Unrecognized backend. Must be 'opengl'|'vulkan'|'noop'.", backlog::LogLevel::Error);
             return VZ_FAIL;
         }
 
@@ -220,6 +226,14 @@ namespace vzm
 
         gEngine->enableAccurateTranslations();
 
+        // program binaries are kept there across launches (before any material is built)
+        std::string blob_cache_dir = arguments.GetParam("blob-cache-dir", std::string(""));
+        if (!blob_cache_dir.empty())
+        {
+            const size_t capacity_mb = (size_t)std::strtoul(arguments.GetParam("blob-cache-size-mb", std::string("64")).c_str(), nullptr, 10);
+            gEngineApp->EnableBlobCache(blob_cache_dir, capacity_mb * 1024 * 1024);
+        }
+
         // this is to avoid the issue of filament safe-resource logic for Vulkan,
         // which assumes that there is at least one swapchain.
         gDummySwapChain = gEngine->createSwapChain((uint32_t)1, (uint32_t)1);
@@ -265,6 +279,17 @@ namespace vzm
 
         auto& ncm = VzNameCompManager::Get();
         gEngineApp->Initialize();
+        // packages built at runtime are kept there across launches (no on-disk cache if empty)
+        gEngineApp->GetMaterialCache().SetDirectory(arguments.GetParam("material-cache-dir", std::string("")));
+        // environments prefiltered from equirectangular images (no cache if empty)
+        gEngineApp->GetIBLCache().SetDirectory(arguments.GetParam("ibl-cache-dir", std::string("")));
+        // vertex cache, overdraw and vertex fetch optimization of the imported meshes
+        gEngineApp->importOptimizeMeshes = arguments.GetParam("mesh-optimize", std::string("false")) == "true";
+        // levels of detail of the imported meshes (none if 0)
+        VzEngineApp::LodSettings& lod_settings = gEngineApp->importLODs;
+        lod_settings.levelCount = (uint32_t)std::strtoul(arguments.GetParam("mesh-lod-levels", std::string("0")).c_str(), nullptr, 10);
+        lod_settings.reduction = std::strtof(arguments.GetParam("mesh-lod-reduction", std::string("0.5")).c_str(), nullptr);
+        lod_settings.maxError = std::strtof(arguments.GetParam("mesh-lod-max-error", std::string("0.05")).c_str(), nullptr);
 
         return VZ_OK;
     }
@@ -367,6 +392,22 @@ namespace vzm
         return gEngineApp->GetVidsByName(name, vids);
     }
 
+    size_t GetVidsByNamePattern(const std::string& pattern, std::vector<VID>& vids)
+    {
+        CHECK_API_VALIDITY(0);
+        return gEngineApp->GetVidsByNamePattern(pattern, vids);
+    }
+
+    size_t ForEachVidByName(const std::string& name, void (*callback)(VID vid, void* userData), void* userData)
+    {
+        CHECK_API_VALIDITY(0);
+        if (callback == nullptr)
+        {
+            return 0;
+        }
+        return gEngineApp->ForEachVidByName(name, [callback, userData](const VID vid) { callback(vid, userData); });
+    }
+
     bool GetNameByVid(const VID vid, std::string& name)
     {
         CHECK_API_VALIDITY(false);
@@ -594,6 +635,22 @@ namespace vzm
     filament::gltfio::FilamentAsset* loadAsset(const utils::Path& filename) {
 
         filament::gltfio::FilamentAsset* asset = nullptr;
+        VzAssetLoader* asset_loader = gEngineApp->GetGltfAssetLoader();
+
+        // Map the glTF file and parse it in place: the asset keeps the mapping alive, so the buffers
+        // handed over to the driver point into the mapped pages without a copy of the file.
+        // Falls back to reading the file when it cannot be mapped (GLB is limited to 4GB by its header).
+        std::shared_ptr<VzMappedFile> mapped = VzMappedFile::Open(filename.c_str());
+        if (mapped && mapped->GetSize() <= UINT32_MAX) {
+            const uint8_t* data = mapped->GetData();
+            const uint32_t size = (uint32_t)mapped->GetSize();
+            asset = asset_loader->createAsset(data, size, std::move(mapped));
+            if (!asset) {
+                backlog::post("Unable to parse " + std::string(filename.c_str()), backlog::LogLevel::Error);
+            }
+            return asset;
+        }
+        mapped.reset();
 
         // Peek at the file size to allow pre-allocation.
         long const contentSize = static_cast<long>(getFileSize(filename.c_str()));
@@ -611,7 +668,6 @@ namespace vzm
         }
 
         // Parse the glTF file and create Filament entities.
-        VzAssetLoader* asset_loader = gEngineApp->GetGltfAssetLoader();
         asset = asset_loader->createAsset(buffer.data(), buffer.size());
         if (!asset) {
             backlog::post("Unable to parse " + std::string(filename.c_str()), backlog::LogLevel::Error);
@@ -747,21 +803,14 @@ namespace vzm
             //asset_res.assetOwnershipComponents.insert(it.first); // already involved
         }
 
-        ResourceConfiguration configuration = {};
-        configuration.engine = gEngine;
-        configuration.gltfPath = path.c_str();
-        configuration.normalizeSkinningWeights = true;
-
-        ResourceLoader* resource_loader = gEngineApp->GetGltfResourceLoader();
-        resource_loader->setConfiguration(configuration);
-        if (!resource_loader->asyncBeginLoad(asset)) {
+        // the resources are loaded right away unless the load queue is full (see SetAssetLoadQueueConfig)
+        VzAssetLoadQueue* load_queue = gEngineApp->GetAssetLoadQueue();
+        if (!load_queue->Enqueue(vid_asset, path.c_str())) {
             asset_loader->destroyAsset((filament::gltfio::FFilamentAsset*)asset);
             backlog::post("Unable to start loading resources for " + filename, backlog::LogLevel::Error);
             return nullptr;
         }
 
-        gEngineApp->activeAsyncAsset = vid_asset;
-
         //auto& rcm = gEngine->getRenderableManager();
         //auto& lcm = gEngine->getLightManager();
         //auto& tcm = gEngine->getTransformManager();
@@ -793,13 +842,50 @@ namespace vzm
     float GetAsyncLoadProgress()
     {
         CHECK_API_VALIDITY(-1.f);
-        ResourceLoader* resource_loader = gEngineApp->GetGltfResourceLoader();
-        if (resource_loader == nullptr)
+        VzAssetLoadQueue* load_queue = gEngineApp->GetAssetLoadQueue();
+        if (load_queue == nullptr)
         {
             backlog::post("resource loader is not activated!", backlog::LogLevel::Error);
             return -1.f;
         }
-        return resource_loader->asyncGetLoadProgress();
+        return load_queue->GetProgress();
+    }
+
+    float GetAssetLoadProgress(const VID vidAsset)
+    {
+        CHECK_API_VALIDITY(-1.f);
+        return gEngineApp->GetAssetLoadQueue()->GetProgress(vidAsset);
+    }
+
+    bool SetAssetLoadPriority(const VID vidAsset, const int priority)
+    {
+        CHECK_API_VALIDITY(false);
+        return gEngineApp->GetAssetLoadQueue()->SetPriority(vidAsset, priority);
+    }
+
+    bool CancelAssetLoad(const VID vidAsset)
+    {
+        CHECK_API_VALIDITY(false);
+        return gEngineApp->GetAssetLoadQueue()->Cancel(vidAsset);
+    }
+
+    void SetAssetLoadQueueConfig(const size_t maxInFlight, const float uploadBudgetMs)
+    {
+        CHECK_API_VALIDITY( );
+        VzAssetLoadQueue* load_queue = gEngineApp->GetAssetLoadQueue();
+        load_queue->SetMaxInFlight(maxInFlight);
+        load_queue->SetUploadBudget(uploadBudgetMs);
+    }
+
+    void GetBlobCacheStats(size_t& hits, size_t& misses, size_t& bytesRead, size_t& bytesWritten)
+    {
+        hits = misses = bytesRead = bytesWritten = 0;
+        CHECK_API_VALIDITY( );
+        VzBlobCache::Stats stats = gEngineApp->GetBlobCache().GetStats();
+        hits = stats.hits;
+        misses = stats.misses;
+        bytesRead = stats.bytesRead;
+        bytesWritten = stats.bytesWritten;
     }
 
     void ReloadShader()
@@ -15,6 +15,14 @@ namespace vzm
     // Get Entity IDs whose name is the input name (VID is allowed for redundant name)
     //  - return # of entities
     extern "C" API_EXPORT size_t GetVidsByName(const std::string& name, std::vector<VID>& vids);
+    // Get Entity IDs whose name matches a glob pattern ('*' : any sequence, '?' : any single character)
+    //  - e.g., "Bone_*" for a prefix query
+    //  - return # of entities
+    extern "C" API_EXPORT size_t GetVidsByNamePattern(const std::string& pattern, std::vector<VID>& vids);
+    // Call the callback for each Entity ID whose name is the input name (no allocation)
+    //  - the callback must not rename or remove components
+    //  - return # of entities
+    extern "C" API_EXPORT size_t ForEachVidByName(const std::string& name, void (*callback)(VID vid, void* userData), void* userData = nullptr);
     // Get Entity's name if possible
     //  - return name string if entity's name exists, if not, return "" 
     extern "C" API_EXPORT bool GetNameByVid(const VID vid, std::string& name);
@@ -53,7 +61,19 @@ namespace vzm
     //  - the lifespan of resComponents follows that of the associated asset (vidAsset) and cannot be deleted by the client
     //  - return zero in case of failure
     extern "C" API_EXPORT VzAsset* LoadFileIntoAsset(const std::string& filename, const std::string& assetName);
+    // progress over all the assets whose resources are being loaded (1 if none)
     extern "C" API_EXPORT float GetAsyncLoadProgress();
+    // Asynchronous resource loads of the assets are queued, and up to maxInFlight (default 2) of them run at once
+    //  - higher priority loads start first and get the per-frame texture upload budget (default 4 ms) first
+    //  - GetAssetLoadProgress returns -1 if the asset is not queued (e.g., already loaded)
+    //  - a canceled asset keeps the resources loaded so far
+    extern "C" API_EXPORT float GetAssetLoadProgress(const VID vidAsset);
+    extern "C" API_EXPORT bool SetAssetLoadPriority(const VID vidAsset, const int priority);
+    extern "C" API_EXPORT bool CancelAssetLoad(const VID vidAsset);
+    extern "C" API_EXPORT void SetAssetLoadQueueConfig(const size_t maxInFlight, const float uploadBudgetMs);
+    // Counters of the program binary cache, enabled by InitEngineLib's "blob-cache-dir" argument
+    //  (with "blob-cache-size-mb", 64 by default)
+    extern "C" API_EXPORT void GetBlobCacheStats(size_t& hits, size_t& misses, size_t& bytesRead, size_t& bytesWritten);
     // Get a graphics render target view 
     //  - Must belong to the internal scene
     extern "C" API_EXPORT void* GetGraphicsSharedRenderTarget();
@@ -0,0 +1,113 @@
+#ifndef VZCOMPONENTPOOL_H
+#define VZCOMPONENTPOOL_H
+#include "VizComponentAPIs.h"
+
+#include <tsl/robin_map.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace vzm
+{
+    // dense per-VID storage (sparse-set style, as utils::SingleInstanceComponentManager)
+    //  - O(1) lookup through a VID-to-index map, elements are contiguous for iteration
+    //  - erase moves the last element into the erased slot, so the order is not preserved
+    //    and 'it = pool.erase(it)' keeps visiting the remaining elements
+    //  - iterators and element references are invalidated by insertion and erasure
+    //    (hold std::unique_ptr values for stable addresses)
+    template <typename T>
+    class VzComponentPool
+    {
+    public:
+        using value_type = std::pair<VID, T>;
+        using iterator = typename std::vector<value_type>::iterator;
+        using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    private:
+        std::vector<value_type> dense_;
+        tsl::robin_map<VID, uint32_t> indices_;
+
+        // the erased value is destroyed after the pool is consistent again,
+        // since a destructor may look up (or erase from) this pool
+        void removeAt(const size_t index)
+        {
+            // moved out here, destroyed when leaving the scope (after the swap-and-pop)
+            T removed = std::move(dense_[index].second);
+            indices_.erase(dense_[index].first);
+            const size_t last = dense_.size() - 1;
+            if (index != last)
+            {
+                dense_[index] = std::move(dense_[last]);
+                indices_[dense_[index].first] = (uint32_t)index;
+            }
+            dense_.pop_back();
+        }
+
+    public:
+        iterator begin() noexcept { return dense_.begin(); }
+        iterator end() noexcept { return dense_.end(); }
+        const_iterator begin() const noexcept { return dense_.begin(); }
+        const_iterator end() const noexcept { return dense_.end(); }
+        size_t size() const noexcept { return dense_.size(); }
+        bool empty() const noexcept { return dense_.empty(); }
+
+        iterator find(const VID vid)
+        {
+            auto it = indices_.find(vid);
+            return it == indices_.end() ? dense_.end() : dense_.begin() + it->second;
+        }
+        const_iterator find(const VID vid) const
+        {
+            auto it = indices_.find(vid);
+            return it == indices_.end() ? dense_.end() : dense_.begin() + it->second;
+        }
+        bool contains(const VID vid) const { return indices_.count(vid) > 0; }
+
+        // insertion may reallocate the elements, so every iterator and reference into the pool
+        // (including those of the other elements) is invalidated
+        template <typename... ARGS>
+        std::pair<iterator, bool> emplace(const VID vid, ARGS&&... args)
+        {
+            auto it = indices_.find(vid);
+            if (it != indices_.end())
+            {
+                return { dense_.begin() + it->second, false };
+            }
+            indices_[vid] = (uint32_t)dense_.size();
+            dense_.emplace_back(vid, T(std::forward<ARGS>(args)...));
+            return { dense_.end() - 1, true };
+        }
+        // inserts a default value if vid is not in the pool (see emplace)
+        T& operator[](const VID vid)
+        {
+            return emplace(vid).first->second;
+        }
+
+        // returns the iterator to the element moved into the erased slot, or end()
+        iterator erase(iterator it)
+        {
+            const size_t index = it - dense_.begin();
+            removeAt(index);
+            // the destructor of the erased value may have erased other elements
+            return dense_.begin() + std::min(index, dense_.size());
+        }
+        size_t erase(const VID vid)
+        {
+            auto it = indices_.find(vid);
+            if (it == indices_.end())
+            {
+                return 0;
+            }
+            removeAt(it->second);
+            return 1;
+        }
+        void clear()
+        {
+            std::vector<value_type> removed = std::move(dense_);
+            dense_.clear();
+            indices_.clear();
+        }
+    };
+}
+#endif
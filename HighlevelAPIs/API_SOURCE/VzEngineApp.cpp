@@ -143,12 +143,94 @@ namespace vzm
         }
         return lineMaxWidth;
     }
+    void VzTypesetter::place(VzFontRes* fontRes)
+    {
+        placements_.clear();
+        placedLines_.clear();
+        if (linesWidth.empty()) {
+            return;
+        }
+        TEXT_ALIGN textAlign = textFormat.textAlign;
+        int32_t numberOfLines = linesWidth.size();
+        int32_t lineX = GetLeftBlankWidth(textAlign, linesWidth[0], imageWidth);
+        int32_t lineY = GetTopBlankHeight(textAlign, textHeight, imageHeight);
+        int32_t lineWidthStack = 0;
+        int32_t lineHeight = fontRes->GetLineHeight();
+        int32_t lineIndex = 0;
+        int32_t baselineY = lineHeight * 3 / 4;
+        placedLines_.push_back({ 0, 0, INT32_MAX, INT32_MIN });
+        for (uint32_t glyphCode : glyphCodes) {
+            if (fontRes->IsNewLine(glyphCode)) {
+                continue;
+            }
+            const VzGlyph glyph = fontRes->GetGlyph(glyphCode);
+            GlyphPlacement placement = { glyphCode, lineX + glyph.bearingX, lineY + baselineY - glyph.bearingY };
+            PlacedLine& line = placedLines_.back();
+            line.count++;
+            if (glyph.layer >= 0) {
+                line.top = std::min(line.top, placement.y);
+                line.bottom = std::max(line.bottom, placement.y + glyph.height);
+            }
+            placements_.push_back(placement);
+
+            int32_t advanceX = glyph.advanceX + textFormat.kerning;
+            lineWidthStack += advanceX;
+            if (lineWidthStack < linesWidth[lineIndex]) {
+                lineX += advanceX;
+            } else {
+                lineWidthStack = 0;
+                lineIndex++;
+                if (lineIndex < numberOfLines) {
+                    lineX = GetLeftBlankWidth(textAlign, linesWidth[lineIndex], imageWidth);
+                    lineY += lineHeight;
+                }
+                placedLines_.push_back({ (uint32_t)placements_.size(), 0, INT32_MAX, INT32_MIN });
+            }
+        }
+        for (PlacedLine& line : placedLines_) {
+            // rows covered by the line, clipped to the text image
+            line.top = std::max(line.top, 0);
+            line.bottom = std::min(line.bottom, imageHeight);
+            if (line.top >= line.bottom) {
+                line.top = line.bottom = 0;
+            }
+        }
+    }
+    void VzTypesetter::blit(VzFontRes* fontRes, const PlacedLine& line, const int32_t rowBegin, const int32_t rowEnd)
+    {
+        const size_t pitch = fontRes->GetGlyphPixelsPitch();
+        for (uint32_t i = line.first, n = line.first + line.count; i < n; i++) {
+            const GlyphPlacement& placement = placements_[i];
+            const VzGlyph glyph = fontRes->GetGlyph(placement.glyphCode);
+            const uint8_t* glyphPixels = fontRes->GetGlyphPixels(glyph);
+            if (glyphPixels == nullptr) {
+                continue;
+            }
+            const int32_t glyphYBegin = std::max(rowBegin - placement.y, 0);
+            const int32_t glyphYEnd = std::min(rowEnd - placement.y, glyph.height);
+            for (int32_t glyphY = glyphYBegin; glyphY < glyphYEnd; glyphY++) {
+                int32_t y = placement.y + glyphY;
+                for (int32_t glyphX = 0; glyphX < glyph.width; glyphX++) {
+                    int32_t x = placement.x + glyphX;
+                    if ((x < 0) || (x >= imageWidth)) {
+                        continue;
+                    }
+                    size_t index = ((size_t)y * capacityWidth) + x;
+                    uint16_t pixel = pixels_[index];
+                    pixel += glyphPixels[(pitch * glyphY) + glyphX];
+                    pixel = (pixel < 0xff) ? pixel : 0xff;
+                    pixels_[index] = (uint8_t) pixel;
+                }
+            }
+        }
+    }
     void VzTypesetter::Typeset()
     {
         glyphCodes.clear();
         linesWidth.clear();
         textWidth = 0;
         textHeight = 0;
+        uploadedRows = 0;
         Measure();
         FontVID font = textFormat.font;
         if (font == INVALID_VID)
@@ -160,69 +242,101 @@ namespace vzm
         int32_t height = (fixedHeight > 0) ? fixedHeight : textHeight;
         width = max(width, 1);
         height = max(height, 1);
-        uint8_t* pixels = new uint8_t[width * height];
-        memset(pixels, 0, width * height);
-        if (!linesWidth.empty()) {
-            TEXT_ALIGN textAlign = textFormat.textAlign;
-            int32_t numberOfLines = linesWidth.size();
-            int32_t lineX = GetLeftBlankWidth(textAlign, linesWidth[0], width);
-            int32_t lineY = GetTopBlankHeight(textAlign, textHeight, height);
-            int32_t lineWidthStack = 0;
-            int32_t lineHeight = font_res->GetLineHeight();
-            int32_t lineIndex = 0;
-            int32_t baselineY = lineHeight * 3 / 4;
-            for (uint32_t glyphCode : glyphCodes) {
-                if (font_res->IsNewLine(glyphCode)) {
-                    continue;
-                }
-                int32_t bearingX = font_res->GetBearingX(glyphCode);
-                int32_t bearingY = baselineY - font_res->GetBearingY(glyphCode);
-                int32_t glyphWidth = font_res->GetGlyphWidth(glyphCode);
-                int32_t glyphHeight = font_res->GetGlyphHeight(glyphCode);
-                const uint8_t* glyphPixels = font_res->GetGlyphPixels(glyphCode);
-                for (int32_t glyphY = 0; glyphY < glyphHeight; glyphY++) {
-                    for (int32_t glyphX = 0; glyphX < glyphWidth; glyphX++) {
-                        int32_t x = lineX + glyphX + bearingX;
-                        int32_t y = lineY + glyphY + bearingY;
-                        if ((x < 0) || (x >= width) || (y < 0) || (y >= height)) {
-                            continue;
-                        }
-                        int32_t index = (y * width) + x;
-                        uint16_t pixel = pixels[index];
-                        pixel += glyphPixels[(glyphWidth * glyphY) + glyphX];
-                        pixel = (pixel < 0xff) ? pixel : 0xff;
-                        pixels[index] = (uint8_t) pixel;
+
+        const int32_t prev_image_height = imageHeight;
+        // glyphs are clipped to the text image width, so a different width requires to re-blit all the lines
+        bool all_dirty = width != imageWidth || font != prevFont_;
+        imageWidth = width;
+        imageHeight = height;
+
+        std::swap(placements_, prevPlacements_);
+        std::swap(placedLines_, prevPlacedLines_);
+        place(font_res);
+
+        // the texture is reallocated only when the text image does not fit
+        prevFont_ = font;
+        if (texture == nullptr || (uint32_t)width > capacityWidth || (uint32_t)height > capacityHeight) {
+            auto capacity = [](uint32_t size, uint32_t capacity) {
+                    capacity = std::max(capacity, 16u);
+                    while (capacity < size) {
+                        capacity <<= 1;
                     }
+                    return capacity;
+                };
+            capacityWidth = capacity(width, capacityWidth);
+            capacityHeight = capacity(height, capacityHeight);
+            pixels_.assign((size_t)capacityWidth * capacityHeight, 0);
+            // note the previous texture is owned (and destroyed) by the text sprite actor
+            texture = Texture::Builder()
+                .width(capacityWidth)
+                .height(capacityHeight)
+                .levels(0xff)
+                .format(Texture::InternalFormat::R8)
+                .sampler(Texture::Sampler::SAMPLER_2D)
+                .build(*gEngine);
+            all_dirty = true;
+        }
+
+        // dirty rows : the rows of the lines whose placements have changed (before and after)
+        int32_t dirty_begin = INT32_MAX;
+        int32_t dirty_end = INT32_MIN;
+        auto addDirtyRows = [&dirty_begin, &dirty_end](const int32_t top, const int32_t bottom) {
+                if (top < bottom) {
+                    dirty_begin = std::min(dirty_begin, top);
+                    dirty_end = std::max(dirty_end, bottom);
                 }
-                int32_t advanceX = font_res->GetAdvanceX(glyphCode) + textFormat.kerning;
-                lineWidthStack += advanceX;
-                if (lineWidthStack < linesWidth[lineIndex]) {
-                    lineX += advanceX;
-                } else {
-                    lineWidthStack = 0;
-                    lineIndex++;
-                    if (lineIndex < numberOfLines) {
-                        lineX = GetLeftBlankWidth(textAlign, linesWidth[lineIndex], width);
-                        lineY += lineHeight;
-                    }
+            };
+        if (all_dirty) {
+            addDirtyRows(0, capacityHeight);
+        } else {
+            // the rows out of the text image must be cleared
+            addDirtyRows(std::min(height, prev_image_height), std::max(height, prev_image_height));
+            const size_t num_lines = std::max(placedLines_.size(), prevPlacedLines_.size());
+            for (size_t i = 0; i < num_lines; i++) {
+                const PlacedLine* line = i < placedLines_.size() ? &placedLines_[i] : nullptr;
+                const PlacedLine* prev_line = i < prevPlacedLines_.size() ? &prevPlacedLines_[i] : nullptr;
+                bool dirty = line == nullptr || prev_line == nullptr || line->count != prev_line->count
+                    || line->top != prev_line->top || line->bottom != prev_line->bottom;
+                for (uint32_t k = 0; !dirty && k < line->count; k++) {
+                    dirty = !(placements_[line->first + k] == prevPlacements_[prev_line->first + k]);
+                }
+                if (dirty) {
+                    if (line) addDirtyRows(line->top, line->bottom);
+                    if (prev_line) addDirtyRows(prev_line->top, prev_line->bottom);
                 }
             }
         }
+        if (dirty_begin >= dirty_end) {
+            return;
+        }
+        dirty_begin = std::max(dirty_begin, 0);
+        dirty_end = std::min(dirty_end, (int32_t)capacityHeight);
+
+        // clear the dirty rows and re-blit the lines overlapping them
+        memset(&pixels_[(size_t)dirty_begin * capacityWidth], 0, (size_t)(dirty_end - dirty_begin) * capacityWidth);
+        for (const PlacedLine& line : placedLines_) {
+            const int32_t row_begin = std::max(line.top, dirty_begin);
+            const int32_t row_end = std::min(line.bottom, dirty_end);
+            if (row_begin < row_end) {
+                blit(font_res, line, row_begin, row_end);
+            }
+        }
+
+        uploadedRows = dirty_end - dirty_begin;
+        const size_t upload_size = (size_t)uploadedRows * capacityWidth;
+        uint8_t* upload_pixels = new uint8_t[upload_size];
+        memcpy(upload_pixels, &pixels_[(size_t)dirty_begin * capacityWidth], upload_size);
         PixelBufferDescriptor buffer(
-            pixels, width * height,
+            upload_pixels, upload_size,
             PixelDataFormat::R,
             PixelDataType::UBYTE,
             [](void* data, size_t, void*) { delete[] reinterpret_cast<uint8_t*>(data); }
         );
-        texture = Texture::Builder()
-            .width(width)
-            .height(height)
-            .levels(0xff)
-            .format(Texture::InternalFormat::R8)
-            .sampler(Texture::Sampler::SAMPLER_2D)
-            .build(*gEngine);
-        texture->setImage(*gEngine, 0, std::move(buffer));
-        texture->generateMipmaps(*gEngine);
+        texture->setImage(*gEngine, 0, 0, dirty_begin, capacityWidth, uploadedRows, std::move(buffer));
+        // the mip levels are regenerated only when the texels have changed
+        if (texture->getLevels() > 1) {
+            texture->generateMipmaps(*gEngine);
+        }
     }
     int32_t VzTypesetter::GetLeftBlankWidth(const TEXT_ALIGN textAlign, const int32_t lineWidth, const int32_t width)
     {
@@ -443,9 +557,28 @@ namespace vzm
                 }
             }
         }
+        // the LODs are always created by the geometry
+        destroyLODs();
+    }
+    void VzGeometryRes::destroyLODs()
+    {
+        for (auto& prim : primitives_)
+        {
+            if (prim.lodIndices)
+            {
+                gEngine->destroy(prim.lodIndices);
+                prim.lodIndices = nullptr;
+            }
+            prim.lods.clear();
+        }
     }
     void VzGeometryRes::Set(const std::vector<VzPrimitive>& primitives)
     {
+        if (HasLODs())
+        {
+            gEngineApp->ResetActorLODs(this);
+            destroyLODs();
+        }
         primitives_ = primitives;
         for (VzPrimitive& prim : primitives_)
         {
@@ -453,8 +586,126 @@ namespace vzm
             currentIBs_.insert(prim.indices);
             currentMTBs_.insert(prim.morphTargetBuffer);
         }
+        bvh_.reset();
     }
     std::vector<VzPrimitive>* VzGeometryRes::Get() { return &primitives_; }
+    void VzGeometryRes::SetTriangles(std::vector<float3>&& positions, std::vector<uint32_t>&& indices,
+        std::vector<TriangleRange>&& ranges)
+    {
+        pickPositions_ = std::move(positions);
+        pickIndices_ = std::move(indices);
+        pickRanges_ = std::move(ranges);
+        bvh_.reset();
+    }
+    bool VzGeometryRes::GenerateLODs(const uint32_t levelCount, const float reduction, const float maxError)
+    {
+        if (HasLODs())
+        {
+            gEngineApp->ResetActorLODs(this);
+            destroyLODs();
+        }
+        const bool from_source = sourceMesh && sourceMesh->primitives_count == primitives_.size();
+        if (!from_source && pickRanges_.size() != primitives_.size())
+        {
+            backlog::post("the triangles of the geometry's primitives are not available for the LOD generation", backlog::LogLevel::Warning);
+            return false;
+        }
+
+        // the primitives are simplified in parallel, the index buffers are created on this thread
+        struct LodJob
+        {
+            std::vector<float3> positions;
+            std::vector<uint32_t> indices;
+            std::vector<uint32_t> lodIndices;
+            std::vector<VzLodLevel> levels;
+        };
+        std::vector<LodJob> jobs(primitives_.size());
+        for (size_t i = 0, n = primitives_.size(); i < n; ++i)
+        {
+            if (primitives_[i].ptype != PrimitiveType::TRIANGLES)
+            {
+                continue;
+            }
+            LodJob& job = jobs[i];
+            if (from_source)
+            {
+                VzMeshLOD::ReadTriangles(sourceMesh->primitives[i], job.positions, job.indices);
+                continue;
+            }
+            const TriangleRange& range = pickRanges_[i];
+            job.positions.assign(pickPositions_.begin() + range.vertexOffset,
+                pickPositions_.begin() + range.vertexOffset + range.vertexCount);
+            job.indices.resize(range.indexCount);
+            for (uint32_t k = 0; k < range.indexCount; ++k)
+            {
+                job.indices[k] = pickIndices_[range.indexOffset + k] - range.vertexOffset;
+            }
+        }
+
+        auto simplify = [levelCount, reduction, maxError](LodJob* first, size_t count) {
+            for (size_t i = 0; i < count; ++i)
+            {
+                LodJob& job = first[i];
+                VzMeshLOD::Generate(job.positions.data(), job.positions.size(), job.indices.data(), job.indices.size(),
+                    levelCount, reduction, maxError, job.lodIndices, job.levels);
+            }
+            };
+        utils::JobSystem& js = gEngine->getJobSystem();
+        utils::JobSystem::Job* parent = utils::jobs::parallel_for(js, nullptr,
+            jobs.data(), (uint32_t)jobs.size(), std::cref(simplify), utils::jobs::CountSplitter<1>());
+        js.runAndWait(parent);
+
+        bool generated = false;
+        for (size_t i = 0, n = primitives_.size(); i < n; ++i)
+        {
+            LodJob& job = jobs[i];
+            if (job.levels.empty())
+            {
+                continue;
+            }
+            VzPrimitive& prim = primitives_[i];
+            auto* lod_indices = new std::vector<uint32_t>(std::move(job.lodIndices));
+            prim.lodIndices = IndexBuffer::Builder()
+                .indexCount((uint32_t)lod_indices->size())
+                .bufferType(IndexBuffer::IndexType::UINT)
+                .build(*gEngine);
+            prim.lodIndices->setBuffer(*gEngine, IndexBuffer::BufferDescriptor(lod_indices->data(),
+                lod_indices->size() * sizeof(uint32_t), [](void*, size_t, void* user) {
+                    delete (std::vector<uint32_t>*)user;
+                }, lod_indices));
+            prim.lods = std::move(job.levels);
+            generated = true;
+        }
+        return generated;
+    }
+    bool VzGeometryRes::HasLODs() const
+    {
+        for (const VzPrimitive& prim : primitives_)
+        {
+            if (!prim.lods.empty())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    const VzMeshBVH* VzGeometryRes::GetBVH()
+    {
+        if (bvh_)
+        {
+            return bvh_.get();
+        }
+        if (pickIndices_.empty() && sourceMesh)
+        {
+            if (!VzMeshBVH::ReadTriangles(sourceMesh, pickPositions_, pickIndices_))
+            {
+                backlog::post("the glTF source of the geometry is not available for ray casting", backlog::LogLevel::Warning);
+            }
+        }
+        bvh_ = std::make_unique<VzMeshBVH>();
+        bvh_->Build(pickPositions_.data(), pickPositions_.size(), pickIndices_.data(), pickIndices_.size());
+        return bvh_.get();
+    }
 
     std::set<VertexBuffer*> VzGeometryRes::currentVBs_;
     std::set<IndexBuffer*> VzGeometryRes::currentIBs_;
@@ -537,81 +788,99 @@ namespace vzm
         }
         return 0;
     }
-    int32_t vzm::VzFontRes::GetBearingX(const uint32_t glyphCode)
-    {
-        if (ftFace_) {
-            renderGlyph(glyphCode);
-            return ftFace_->glyph->bitmap_left;
-        }
-        return 0;
-    }
-    int32_t vzm::VzFontRes::GetBearingY(const uint32_t glyphCode)
+    VzGlyph vzm::VzFontRes::GetGlyph(const uint32_t glyphCode)
     {
-        if (ftFace_) {
-            renderGlyph(glyphCode);
-            return ftFace_->glyph->bitmap_top;
+        auto it = glyphIndices_.find(glyphCode);
+        if (it != glyphIndices_.end()) {
+            return glyphs_[it->second];
         }
-        return 0;
+        return cacheGlyph(glyphCode);
     }
-    int32_t vzm::VzFontRes::GetAdvanceX(const uint32_t glyphCode)
+    const uint8_t* vzm::VzFontRes::GetGlyphPixels(const VzGlyph& glyph) const
     {
-        if (ftFace_) {
-            loadGlyph(glyphCode);
-            return ftFace_->glyph->advance.x >> 6;
-        }
-        return 0;
-    }
-    int32_t vzm::VzFontRes::GetGlyphWidth(const uint32_t glyphCode)
-    {
-        if (ftFace_) {
-            renderGlyph(glyphCode);
-            return ftFace_->glyph->bitmap.width;
+        if (glyph.layer < 0) {
+            return nullptr;
         }
-        return 0;
+        return &atlasLayers_[glyph.layer][(size_t)glyph.y * atlasSize_ + glyph.x];
     }
-    int32_t vzm::VzFontRes::GetGlyphHeight(const uint32_t glyphCode)
+    void vzm::VzFontRes::ClearGlyphCache()
     {
-        if (ftFace_) {
-            renderGlyph(glyphCode);
-            return ftFace_->glyph->bitmap.rows;
-        }
-        return 0;
+        glyphs_.clear();
+        glyphIndices_.clear();
+        atlasLayers_.clear();
+        atlas_.reset();
+        atlasSize_ = 0;
     }
-    const uint8_t* vzm::VzFontRes::GetGlyphPixels(const uint32_t glyphCode)
+    VzGlyph vzm::VzFontRes::cacheGlyph(const uint32_t glyphCode)
     {
-        if (ftFace_) {
-            renderGlyph(glyphCode);
-            return ftFace_->glyph->bitmap.buffer;
+        if (ftFace_ == nullptr) {
+            return VzGlyph();
         }
-        return nullptr;
-    }
-    void vzm::VzFontRes::loadGlyph(const uint32_t glyphCode)
-    {
-        if ((!isLoaded_) || (glyphCode != glyphCode_)) {
-            uint32_t glyphIndex = FT_Get_Char_Index(ftFace_, glyphCode);
-            FT_Error ft_error = FT_Load_Glyph(ftFace_, glyphIndex, FT_LOAD_DEFAULT);
-            if (ft_error)
-            {
-                backlog::post("Failed to load glyph: " + std::to_string(glyphCode), backlog::LogLevel::Error);
+
+        if (atlas_ == nullptr) {
+            // the atlas layers are 8 times the line height (rounded up to power-of-two)
+            uint32_t line_size = 1;
+            while (line_size < (uint32_t)std::max(GetLineHeight(), 1)) {
+                line_size <<= 1;
             }
-            glyphCode_ = glyphCode;
-            isLoaded_ = true;
-            isRendered_ = false;
+            atlasSize_ = line_size << 3;
+            atlas_ = std::make_unique<VzGlyphAtlas>(atlasSize_, 16u);
         }
-    }
-    void vzm::VzFontRes::renderGlyph(const uint32_t glyphCode)
-    {
-        if ((!isRendered_) || (glyphCode != glyphCode_)) {
-            uint32_t glyphIndex = FT_Get_Char_Index(ftFace_, glyphCode);
-            FT_Error ft_error = FT_Load_Glyph(ftFace_, glyphIndex, FT_LOAD_DEFAULT | FT_LOAD_RENDER);
-            if (ft_error)
-            {
-                backlog::post("Failed to render glyph: " + std::to_string(glyphCode), backlog::LogLevel::Error);
+
+        VzGlyph glyph;
+        uint32_t glyphIndex = FT_Get_Char_Index(ftFace_, glyphCode);
+        FT_Error ft_error = FT_Load_Glyph(ftFace_, glyphIndex, FT_LOAD_DEFAULT | FT_LOAD_RENDER);
+        if (ft_error)
+        {
+            backlog::post("Failed to render glyph: " + std::to_string(glyphCode), backlog::LogLevel::Error);
+        }
+        else
+        {
+            const FT_GlyphSlot slot = ftFace_->glyph;
+            const FT_Bitmap& bitmap = slot->bitmap;
+            glyph.bearingX = slot->bitmap_left;
+            glyph.bearingY = slot->bitmap_top;
+            glyph.advanceX = slot->advance.x >> 6;
+            glyph.width = bitmap.width;
+            glyph.height = bitmap.rows;
+
+            if (glyph.width > 0 && glyph.height > 0) {
+                VzAtlasRegion allocation;
+                if ((uint32_t)glyph.width <= atlasSize_ && (uint32_t)glyph.height <= atlasSize_) {
+                    allocation = atlas_->Allocate(glyph.width, glyph.height);
+                    if (allocation.layer < 0) {
+                        // the atlas is full, restart from an empty cache
+                        // (the glyphs are returned by value, and looked up again by the typesetter for their pixels)
+                        ClearGlyphCache();
+                        return cacheGlyph(glyphCode);
+                    }
+                }
+                if (allocation.layer >= 0) {
+                    if ((size_t)allocation.layer >= atlasLayers_.size()) {
+                        atlasLayers_.resize(allocation.layer + 1);
+                    }
+                    std::vector<uint8_t>& layer_pixels = atlasLayers_[allocation.layer];
+                    if (layer_pixels.empty()) {
+                        layer_pixels.resize((size_t)atlasSize_ * atlasSize_);
+                    }
+                    glyph.layer = allocation.layer;
+                    glyph.x = allocation.x;
+                    glyph.y = allocation.y;
+                    for (int32_t row = 0; row < glyph.height; row++) {
+                        memcpy(&layer_pixels[(size_t)(glyph.y + row) * atlasSize_ + glyph.x],
+                            bitmap.buffer + (ptrdiff_t)row * bitmap.pitch, glyph.width);
+                    }
+                }
+                else {
+                    backlog::post("Glyph is too large for the atlas: " + std::to_string(glyphCode), backlog::LogLevel::Warning);
+                    glyph.width = glyph.height = 0;
+                }
             }
-            glyphCode_ = glyphCode;
-            isLoaded_ = true;
-            isRendered_ = true;
         }
+
+        glyphIndices_[glyphCode] = (uint32_t)glyphs_.size();
+        glyphs_.push_back(glyph);
+        return glyph;
     }
 #pragma endregion
 
@@ -786,23 +1055,12 @@ namespace vzm
         gltfio::VzAssetLoader* assetLoader = nullptr;
         gltfio::VzAssetExpoter* assetExpoter = nullptr;
 
-        gltfio::ResourceLoader* resourceLoader = nullptr;
-        gltfio::TextureProvider* stbDecoder = nullptr;
-        gltfio::TextureProvider* ktxDecoder = nullptr;
+        VzAssetLoadQueue* loadQueue = nullptr; // owns the resource loaders and the texture providers
 
         void Destory()
         {
-            if (resourceLoader) {
-                resourceLoader->asyncCancelLoad();
-                resourceLoader = nullptr;
-            }
-
-            delete resourceLoader;
-            resourceLoader = nullptr;
-            delete stbDecoder;
-            stbDecoder = nullptr;
-            delete ktxDecoder;
-            ktxDecoder = nullptr;
+            delete loadQueue; // cancels the in-flight loads
+            loadQueue = nullptr;
 
             //AssetLoader::destroy(&assetLoader);
             gltfio::VzAssetLoader::destroy(&assetLoader);
@@ -812,6 +1070,50 @@ namespace vzm
     } vGltfIo;
 
 #pragma region // VzEngineApp
+    VZ_COMP_TYPE GetVzCompType(const std::string& typeName)
+    {
+        // the order follows VZ_COMP_TYPE
+        static const std::string typeNames[(size_t)VZ_COMP_TYPE::COUNT] = {
+            "VzScene", "VzRenderer", "VzAsset", "VzSkeleton", "VzCamera",
+            "VzActor", "VzSpriteActor", "VzTextSpriteActor",
+            "VzSunLight", "VzDirectionalLight", "VzPointLight", "VzSpotLight", "VzFocusedSpotLight",
+            "VzGeometry", "VzMaterial", "VzMI", "VzTexture", "VzFont",
+        };
+        for (size_t i = 0; i < (size_t)VZ_COMP_TYPE::COUNT; ++i)
+        {
+            if (typeNames[i] == typeName)
+            {
+                return (VZ_COMP_TYPE)i;
+            }
+        }
+        return VZ_COMP_TYPE::COUNT;
+    }
+    std::pair<VzComponentPool<std::unique_ptr<VzBaseComp>>::iterator, bool> VzEngineApp::emplaceVzComp(const VID vid, std::unique_ptr<VzBaseComp>&& comp)
+    {
+        auto it = vzCompMap_.emplace(vid, std::move(comp));
+        if (it.second)
+        {
+            // the type string is resolved once here, not per query
+            VzBaseComp* v_comp = it.first->second.get();
+            VZ_COMP_TYPE type = GetVzCompType(v_comp->GetType());
+            if (type != VZ_COMP_TYPE::COUNT)
+            {
+                typedVzComps_[(size_t)type].emplace(vid, v_comp);
+            }
+        }
+        return it;
+    }
+    void VzEngineApp::eraseVzComp(const VID vid)
+    {
+        for (VzComponentPool<VzBaseComp*>& pool : typedVzComps_)
+        {
+            if (pool.erase(vid))
+            {
+                break;
+            }
+        }
+        vzCompMap_.erase(vid);
+    }
     bool VzEngineApp::removeScene(SceneVID vidScene)
     {
         Scene* scene = GetScene(vidScene);
@@ -893,7 +1195,7 @@ namespace vzm
         //scene->remove(it_srm->second.GetLightmapCube()->getWireFrameRenderable());
         sceneResMap_.erase(it_srm); // calls destructor
 
-        vzCompMap_.erase(vidScene);
+        eraseVzComp(vidScene);
         return true;
     }
 
@@ -906,7 +1208,7 @@ namespace vzm
         scenes_[vid] = gEngine->createScene();
         sceneResMap_[vid] = std::make_unique<VzSceneRes>();
 
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzScene>(vid, "CreateScene"));
+        auto it = emplaceVzComp(vid, std::make_unique<VzScene>(vid, "CreateScene"));
         VzNameCompManager& ncm = VzNameCompManager::Get();
         ncm.CreateNameComp(ett, name);
         return (VzScene*)it.first->second.get();
@@ -920,7 +1222,7 @@ namespace vzm
         renderPathMap_[vid] = std::make_unique<VzRenderPath>();
         VzRenderPath* renderPath = renderPathMap_[vid].get();
 
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzRenderer>(vid, "CreateRenderPath"));
+        auto it = emplaceVzComp(vid, std::make_unique<VzRenderer>(vid, "CreateRenderPath"));
         VzNameCompManager& ncm = VzNameCompManager::Get();
         ncm.CreateNameComp(ett, name);
         return (VzRenderer*)it.first->second.get();
@@ -934,7 +1236,7 @@ namespace vzm
         assetResMap_[vid] = std::make_unique<VzAssetRes>();
         ncm.CreateNameComp(ett, name);
 
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzAsset>(vid, "CreateAsset"));
+        auto it = emplaceVzComp(vid, std::make_unique<VzAsset>(vid, "CreateAsset"));
         return (VzAsset*)it.first->second.get();
     }
     VzSkeleton* VzEngineApp::CreateSkeleton(const std::string& name, const SkeletonVID vidExist)
@@ -950,13 +1252,13 @@ namespace vzm
         skeletonResMap_[vid] = std::make_unique<VzSkeletonRes>();
         ncm.CreateNameComp(ett, name);
 
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzAsset>(vid, "CreateSkeleton"));
+        auto it = emplaceVzComp(vid, std::make_unique<VzSkeleton>(vid, "CreateSkeleton"));
         return (VzSkeleton*)it.first->second.get();
     }
     size_t VzEngineApp::GetVidsByName(const std::string& name, std::vector<VID>& vids)
     {
         VzNameCompManager& ncm = VzNameCompManager::Get();
-        std::vector<utils::Entity> etts = ncm.GetEntitiesByName(name);
+        std::span<const utils::Entity> etts = ncm.GetEntitiesByName(name);
         size_t num_etts = etts.size();
         if (num_etts == 0)
         {
@@ -965,12 +1267,30 @@ namespace vzm
 
         vids.clear();
         vids.reserve(num_etts);
-        for (utils::Entity& ett : etts)
+        for (utils::Entity ett : etts)
         {
             vids.push_back(ett.getId());
         }
         return num_etts;
     }
+    size_t VzEngineApp::GetVidsByNamePattern(const std::string& pattern, std::vector<VID>& vids)
+    {
+        VzNameCompManager& ncm = VzNameCompManager::Get();
+        vids.clear();
+        return ncm.ForEachEntityByPattern(pattern, [&vids](const utils::Entity ett) {
+            vids.push_back(ett.getId());
+            });
+    }
+    size_t VzEngineApp::ForEachVidByName(const std::string& name, const std::function<void(VID)>& callback)
+    {
+        VzNameCompManager& ncm = VzNameCompManager::Get();
+        std::span<const utils::Entity> etts = ncm.GetEntitiesByName(name);
+        for (utils::Entity ett : etts)
+        {
+            callback(ett.getId());
+        }
+        return etts.size();
+    }
     VID VzEngineApp::GetFirstVidByName(const std::string& name)
     {
         VzNameCompManager& ncm = VzNameCompManager::Get();
@@ -1025,13 +1345,13 @@ namespace vzm
     Scene* VzEngineApp::GetFirstSceneByName(const std::string& name)
     {
         VzNameCompManager& ncm = VzNameCompManager::Get();
-        std::vector<utils::Entity> etts = ncm.GetEntitiesByName(name);
+        std::span<const utils::Entity> etts = ncm.GetEntitiesByName(name);
         if (etts.size() == 0)
         {
             return nullptr;
         }
 
-        for (utils::Entity& ett : etts)
+        for (utils::Entity ett : etts)
         {
             SceneVID sid = ett.getId();
             auto it = scenes_.find(sid);
@@ -1042,7 +1362,7 @@ namespace vzm
         }
         return nullptr;
     }
-    std::unordered_map<SceneVID, Scene*>* VzEngineApp::GetScenes()
+    VzComponentPool<Scene*>* VzEngineApp::GetScenes()
     {
         return &scenes_;
     }
@@ -1394,8 +1714,8 @@ namespace vzm
             actorResMap_[vid] = std::make_unique<VzActorRes>();
 
             auto it = compType == SCENE_COMPONENT_TYPE::SPRITE_ACTOR?
-                vzCompMap_.emplace(vid, std::make_unique<VzSpriteActor>(vid, "CreateSceneComponent")) :
-                vzCompMap_.emplace(vid, std::make_unique<VzTextSpriteActor>(vid, "CreateSceneComponent"));
+                emplaceVzComp(vid, std::make_unique<VzSpriteActor>(vid, "CreateSceneComponent")) :
+                emplaceVzComp(vid, std::make_unique<VzTextSpriteActor>(vid, "CreateSceneComponent"));
             v_comp = (VzSceneComp*)it.first->second.get();
 
             VzActorRes* actor_res = actorResMap_[vid].get();
@@ -1432,7 +1752,6 @@ namespace vzm
             {
                 vid_m = GetFirstVidByName("_BUILDER_TEXT_SPRITE_MATERIAL");
                 if (vid_m == INVALID_VID) {
-                    MaterialBuilder::init();
                     const char* code = R"(
                         void material(inout MaterialInputs material) {
                             prepareMaterial(material);
@@ -1440,36 +1759,29 @@ namespace vzm
                             material.baseColor *= texture(materialParams_textTexture, getUV0()).r;
                         }
                     )";
-                    MaterialBuilder builder;
-                    builder
-                        .name("TextSpriteMaterial")
-                        .shading(Shading::UNLIT)
-                        .blending(BlendingMode::TRANSPARENT)
-                        .parameter("textTexture",
-                                   (MaterialBuilder::SamplerType) SamplerType::SAMPLER_2D,
-                                   SamplerFormat::FLOAT,
-                                   (MaterialBuilder::Precision) Precision::MEDIUM)
-                        .parameter("baseColorFactor",
-                                   (MaterialBuilder::UniformType) UniformType::FLOAT4,
-                                   (MaterialBuilder::Precision) Precision::MEDIUM)
-                        .require(MaterialBuilder::VertexAttribute::UV0)
-                        .doubleSided(true)
-                        .flipUV(false)
-#ifdef __ANDROID__
-                        .platform(MaterialBuilder::Platform::MOBILE)
-#endif
-                        .optimization(MaterialBuilder::Optimization::NONE);
-
-                    if (gEngine->getBackend() == filament::backend::Backend::VULKAN)
-                    {
-                        builder.targetApi(MaterialBuilder::TargetApi::VULKAN);
-                    }
-                    builder.material(code);
-                    Package result = builder.build(gEngine->getJobSystem());
-                    assert(result.isValid());
-                    Material* material = Material::Builder()
-                        .package(result.getData(), result.getSize())
-                        .build(*gEngine);
+                    // the recipe describes everything passed to the builder below
+                    const std::string recipe = std::string("TextSpriteMaterial;unlit;transparent;"
+                        "textTexture:sampler2d,float,medium;baseColorFactor:float4,medium;uv0;doubleSided;noFlipUV;noOptimization")
+                        + code;
+                    Material* material = materialCache_.BuildMaterial(*gEngine, recipe, [code](MaterialBuilder& builder) {
+                        builder
+                            .name("TextSpriteMaterial")
+                            .shading(Shading::UNLIT)
+                            .blending(BlendingMode::TRANSPARENT)
+                            .parameter("textTexture",
+                                       (MaterialBuilder::SamplerType) SamplerType::SAMPLER_2D,
+                                       SamplerFormat::FLOAT,
+                                       (MaterialBuilder::Precision) Precision::MEDIUM)
+                            .parameter("baseColorFactor",
+                                       (MaterialBuilder::UniformType) UniformType::FLOAT4,
+                                       (MaterialBuilder::Precision) Precision::MEDIUM)
+                            .require(MaterialBuilder::VertexAttribute::UV0)
+                            .doubleSided(true)
+                            .flipUV(false)
+                            .optimization(MaterialBuilder::Optimization::NONE)
+                            .material(code);
+                        });
+                    assert(material);
                     vid_m = gEngineApp->CreateMaterial("_BUILDER_TEXT_SPRITE_MATERIAL", material, nullptr, true)->GetVID();
                     std::vector<Material::ParameterInfo> params(material->getParameterCount());
                     material->getParameters(&params[0], params.size());
@@ -1501,7 +1813,7 @@ namespace vzm
             actorSceneMap_[vid] = 0; // first creation
             actorResMap_[vid] = std::make_unique<VzActorRes>();
 
-            auto it = vzCompMap_.emplace(vid, std::make_unique<VzActor>(vid, "CreateSceneComponent"));
+            auto it = emplaceVzComp(vid, std::make_unique<VzActor>(vid, "CreateSceneComponent"));
             v_comp = (VzSceneComp*)it.first->second.get();
             break;
         }
@@ -1521,7 +1833,7 @@ namespace vzm
                 .sunAngularRadius(1.9f)\
                 .castShadows(false)\
                 .build(*gEngine, ett);\
-            vzCompMap_.emplace(vid, std::make_unique<VZCOMP>(vid, "CreateSceneComponent")); break; }
+            emplaceVzComp(vid, std::make_unique<VZCOMP>(vid, "CreateSceneComponent")); break; }
 
             switch (compType)
             {
@@ -1555,7 +1867,7 @@ namespace vzm
             VzCameraRes* cam_res = camResMap_[vid].get();
             cam_res->SetCamera(camera);
 
-            auto it = vzCompMap_.emplace(vid, std::make_unique<VzCamera>(vid, "CreateSceneComponent"));
+            auto it = emplaceVzComp(vid, std::make_unique<VzCamera>(vid, "CreateSceneComponent"));
             v_comp = (VzSceneComp*)it.first->second.get();
             v_comp->SetMatrixAutoUpdate(false);
             break;
@@ -1634,7 +1946,7 @@ namespace vzm
         actor_res.SetGeometry(geo->GetVID());
         actor_res.SetMIs({ vid_mi });
 
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzActor>(vid, "CreateTestActor"));
+        auto it = emplaceVzComp(vid, std::make_unique<VzActor>(vid, "CreateTestActor"));
         VzActor* v_actor = (VzActor*)it.first->second.get();
         return v_actor;
     }
@@ -1662,7 +1974,7 @@ namespace vzm
             geo_res.aabb.max = max(prim.aabb.max, geo_res.aabb.max);
         }
 
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzGeometry>(vid, "CreateGeometry"));
+        auto it = emplaceVzComp(vid, std::make_unique<VzGeometry>(vid, "CreateGeometry"));
         return (VzGeometry*)it.first->second.get();;
     }
     VzMaterial* VzEngineApp::CreateMaterial(const std::string& name,
@@ -1703,7 +2015,7 @@ namespace vzm
                 m_res.allowedParamters[param.name] = param;
             }
         }
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzMaterial>(vid, "CreateMaterial"));
+        auto it = emplaceVzComp(vid, std::make_unique<VzMaterial>(vid, "CreateMaterial"));
         return (VzMaterial*)it.first->second.get();
     }
     VzMI* VzEngineApp::CreateMaterialInstance(const std::string& name,
@@ -1737,7 +2049,7 @@ namespace vzm
         mi_res.assetOwner = (filament::gltfio::FilamentAsset*)assetOwner;
         mi_res.isSystem = isSystem;
 
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzMI>(vid, "CreateMaterialInstance"));
+        auto it = emplaceVzComp(vid, std::make_unique<VzMI>(vid, "CreateMaterialInstance"));
         return (VzMI*)it.first->second.get();
     }
     VzTexture* VzEngineApp::CreateTexture(const std::string& name,
@@ -1761,7 +2073,7 @@ namespace vzm
         tex_res.sampler.setMinFilter(TextureSampler::MinFilter::LINEAR_MIPMAP_LINEAR);
         tex_res.sampler.setWrapModeS(TextureSampler::WrapMode::REPEAT);
         tex_res.sampler.setWrapModeT(TextureSampler::WrapMode::REPEAT);
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzTexture>(vid, "CreateTexture"));
+        auto it = emplaceVzComp(vid, std::make_unique<VzTexture>(vid, "CreateTexture"));
         return (VzTexture*)it.first->second.get();
     }
     VzFont* VzEngineApp::CreateFont(const std::string& name)
@@ -1775,7 +2087,7 @@ namespace vzm
         VID vid = ett.getId();
         fontResMap_[vid] = std::make_unique<VzFontRes>();
 
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzFont>(vid, "CreateFont"));
+        auto it = emplaceVzComp(vid, std::make_unique<VzFont>(vid, "CreateFont"));
         return (VzFont*)it.first->second.get();
     }
 
@@ -1803,6 +2115,7 @@ namespace vzm
         //assert(ins.isValid());
 
         std::vector<VzPrimitive>& primitives = *geo_res->Get();
+        actor_res->lodLevels.clear();
         std::vector<MaterialInstance*> mis;
         for (auto& it_mi : actor_res->GetMIVids())
         {
@@ -1841,6 +2154,31 @@ namespace vzm
             .build(*gEngine, ett_actor);
     }
 
+    void VzEngineApp::ResetActorLODs(const VzGeometryRes* geoRes)
+    {
+        auto& rcm = gEngine->getRenderableManager();
+        for (auto& it : actorResMap_)
+        {
+            VzActorRes& actor_res = *it.second.get();
+            if (actor_res.lodLevels.empty() || GetGeometryRes(actor_res.GetGeometryVid()) != geoRes)
+            {
+                continue;
+            }
+            auto ins = rcm.getInstance(utils::Entity::import(it.first));
+            std::vector<VzPrimitive>& primitives = *((VzGeometryRes*)geoRes)->Get();
+            for (size_t i = 0, n = std::min(primitives.size(), actor_res.lodLevels.size()); i < n && ins.isValid(); ++i)
+            {
+                const VzPrimitive& prim = primitives[i];
+                if (actor_res.lodLevels[i] != 0)
+                {
+                    rcm.setGeometryAt(ins, i, (RenderableManager::PrimitiveType)prim.ptype,
+                        prim.vertices, prim.indices, 0, prim.indices->getIndexCount());
+                }
+            }
+            actor_res.lodLevels.clear();
+        }
+    }
+
     VzGeometryRes* VzEngineApp::GetGeometryRes(const GeometryVID vidGeo)
     {
         auto it = geometryResMap_.find(vidGeo);
@@ -1947,9 +2285,31 @@ namespace vzm
         return vGltfIo.assetExpoter;
     }
 
-    ResourceLoader* VzEngineApp::GetGltfResourceLoader()
+    VzAssetLoadQueue* VzEngineApp::GetAssetLoadQueue()
+    {
+        return vGltfIo.loadQueue;
+    }
+
+    bool VzEngineApp::EnableBlobCache(const std::string& directory, const size_t capacityBytes)
     {
-        return vGltfIo.resourceLoader;
+        Platform* platform = gEngine->getPlatform();
+        if (platform == nullptr || platform->hasBlobFunc())
+        {
+            backlog::post("The blob cache can be enabled only once", backlog::LogLevel::Warning);
+            return false;
+        }
+        if (!blobCache_.Open(directory, capacityBytes))
+        {
+            return false;
+        }
+        platform->setBlobFunc(
+            [this](const void* key, size_t keySize, const void* value, size_t valueSize) {
+                blobCache_.Insert(key, keySize, value, valueSize);
+            },
+            [this](const void* key, size_t keySize, void* value, size_t valueSize) {
+                return blobCache_.Retrieve(key, keySize, value, valueSize);
+            });
+        return true;
     }
 
     bool VzEngineApp::RemoveComponent(const VID vid, const bool ignoreOnwership)
@@ -2206,6 +2566,13 @@ namespace vzm
             VzAssetRes* asset_res = GetAssetRes(vid);
             if (asset_res)
             {
+                // resources under loading refer to the asset
+                vGltfIo.loadQueue->Cancel(vid);
+                // the asset removes the name components of its entities without knowing the name index
+                for (utils::Entity ett_node : downcast(asset_res->asset)->mEntities)
+                {
+                    ncm.RemoveEntity(ett_node);
+                }
                 vGltfIo.assetLoader->destroyAsset((gltfio::FFilamentAsset*)asset_res->asset);
                 for (auto& it : asset_res->assetOwnershipComponents)
                 {
@@ -2217,7 +2584,7 @@ namespace vzm
 #pragma endregion 
             // the remaining etts (not engine-destory group)
 
-            vzCompMap_.erase(vid);
+            eraseVzComp(vid);
 
             actorSceneMap_.erase(vid);
             actorResMap_.erase(vid);
@@ -2234,6 +2601,7 @@ namespace vzm
             }
         }
 
+        ncm.RemoveEntity(ett); // keeps the name index consistent
         em.destroy(ett); // the associated engine components having the entity will be removed 
         gEngine->destroy(ett);
 
@@ -2242,24 +2610,19 @@ namespace vzm
 
     void VzEngineApp::CancelAyncLoad()
     {
-        if (vGltfIo.resourceLoader)
+        if (vGltfIo.loadQueue)
         {
-            vGltfIo.resourceLoader->asyncCancelLoad();
+            vGltfIo.loadQueue->CancelAll();
+        }
+        if (textureDecoder_)
+        {
+            textureDecoder_->CancelAll();
         }
     }
     void VzEngineApp::Initialize()
     {
-        ResourceConfiguration configuration = {};
-        configuration.engine = gEngine;
-        configuration.gltfPath = "";
-        configuration.normalizeSkinningWeights = true;
-
-        vGltfIo.resourceLoader = new gltfio::ResourceLoader(configuration);
-        vGltfIo.stbDecoder = createStbProvider(gEngine);
-        vGltfIo.ktxDecoder = createKtx2Provider(gEngine);
-        vGltfIo.resourceLoader->addTextureProvider("image/png", vGltfIo.stbDecoder);
-        vGltfIo.resourceLoader->addTextureProvider("image/jpeg", vGltfIo.stbDecoder);
-        vGltfIo.resourceLoader->addTextureProvider("image/ktx2", vGltfIo.ktxDecoder);
+        vGltfIo.loadQueue = new VzAssetLoadQueue();
+        textureDecoder_ = new VzTextureDecoder();
 
         compositor_ = new CompositorQuad();
 
@@ -2274,9 +2637,12 @@ namespace vzm
     {
         // dummy call //
 
-        if (vGltfIo.resourceLoader)
+        delete textureDecoder_; // cancels the decoding (waits for the running jobs)
+        textureDecoder_ = nullptr;
+
+        if (vGltfIo.loadQueue)
         {
-            vGltfIo.resourceLoader->asyncCancelLoad();
+            vGltfIo.loadQueue->CancelAll();
 
             for (auto it = textureResMap_.begin(); it != textureResMap_.end(); it++)
             {
@@ -2332,6 +2698,10 @@ namespace vzm
                         fasset->mTrsTransformManager->destroy(entity);
                     }
                 }
+                for (utils::Entity ett_node : fasset->mEntities)
+                {
+                    VzNameCompManager::Get().RemoveEntity(ett_node);
+                }
                 fasset->mEntities.clear(); // including... animation skeleton bones
                 fasset->detachFilamentComponents();
                 fasset->mVertexBuffers.clear();
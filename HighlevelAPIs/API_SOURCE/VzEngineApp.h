@@ -1,6 +1,7 @@
 #ifndef VZENGINEAPP_H
 #define VZENGINEAPP_H
 #include "VzComponents.h"
+#include "VzComponentPool.h"
 
 #include "filament/VertexBuffer.h"
 #include "filament/IndexBuffer.h"
@@ -13,6 +14,15 @@
 #include "gltfio/FilamentAsset.h"
 #include "gltfio/ResourceLoader.h"
 
+#include "backend/VzAssetLoadQueue.h"
+#include "backend/VzIBLCache.h"
+#include "backend/VzMaterialCache.h"
+#include "backend/VzBlobCache.h"
+#include "backend/VzTextureDecoder.h"
+#include "backend/VzMeshBVH.h"
+#include "backend/VzMeshLOD.h"
+#include "backend/VzGlyphAtlas.h"
+
 #include <array>
 
 #include <ft2build.h>
@@ -88,6 +98,10 @@ namespace vzm
         std::vector<int> slotIndices;
 
         PrimitiveType ptype = PrimitiveType::TRIANGLES;
+
+        // simplified levels of detail (see VzGeometry::GenerateLODs), ranges of lodIndices
+        IndexBuffer* lodIndices = nullptr;
+        std::vector<VzLodLevel> lods;
     };
 
     struct VzTextFormat {
@@ -97,9 +111,41 @@ namespace vzm
         uint32_t leading = 0;
     };
 
+    struct VzFontRes;
+
     struct VzTypesetter {
+    private:
+        // a glyph placed in the text image (x, y : top-left of the glyph pixels)
+        struct GlyphPlacement {
+            uint32_t glyphCode;
+            int32_t x;
+            int32_t y;
+            bool operator==(const GlyphPlacement& rhs) const { return glyphCode == rhs.glyphCode && x == rhs.x && y == rhs.y; }
+        };
+        // a range of placements and the rows [top, bottom) its pixels cover
+        struct PlacedLine {
+            uint32_t first;
+            uint32_t count;
+            int32_t top;
+            int32_t bottom;
+        };
+        std::vector<GlyphPlacement> placements_;
+        std::vector<GlyphPlacement> prevPlacements_;
+        std::vector<PlacedLine> placedLines_;
+        std::vector<PlacedLine> prevPlacedLines_;
+        FontVID prevFont_ = INVALID_VID;
+
+        // staging pixels of the texture (capacityWidth x capacityHeight), kept over the updates
+        std::vector<uint8_t> pixels_;
+
+        void place(VzFontRes* fontRes);
+        void blit(VzFontRes* fontRes, const PlacedLine& line, const int32_t rowBegin, const int32_t rowEnd);
+    public:
         void Measure();
         int32_t MeasureLinesWidth(FontVID font);
+        // updates the texture with the text
+        //  - the texture is reallocated only when the text image exceeds its capacity
+        //  - only the rows of the lines that have changed are re-blitted and uploaded
         void Typeset();
         int32_t GetLeftBlankWidth(const TEXT_ALIGN textAlign, const int32_t lineWidth, const int32_t width);
         int32_t GetTopBlankHeight(const TEXT_ALIGN textAlign, const int32_t lineHeight, const int32_t height);
@@ -113,6 +159,14 @@ namespace vzm
         std::vector<int32_t> linesWidth;
         int32_t textWidth = 0;
         int32_t textHeight = 0;
+
+        // the text image occupies the top-left (imageWidth x imageHeight) region of the texture
+        int32_t imageWidth = 0;
+        int32_t imageHeight = 0;
+        uint32_t capacityWidth = 0;
+        uint32_t capacityHeight = 0;
+        // rows uploaded by the last Typeset() (0 if the text image is unchanged)
+        uint32_t uploadedRows = 0;
     };
 
     struct VzTextField {
@@ -177,6 +231,7 @@ namespace vzm
         bool castShadow = true;
         bool receiveShadow = true;
         uint8_t priority = 0x4;
+        std::vector<uint8_t> lodLevels; // level of detail of each primitive, empty : base levels (see VzRenderPath::ApplyLODs)
 
         void SetGeometry(const GeometryVID vid);
         void SetMIs(const std::vector<MInstanceVID>& vidMIs);
@@ -223,13 +278,38 @@ namespace vzm
         std::vector<char> cacheVB;
         std::vector<char> cacheIB;
         std::vector<char> cacheMTB;
+
+        // CPU-side triangles for ray casting (object space, bind pose)
+        std::vector<filament::math::float3> pickPositions_;
+        std::vector<uint32_t> pickIndices_;
+        std::unique_ptr<VzMeshBVH> bvh_; // built on the first ray query, reset when the geometry changes
+
+        void destroyLODs();
+    public:
+        // the triangles of a primitive in the ray casting triangles
+        struct TriangleRange
+        {
+            uint32_t indexOffset;
+            uint32_t indexCount;
+            uint32_t vertexOffset; // the indices of the primitive are offset by it
+            uint32_t vertexCount;
+        };
+    private:
+        std::vector<TriangleRange> pickRanges_; // per primitive, if given by SetTriangles
     public:
         bool isSystem = false;
         gltfio::FilamentAsset* assetOwner = nullptr; // has ownership
+        const cgltf_mesh* sourceMesh = nullptr; // triangles are read from the glTF source when no triangles are set
         filament::Aabb aabb;
         std::vector<float> morphWeights;
         void Set(const std::vector<VzPrimitive>& primitives);
         std::vector<VzPrimitive>* Get();
+        void SetTriangles(std::vector<filament::math::float3>&& positions, std::vector<uint32_t>&& indices,
+            std::vector<TriangleRange>&& ranges = {});
+        const VzMeshBVH* GetBVH();
+        // the triangles of each primitive are read from the glTF source or the ray casting triangles (with their ranges)
+        bool GenerateLODs(const uint32_t levelCount, const float reduction, const float maxError);
+        bool HasLODs() const;
 
         ~VzGeometryRes();
     };
@@ -268,30 +348,57 @@ namespace vzm
 
         ~VzTextureRes();
     };
+    struct VzGlyph
+    {
+        int32_t bearingX = 0;
+        int32_t bearingY = 0;
+        int32_t advanceX = 0;
+        int32_t width = 0;
+        int32_t height = 0;
+        // location of the glyph pixels in the atlas (layer < 0 : no pixels, e.g., space)
+        int32_t layer = -1;
+        int32_t x = 0;
+        int32_t y = 0;
+    };
     struct VzFontRes
     {
     private:
-        void loadGlyph(const uint32_t glyphCode);
-        void renderGlyph(const uint32_t glyphCode);
+        // glyph cache
+        //  - metrics are stored in a flat table, indexed by glyphIndices_ (glyph code to table index)
+        //  - pixels are stored in square atlas layers whose regions are managed by VzGlyphAtlas
+        //  - the atlas layers are CPU memory only, and all the layers are cleared when the atlas is full
+        //  - there is no shared GPU atlas: each text sprite blits its glyphs from the layers into its own texture
+        //    (see VzTypesetter), since the text sprites render one textured quad rather than a quad per glyph
+        std::vector<VzGlyph> glyphs_;
+        std::unordered_map<uint32_t, uint32_t> glyphIndices_;
+        std::unique_ptr<VzGlyphAtlas> atlas_;
+        std::vector<std::vector<uint8_t>> atlasLayers_;
+        uint32_t atlasSize_ = 0;
+
+        VzGlyph cacheGlyph(const uint32_t glyphCode);
     public:
         ~VzFontRes();
 
         bool IsSpace(const uint32_t glyphCode);
         bool IsNewLine(const uint32_t glyphCode);
         int32_t GetLineHeight();
-        int32_t GetBearingX(const uint32_t glyphCode);
-        int32_t GetBearingY(const uint32_t glyphCode);
-        int32_t GetAdvanceX(const uint32_t glyphCode);
-        int32_t GetGlyphWidth(const uint32_t glyphCode);
-        int32_t GetGlyphHeight(const uint32_t glyphCode);
-        const uint8_t* GetGlyphPixels(const uint32_t glyphCode);
+        // returned by value, caching a glyph may reallocate (or clear) the cache
+        VzGlyph GetGlyph(const uint32_t glyphCode);
+        int32_t GetBearingX(const uint32_t glyphCode) { return GetGlyph(glyphCode).bearingX; }
+        int32_t GetBearingY(const uint32_t glyphCode) { return GetGlyph(glyphCode).bearingY; }
+        int32_t GetAdvanceX(const uint32_t glyphCode) { return GetGlyph(glyphCode).advanceX; }
+        int32_t GetGlyphWidth(const uint32_t glyphCode) { return GetGlyph(glyphCode).width; }
+        int32_t GetGlyphHeight(const uint32_t glyphCode) { return GetGlyph(glyphCode).height; }
+        // returns the top-left pixel of the glyph in the atlas (nullptr if no pixels)
+        // the row pitch is GetGlyphPixelsPitch()
+        const uint8_t* GetGlyphPixels(const VzGlyph& glyph) const;
+        uint32_t GetGlyphPixelsPitch() const { return atlasSize_; }
+        // must be called when the face or the size is changed
+        void ClearGlyphCache();
 
         FT_Face ftFace_ = nullptr;
         std::string path_;
         uint32_t size_ = 10;
-        uint32_t glyphCode_ = 0x00000000U;
-        bool isLoaded_ = false;
-        bool isRendered_ = false;
     };
 
     struct VzAssetRes
@@ -371,39 +478,75 @@ namespace vzm
 
     class VzRenderPath;
 
+    // type ids of the VzBaseComp types (see VzBaseComp::GetType())
+    enum class VZ_COMP_TYPE : uint8_t
+    {
+        SCENE = 0,
+        RENDERER,
+        ASSET,
+        SKELETON,
+        CAMERA,
+        ACTOR,
+        SPRITE_ACTOR,
+        TEXT_SPRITE_ACTOR,
+        SUN_LIGHT,
+        DIRECTIONAL_LIGHT,
+        POINT_LIGHT,
+        SPOT_LIGHT,
+        FOCUSED_SPOT_LIGHT,
+        GEOMETRY,
+        MATERIAL,
+        MATERIALINSTANCE,
+        TEXTURE,
+        FONT,
+
+        COUNT // also used for unknown type names
+    };
+    VZ_COMP_TYPE GetVzCompType(const std::string& typeName);
+
     class VzEngineApp
     {
     private:
-        std::unordered_map<SceneVID, Scene*> scenes_;
-        std::unordered_map<SceneVID, std::unique_ptr<VzSceneRes>> sceneResMap_;
+        VzComponentPool<Scene*> scenes_;
+        VzComponentPool<std::unique_ptr<VzSceneRes>> sceneResMap_;
         // note a VzRenderPath involves a filament::view that includes
         // 1. filament::camera and 2. filament::scene
-        std::unordered_map<CamVID, SceneVID> camSceneMap_;
-        std::unordered_map<CamVID, std::unique_ptr<VzCameraRes>> camResMap_;
-        std::unordered_map<ActorVID, SceneVID> actorSceneMap_;
-        std::unordered_map<ActorVID, std::unique_ptr<VzActorRes>> actorResMap_; // consider when removing resources...
-        std::unordered_map<LightVID, SceneVID> lightSceneMap_;
-        std::unordered_map<LightVID, std::unique_ptr<VzLightRes>> lightResMap_;
+        VzComponentPool<SceneVID> camSceneMap_;
+        VzComponentPool<std::unique_ptr<VzCameraRes>> camResMap_;
+        VzComponentPool<SceneVID> actorSceneMap_;
+        VzComponentPool<std::unique_ptr<VzActorRes>> actorResMap_; // consider when removing resources...
+        VzComponentPool<SceneVID> lightSceneMap_;
+        VzComponentPool<std::unique_ptr<VzLightRes>> lightResMap_;
 
-        std::unordered_map<RendererVID, std::unique_ptr<VzRenderPath>> renderPathMap_;
+        VzComponentPool<std::unique_ptr<VzRenderPath>> renderPathMap_;
 
         // Resources (ownership check!)
-        std::unordered_map<GeometryVID, std::unique_ptr<VzGeometryRes>> geometryResMap_;
-        std::unordered_map<MaterialVID, std::unique_ptr<VzMaterialRes>> materialResMap_;
-        std::unordered_map<MInstanceVID, std::unique_ptr<VzMIRes>> miResMap_;
-        std::unordered_map<TextureVID, std::unique_ptr<VzTextureRes>> textureResMap_;
-        std::unordered_map<FontVID, std::unique_ptr<VzFontRes>> fontResMap_;
+        VzComponentPool<std::unique_ptr<VzGeometryRes>> geometryResMap_;
+        VzComponentPool<std::unique_ptr<VzMaterialRes>> materialResMap_;
+        VzComponentPool<std::unique_ptr<VzMIRes>> miResMap_;
+        VzComponentPool<std::unique_ptr<VzTextureRes>> textureResMap_;
+        VzComponentPool<std::unique_ptr<VzFontRes>> fontResMap_;
 
         // GLTF Asset
-        std::unordered_map<AssetVID, std::unique_ptr<VzAssetRes>> assetResMap_;
-        std::unordered_map<SkeletonVID, std::unique_ptr<VzSkeletonRes>> skeletonResMap_;
+        VzComponentPool<std::unique_ptr<VzAssetRes>> assetResMap_;
+        VzComponentPool<std::unique_ptr<VzSkeletonRes>> skeletonResMap_;
+
+        VzComponentPool<std::unique_ptr<VzBaseComp>> vzCompMap_;
+        // non-owning views of vzCompMap_ partitioned by the component type, for contiguous per-type iteration
+        std::array<VzComponentPool<VzBaseComp*>, (size_t)VZ_COMP_TYPE::COUNT> typedVzComps_;
 
-        std::unordered_map<VID, std::unique_ptr<VzBaseComp>> vzCompMap_;
+        std::pair<VzComponentPool<std::unique_ptr<VzBaseComp>>::iterator, bool> emplaceVzComp(const VID vid, std::unique_ptr<VzBaseComp>&& comp);
+        void eraseVzComp(const VID vid);
 
         bool removeScene(SceneVID vidScene);
 
         CompositorQuad* compositor_ = nullptr;
 
+        VzMaterialCache materialCache_; // packages built at runtime with filamat::MaterialBuilder
+        VzIBLCache iblCache_; // prefiltered environments of VzScene::LoadIBL
+        VzBlobCache blobCache_; // program binaries of the backend, outlives the engine's platform
+        VzTextureDecoder* textureDecoder_ = nullptr; // asynchronous VzTexture::ReadImageAsync
+
     public:
         // Runtime can create a new entity with this
         VzScene* CreateScene(const std::string& name);
@@ -411,6 +554,9 @@ namespace vzm
         VzAsset* CreateAsset(const std::string& name);
         VzSkeleton* CreateSkeleton(const std::string& name, const SkeletonVID vidExist = 0);
         size_t GetVidsByName(const std::string& name, std::vector<VID>& vids);
+        size_t GetVidsByNamePattern(const std::string& pattern, std::vector<VID>& vids);
+        // no copy of the matched entities
+        size_t ForEachVidByName(const std::string& name, const std::function<void(VID)>& callback);
         VID GetFirstVidByName(const std::string& name);
         std::string GetNameByVid(const VID vid);
         bool HasComponent(const VID vid);
@@ -419,7 +565,7 @@ namespace vzm
         bool IsLight(const LightVID vid);
         Scene* GetScene(const SceneVID vid);
         Scene* GetFirstSceneByName(const std::string& name);
-        std::unordered_map<SceneVID, Scene*>* GetScenes();
+        VzComponentPool<Scene*>* GetScenes();
 
         VzSceneRes* GetSceneRes(const SceneVID vid);
         VzRenderPath* GetRenderPath(const RendererVID vid);
@@ -427,7 +573,7 @@ namespace vzm
         VzActorRes* GetActorRes(const ActorVID vid);
         VzLightRes* GetLightRes(const LightVID vid);
         VzAssetRes* GetAssetRes(const AssetVID vid);
-        std::unordered_map<AssetVID, std::unique_ptr<VzAssetRes>>* GetAssetResMap() {
+        VzComponentPool<std::unique_ptr<VzAssetRes>>* GetAssetResMap() {
             return &assetResMap_;
         }
         VzSkeletonRes* GetSkeletonRes(const SkeletonVID vid);
@@ -495,23 +641,55 @@ namespace vzm
             return (VZCOMP*)it->second.get();
         }
         size_t GetVzComponentsByType(const std::string& type, std::vector<VzBaseComp*>& components)
+        {
+            return GetVzComponentsByType(GetVzCompType(type), components);
+        }
+        size_t GetVzComponentsByType(const VZ_COMP_TYPE type, std::vector<VzBaseComp*>& components)
         {
             components.clear();
-            for (auto& it : vzCompMap_)
+            if (type == VZ_COMP_TYPE::COUNT)
             {
-                if (it.second->GetType() == type)
-                {
-                    components.push_back(it.second.get());
-                }
+                return 0;
+            }
+            const VzComponentPool<VzBaseComp*>& pool = typedVzComps_[(size_t)type];
+            components.reserve(pool.size());
+            for (auto& it : pool)
+            {
+                components.push_back(it.second);
             }
             return components.size();
         }
+        // contiguous (VID, component) pairs of a type
+        const VzComponentPool<VzBaseComp*>& GetVzComponentPool(const VZ_COMP_TYPE type)
+        {
+            assert(type != VZ_COMP_TYPE::COUNT);
+            return typedVzComps_[(size_t)type];
+        }
 
         size_t LoadMeshFile(const std::string& filename, std::vector<VzActor*>& actors);
 
         gltfio::VzAssetLoader* GetGltfAssetLoader();
         gltfio::VzAssetExpoter* GetGltfAssetExpoter();
-        gltfio::ResourceLoader* GetGltfResourceLoader();
+        VzAssetLoadQueue* GetAssetLoadQueue();
+        VzTextureDecoder* GetTextureDecoder() { return textureDecoder_; }
+        VzMaterialCache& GetMaterialCache() { return materialCache_; }
+        VzIBLCache& GetIBLCache() { return iblCache_; }
+        // installs a file-backed blob cache into the engine's platform (once, before any program is compiled)
+        bool EnableBlobCache(const std::string& directory, const size_t capacityBytes);
+        VzBlobCache& GetBlobCache() { return blobCache_; }
+
+        // levels of detail generated when the geometries are imported (see VzGeometry::GenerateLODs), 0 levels : disabled
+        struct LodSettings
+        {
+            uint32_t levelCount = 0;
+            float reduction = 0.5f;
+            float maxError = 0.05f;
+        } importLODs;
+        // vertex cache, overdraw and vertex fetch optimization of the imported meshes (meshoptimizer),
+        // with a before/after report per primitive
+        bool importOptimizeMeshes = false;
+        // sets the base levels back to the actors of the geometry (before its LODs are destroyed)
+        void ResetActorLODs(const VzGeometryRes* geoRes);
 
         template <typename UM> void destroyTarget(UM& umap)
         {
@@ -532,8 +710,6 @@ namespace vzm
         void Initialize();
         void Destroy();
 
-        AssetVID activeAsyncAsset = INVALID_VID;
-
         FT_Library ftLibrary = nullptr;
     };
 }
@@ -4,20 +4,215 @@
 #include <utils/EntityInstance.h>
 #include <utils/NameComponentManager.h>
 
+#include <span>
+#include <string_view>
+
 // NOTE THAT ALL ENTITIES ARE SUPPOSED TO HAVE NAME COMPONENTS
 namespace vzm
 {
     class VzNameCompManager : public utils::NameComponentManager
     {
     private:
-        std::unordered_multimap<std::string, utils::Entity> nameToEntities_;
+        // name index
+        //  - every distinct name is interned once in entries_, the entities of the entry being its references
+        //  - an entry is released when its last entity is renamed or removed, and its index is recycled by the next
+        //    interned name (freeEntries_), so entries_ does not grow with the names that are no longer used
+        //  - slots_ is an open-addressing (linear probing) hash table of entry index + 1 (0 : empty slot)
+        //  - the entities of a name are contiguous, so a lookup returns a span without copying
+        //  - entityLocations_ makes renaming and removal O(1) (swap-and-pop in the entity array of the entry)
+        struct NameEntry
+        {
+            std::string name;
+            size_t hash = 0;
+            std::vector<utils::Entity> entities;
+            bool interned = false;
+        };
+        struct EntityLocation
+        {
+            uint32_t entry = 0;
+            uint32_t position = 0;
+        };
+        std::vector<NameEntry> entries_;
+        std::vector<uint32_t> freeEntries_;
+        std::vector<uint32_t> slots_;
+        std::unordered_map<utils::Entity, EntityLocation, utils::Entity::Hasher> entityLocations_;
+
+        static size_t hashName(const std::string_view name)
+        {
+            return std::hash<std::string_view>{}(name);
+        }
+        uint32_t findEntry(const std::string_view name, const size_t hash) const
+        {
+            if (slots_.empty())
+            {
+                return UINT32_MAX;
+            }
+            const size_t mask = slots_.size() - 1;
+            for (size_t i = hash & mask; slots_[i] != 0; i = (i + 1) & mask)
+            {
+                const NameEntry& entry = entries_[slots_[i] - 1];
+                if (entry.hash == hash && entry.name == name)
+                {
+                    return slots_[i] - 1;
+                }
+            }
+            return UINT32_MAX;
+        }
+        void rehash(const size_t capacity)
+        {
+            slots_.assign(capacity, 0);
+            const size_t mask = capacity - 1;
+            for (uint32_t e = 0, n = (uint32_t)entries_.size(); e < n; ++e)
+            {
+                if (!entries_[e].interned)
+                {
+                    continue;
+                }
+                size_t i = entries_[e].hash & mask;
+                while (slots_[i] != 0)
+                {
+                    i = (i + 1) & mask;
+                }
+                slots_[i] = e + 1;
+            }
+        }
+        uint32_t internName(const std::string_view name)
+        {
+            const size_t hash = hashName(name);
+            uint32_t e = findEntry(name, hash);
+            if (e != UINT32_MAX)
+            {
+                return e;
+            }
+            if (!freeEntries_.empty())
+            {
+                e = freeEntries_.back();
+                freeEntries_.pop_back();
+                NameEntry& entry = entries_[e];
+                entry.name.assign(name);
+                entry.hash = hash;
+                entry.interned = true;
+            }
+            else
+            {
+                e = (uint32_t)entries_.size();
+                entries_.push_back(NameEntry{ std::string(name), hash, {}, true });
+            }
+            // keep the load factor under 1/2
+            if (2 * (entries_.size() - freeEntries_.size()) > slots_.size())
+            {
+                rehash(std::max(slots_.size() * 2, (size_t)64));
+            }
+            else
+            {
+                const size_t mask = slots_.size() - 1;
+                size_t i = hash & mask;
+                while (slots_[i] != 0)
+                {
+                    i = (i + 1) & mask;
+                }
+                slots_[i] = e + 1;
+            }
+            return e;
+        }
+        void releaseEntry(const uint32_t e)
+        {
+            NameEntry& entry = entries_[e];
+            const size_t mask = slots_.size() - 1;
+            size_t i = entry.hash & mask;
+            while (slots_[i] != e + 1)
+            {
+                i = (i + 1) & mask;
+            }
+            // backward-shift deletion, so that no probe sequence crosses an empty slot
+            slots_[i] = 0;
+            for (size_t j = (i + 1) & mask; slots_[j] != 0; j = (j + 1) & mask)
+            {
+                const size_t home = entries_[slots_[j] - 1].hash & mask;
+                // the entry in j stays if its home slot is cyclically in (i, j]
+                const bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+                if (!stays)
+                {
+                    slots_[i] = slots_[j];
+                    slots_[j] = 0;
+                    i = j;
+                }
+            }
+            entry.name.clear();
+            entry.name.shrink_to_fit();
+            entry.interned = false;
+            freeEntries_.push_back(e);
+        }
+        void indexEntity(const utils::Entity ett, const std::string_view name)
+        {
+            const uint32_t e = internName(name);
+            std::vector<utils::Entity>& entities = entries_[e].entities;
+            entityLocations_[ett] = EntityLocation{ e, (uint32_t)entities.size() };
+            entities.push_back(ett);
+        }
+        void unindexEntity(const utils::Entity ett)
+        {
+            auto it = entityLocations_.find(ett);
+            if (it == entityLocations_.end())
+            {
+                return;
+            }
+            const uint32_t e = it->second.entry;
+            std::vector<utils::Entity>& entities = entries_[e].entities;
+            const uint32_t position = it->second.position;
+            if (position + 1 < entities.size())
+            {
+                entities[position] = entities.back();
+                entityLocations_[entities[position]].position = position;
+            }
+            entities.pop_back();
+            entityLocations_.erase(it);
+            if (entities.empty())
+            {
+                releaseEntry(e);
+            }
+        }
+        // '*' : any sequence (including an empty one), '?' : any single character
+        static bool matchGlob(const std::string_view pattern, const std::string_view name)
+        {
+            size_t p = 0, n = 0;
+            size_t star_p = std::string_view::npos, star_n = 0;
+            while (n < name.size())
+            {
+                if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n]))
+                {
+                    ++p;
+                    ++n;
+                }
+                else if (p < pattern.size() && pattern[p] == '*')
+                {
+                    star_p = p++;
+                    star_n = n;
+                }
+                else if (star_p != std::string_view::npos)
+                {
+                    // let the last '*' consume one more character
+                    p = star_p + 1;
+                    n = ++star_n;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            while (p < pattern.size() && pattern[p] == '*')
+            {
+                ++p;
+            }
+            return p == pattern.size();
+        }
     public:
 
         using Instance = utils::EntityInstance<NameComponentManager>;
 
 
         //explicit NameComponentManager(EntityManager& em);
-        explicit VzNameCompManager(utils::EntityManager& em) : 
+        explicit VzNameCompManager(utils::EntityManager& em) :
             utils::NameComponentManager(em) {
         }
 
@@ -26,7 +221,8 @@ namespace vzm
             addComponent(ett);
             setName(getInstance(ett), name.c_str());
 
-            nameToEntities_.emplace(name, ett);
+            unindexEntity(ett);
+            indexEntity(ett, name);
         }
         void RemoveEntity(utils::Entity ett)
         {
@@ -36,35 +232,60 @@ namespace vzm
                 return;
             }
 
-            std::string name(getName(ins));
-            auto range = nameToEntities_.equal_range(name);
-            for (auto it = range.first; it != range.second; ++it) {
-                if (it->second == ett)
-                {
-                    nameToEntities_.erase(it);
-                    break;
-                }
-            }
-
+            unindexEntity(ett);
             removeComponent(ett);
         }
-        std::vector<utils::Entity> GetEntitiesByName(const std::string& name) const
+        // the span is valid until an entity is (re)named or removed
+        std::span<const utils::Entity> GetEntitiesByName(const std::string_view name) const
         {
-            std::vector<utils::Entity> result;
-            auto range = nameToEntities_.equal_range(name);
-            for (auto it = range.first; it != range.second; ++it) {
-                result.push_back(it->second);
+            const uint32_t e = findEntry(name, hashName(name));
+            if (e == UINT32_MAX)
+            {
+                return {};
             }
-            return result;
+            return entries_[e].entities;
         }
-        utils::Entity GetFirstEntityByName(const std::string& name) const
+        utils::Entity GetFirstEntityByName(const std::string_view name) const
         {
-            auto it = nameToEntities_.find(name);
-            if (it == nameToEntities_.end())
+            std::span<const utils::Entity> etts = GetEntitiesByName(name);
+            if (etts.empty())
             {
                 return utils::Entity();
             }
-            return it->second;
+            return etts[0];
+        }
+        // glob query over the distinct names ('*' : any sequence, '?' : any single character, e.g., "Bone_*" for a prefix)
+        //  - visitor(utils::Entity) must not (re)name or remove entities
+        //  - return # of the visited entities
+        template <typename Visitor>
+        size_t ForEachEntityByPattern(const std::string_view pattern, Visitor&& visitor) const
+        {
+            if (pattern.find_first_of("*?") == std::string_view::npos)
+            {
+                std::span<const utils::Entity> etts = GetEntitiesByName(pattern);
+                for (utils::Entity ett : etts)
+                {
+                    visitor(ett);
+                }
+                return etts.size();
+            }
+            // the literal prefix rejects most of the names without running the matcher
+            const std::string_view prefix = pattern.substr(0, pattern.find_first_of("*?"));
+            size_t count = 0;
+            for (const NameEntry& entry : entries_)
+            {
+                if (entry.entities.empty() || entry.name.compare(0, prefix.size(), prefix) != 0
+                    || !matchGlob(pattern.substr(prefix.size()), std::string_view(entry.name).substr(prefix.size())))
+                {
+                    continue;
+                }
+                for (utils::Entity ett : entry.entities)
+                {
+                    visitor(ett);
+                }
+                count += entry.entities.size();
+            }
+            return count;
         }
         std::string GetName(utils::Entity ett)
         {
@@ -83,6 +304,9 @@ namespace vzm
                 return;
             }
             setName(ins, name.c_str());
+
+            unindexEntity(ett);
+            indexEntity(ett, name);
         }
         static VzNameCompManager& Get() noexcept
         {
@@ -36,18 +36,71 @@ namespace vzm
                 gEngine->destroy(viewGui_);
             if (viewCompositor_)
                 gEngine->destroy(viewCompositor_);
-            if (rtTexture_)
-                gEngine->destroy(rtTexture_);
-            if (rtGuiTexture_)
-                gEngine->destroy(rtGuiTexture_);
-            //if (rtDepthTexture_)
-            //    gEngine->destroy(rtDepthTexture_);
-            //if (rtGuiDepthTexture_)
-            //    gEngine->destroy(rtGuiDepthTexture_);
-            if (offscreenRT_)
-                gEngine->destroy(offscreenRT_);
-            if (offscreenRT_)
-                gEngine->destroy(offscreenGuiRT_);
+            destroyOffscreenTargets();
+        }
+    }
+
+    void VzRenderPath::destroyOffscreenTargets()
+    {
+        for (OffscreenTargets& targets : offscreenTargets_)
+        {
+            if (targets.fence)
+                gEngine->destroy(targets.fence);
+            if (targets.offscreenRT)
+                gEngine->destroy(targets.offscreenRT);
+            if (targets.offscreenGuiRT)
+                gEngine->destroy(targets.offscreenGuiRT);
+            if (targets.rtTexture)
+                gEngine->destroy(targets.rtTexture);
+            if (targets.rtGuiTexture)
+                gEngine->destroy(targets.rtGuiTexture);
+            //if (targets.rtDepthTexture)
+            //    gEngine->destroy(targets.rtDepthTexture);
+            //if (targets.rtGuiDepthTexture)
+            //    gEngine->destroy(targets.rtGuiDepthTexture);
+            targets = {};
+        }
+        targetIndex_ = 0;
+    }
+
+    void VzRenderPath::createOffscreenTargets()
+    {
+        destroyOffscreenTargets();
+
+        // the composited render mode uses the transient buffers of the views' frame graph
+        const uint32_t num_targets = compositedRenderMode_ ? 0 : framesInFlight_;
+        for (uint32_t i = 0; i < num_targets; ++i)
+        {
+            OffscreenTargets& targets = offscreenTargets_[i];
+            targets.rtTexture = Texture::Builder()
+                .width(width_).height(height_).levels(1)
+                .usage(TextureUsage::COLOR_ATTACHMENT | TextureUsage::SAMPLEABLE)
+                .format(TextureFormat::RGBA8).build(*gEngine);
+
+            targets.rtGuiTexture = Texture::Builder()
+                .width(width_).height(height_).levels(1)
+                .usage(TextureUsage::COLOR_ATTACHMENT | TextureUsage::SAMPLEABLE)
+                .format(TextureFormat::RGBA8).build(*gEngine);
+
+            //targets.rtDepthTexture = Texture::Builder()
+            //    .width(width_).height(height_).levels(1)
+            //    .usage(Texture::Usage::DEPTH_ATTACHMENT | TextureUsage::SAMPLEABLE)
+            //    .format(Texture::InternalFormat::DEPTH32F).build(*gEngine);
+
+            //targets.rtGuiDepthTexture = Texture::Builder()
+            //    .width(width_).height(height_).levels(1)
+            //    .usage(Texture::Usage::DEPTH_ATTACHMENT | TextureUsage::SAMPLEABLE)
+            //    .format(Texture::InternalFormat::DEPTH32F).build(*gEngine);
+
+            targets.offscreenRT = RenderTarget::Builder()
+                .texture(RenderTarget::AttachmentPoint::COLOR, targets.rtTexture)
+                //.texture(RenderTarget::AttachmentPoint::DEPTH, targets.rtDepthTexture)
+                .build(*gEngine);
+
+            targets.offscreenGuiRT = RenderTarget::Builder()
+                .texture(RenderTarget::AttachmentPoint::COLOR, targets.rtGuiTexture)
+                //.texture(RenderTarget::AttachmentPoint::DEPTH, targets.rtGuiDepthTexture)
+                .build(*gEngine);
         }
     }
 
@@ -72,42 +125,7 @@ namespace vzm
                     //renderer_->endFrame();
                 }
 
-                gEngine->destroy(offscreenRT_);
-                gEngine->destroy(offscreenGuiRT_);
-                gEngine->destroy(rtTexture_);
-                gEngine->destroy(rtGuiTexture_);
-                //gEngine->destroy(rtDepthTexture_);
-                //gEngine->destroy(rtGuiDepthTexture_);
-
-                rtTexture_ = Texture::Builder()
-                    .width(width_).height(height_).levels(1)
-                    .usage(TextureUsage::COLOR_ATTACHMENT | TextureUsage::SAMPLEABLE)
-                    .format(TextureFormat::RGBA8).build(*gEngine);
-
-                rtGuiTexture_ = Texture::Builder()
-                    .width(width_).height(height_).levels(1)
-                    .usage(TextureUsage::COLOR_ATTACHMENT | TextureUsage::SAMPLEABLE)
-                    .format(TextureFormat::RGBA8).build(*gEngine);
-
-                //rtDepthTexture_ = Texture::Builder()
-                //    .width(width_).height(height_).levels(1)
-                //    .usage(Texture::Usage::DEPTH_ATTACHMENT | TextureUsage::SAMPLEABLE)
-                //    .format(Texture::InternalFormat::DEPTH32F).build(*gEngine);
-
-                //rtGuiDepthTexture_ = Texture::Builder()
-                //    .width(width_).height(height_).levels(1)
-                //    .usage(Texture::Usage::DEPTH_ATTACHMENT | TextureUsage::SAMPLEABLE)
-                //    .format(Texture::InternalFormat::DEPTH32F).build(*gEngine);
-
-                offscreenRT_ = RenderTarget::Builder()
-                    .texture(RenderTarget::AttachmentPoint::COLOR, rtTexture_)
-                    //.texture(RenderTarget::AttachmentPoint::DEPTH, rtDepthTexture_)
-                    .build(*gEngine);
-
-                offscreenGuiRT_ = RenderTarget::Builder()
-                    .texture(RenderTarget::AttachmentPoint::COLOR, rtGuiTexture_)
-                    //.texture(RenderTarget::AttachmentPoint::DEPTH, rtGuiDepthTexture_)
-                    .build(*gEngine);
+                createOffscreenTargets();
             };
 
         //utils::JobSystem::Job* parent = js.createJob();
@@ -123,21 +141,260 @@ namespace vzm
 
         colorspaceConversionRequired_ = colorSpace_ != SWAP_CHAIN_CONFIG_SRGB_COLORSPACE;
 
-        bool requireUpdateRenderTarget = prevWidth_ != width_ || prevHeight_ != height_ || prevDpi_ != dpi_
+        const bool requireUpdateSwapChain = prevWidth_ != width_ || prevHeight_ != height_ || prevDpi_ != dpi_
+            || prevNativeWindow_ != nativeWindow_
             || prevColorspaceConversionRequired_ != colorspaceConversionRequired_;
-        if (!requireUpdateRenderTarget)
+        // the swapchain does not depend on the offscreen targets
+        const bool requireUpdateOffscreenTargets = prevFramesInFlight_ != framesInFlight_
+            || prevCompositedRenderMode_ != compositedRenderMode_;
+        if (requireUpdateSwapChain)
+        {
+            resize(); // how to handle rendertarget textures??
+        }
+        else if (requireUpdateOffscreenTargets)
+        {
+            createOffscreenTargets();
+        }
+        else
+        {
             return false;
-
-        resize(); // how to handle rendertarget textures??
+        }
 
         prevWidth_ = width_;
         prevHeight_ = height_;
         prevDpi_ = dpi_;
         prevNativeWindow_ = nativeWindow_;
         prevColorspaceConversionRequired_ = colorspaceConversionRequired_;
+        prevFramesInFlight_ = framesInFlight_;
+        prevCompositedRenderMode_ = compositedRenderMode_;
         return true;
     }
 
+    void VzRenderPath::SetFramesInFlight(const uint32_t count)
+    {
+        // the offscreen targets are reallocated in the next TryResizeRenderTargets()
+        framesInFlight_ = std::clamp(count, 1u, MAX_FRAMES_IN_FLIGHT);
+    }
+
+    void VzRenderPath::AcquireRenderTargets()
+    {
+        targetIndex_ = (targetIndex_ + 1) % framesInFlight_;
+        OffscreenTargets& targets = offscreenTargets_[targetIndex_];
+        if (targets.fence)
+        {
+            // the targets are recycled, so the frame that used them must be done
+            Fence::waitAndDestroy(targets.fence);
+            targets.fence = nullptr;
+        }
+    }
+
+    void VzRenderPath::SubmitRenderTargets()
+    {
+        if (!IsPipelined() || compositedRenderMode_)
+        {
+            return;
+        }
+        OffscreenTargets& targets = offscreenTargets_[targetIndex_];
+        assert(targets.fence == nullptr);
+        targets.fence = gEngine->createFence();
+    }
+
+    void VzRenderPath::ApplyBillboards(Scene* scene, const Camera* camera)
+    {
+        numBillboards_ = billboardEntities_.size();
+        if (numBillboards_ == 0)
+        {
+            return;
+        }
+
+        auto& tcm = gEngine->getTransformManager();
+        const double3 v = camera->getForwardVector();
+        const double3 u = camera->getUpVector();
+
+        // the descendants of the billboards (except the nested billboards, which face the camera on their own)
+        billboardOwners_.resize(numBillboards_);
+        for (uint32_t i = 0; i < (uint32_t)numBillboards_; ++i)
+        {
+            billboardOwners_[i] = i;
+        }
+        for (size_t i = 0; i < billboardEntities_.size(); ++i)
+        {
+            const TransformManager::Instance ti = tcm.getInstance(billboardEntities_[i]);
+            const size_t num_children = ti.isValid() ? tcm.getChildCount(ti) : 0;
+            if (num_children == 0)
+            {
+                continue;
+            }
+            const size_t first = billboardEntities_.size();
+            billboardEntities_.resize(first + num_children);
+            tcm.getChildren(ti, billboardEntities_.data() + first, num_children);
+            for (size_t j = first; j < billboardEntities_.size(); ++j)
+            {
+                VzActorRes* actor_res = gEngineApp->GetActorRes(billboardEntities_[j].getId());
+                if (actor_res && actor_res->isBillboard)
+                {
+                    std::swap(billboardEntities_[j], billboardEntities_.back());
+                    billboardEntities_.pop_back();
+                    --j;
+                    continue;
+                }
+                billboardOwners_.push_back(billboardOwners_[i]);
+            }
+        }
+        billboardWorlds_.resize(billboardEntities_.size());
+        billboardDeltas_.resize(numBillboards_);
+
+        // note that the facing transforms are computed with the world transforms of the TransformManager,
+        // so a billboard nested in another billboard follows its parent's non-facing transform
+        auto computeFacing = [this, &tcm, &v, &u](mat4* worlds, size_t count)
+            {
+                const size_t offset = worlds - billboardWorlds_.data();
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const mat4 os2ws = tcm.getWorldTransformAccurate(tcm.getInstance(billboardEntities_[offset + i]));
+                    const double3 p_ws = os2ws[3].xyz / os2ws[3].w;
+                    worlds[i] = mat4::lookTo(v, p_ws, u);
+                    billboardDeltas_[offset + i] = worlds[i] * inverse(os2ws);
+                }
+            };
+        auto computeDescendants = [this, &tcm](mat4* worlds, size_t count)
+            {
+                const size_t offset = worlds - billboardWorlds_.data();
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const mat4 os2ws = tcm.getWorldTransformAccurate(tcm.getInstance(billboardEntities_[offset + i]));
+                    worlds[i] = billboardDeltas_[billboardOwners_[offset + i]] * os2ws;
+                }
+            };
+
+        utils::JobSystem& js = gEngine->getJobSystem();
+        utils::JobSystem::Job* job = utils::jobs::parallel_for(js, nullptr,
+            billboardWorlds_.data(), (uint32_t)numBillboards_,
+            std::cref(computeFacing), utils::jobs::CountSplitter<64>());
+        js.runAndWait(job);
+        if (billboardWorlds_.size() > numBillboards_)
+        {
+            job = utils::jobs::parallel_for(js, nullptr,
+                billboardWorlds_.data() + numBillboards_, (uint32_t)(billboardWorlds_.size() - numBillboards_),
+                std::cref(computeDescendants), utils::jobs::CountSplitter<64>());
+            js.runAndWait(job);
+        }
+
+        scene->setWorldTransformOverrides(billboardEntities_.data(), billboardWorlds_.data(), billboardEntities_.size());
+    }
+
+    void VzRenderPath::ResetBillboards(Scene* scene)
+    {
+        if (numBillboards_ > 0)
+        {
+            scene->setWorldTransformOverrides(nullptr, nullptr, 0);
+        }
+    }
+
+    void VzRenderPath::AddLOD(const Entity ett, VzActorRes* actorRes, VzGeometryRes* geoRes)
+    {
+        auto& rcm = gEngine->getRenderableManager();
+        auto& tcm = gEngine->getTransformManager();
+        RenderableManager::Instance ri = rcm.getInstance(ett);
+        if (!ri.isValid())
+        {
+            return;
+        }
+        lodActors_.push_back({ ri, tcm.getInstance(ett), actorRes, geoRes, 0 });
+    }
+
+    void VzRenderPath::ApplyLODs(const Camera* camera)
+    {
+        if (lodActors_.empty())
+        {
+            return;
+        }
+        auto& tcm = gEngine->getTransformManager();
+        auto& rcm = gEngine->getRenderableManager();
+
+        const mat4 proj = camera->getProjectionMatrix();
+        const bool ortho = proj[3][3] == 1.0;
+        const double3 eye = camera->getPosition();
+        const float viewport_h = (float)view_->getViewport().height;
+        const float pixel_error = lodPixelError;
+
+        // a single level is selected for all the primitives of an actor (their errors are relative to their own extent,
+        // so the coarsest level of the primitive having the fewest levels is the limit)
+        auto selectLevel = [&](LodActor* actors, size_t count)
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    LodActor& lod_actor = actors[i];
+                    lod_actor.level = 0;
+                    if (!lod_actor.geo->HasLODs())
+                    {
+                        continue;
+                    }
+                    const mat4f os2ws = tcm.getWorldTransform(lod_actor.ti);
+                    const float3 center_ws = (os2ws * float4(lod_actor.geo->aabb.center(), 1.f)).xyz;
+                    const float scale = std::max({ length(os2ws[0].xyz), length(os2ws[1].xyz), length(os2ws[2].xyz) });
+                    const float radius = length(lod_actor.geo->aabb.extent()) * scale;
+
+                    // projected diameter of the bounding sphere, in pixels
+                    float diameter = radius * (float)proj[1][1] * viewport_h;
+                    if (!ortho)
+                    {
+                        const float dist = (float)length(double3(center_ws) - eye);
+                        if (dist <= radius)
+                        {
+                            continue;
+                        }
+                        diameter /= dist;
+                    }
+
+                    uint32_t level = ~0u;
+                    for (const VzPrimitive& prim : *lod_actor.geo->Get())
+                    {
+                        if (prim.ptype == PrimitiveType::TRIANGLES)
+                        {
+                            level = std::min(level, VzMeshLOD::Select(prim.lods, diameter, pixel_error));
+                        }
+                    }
+                    lod_actor.level = level == ~0u ? 0 : (uint8_t)level;
+                }
+            };
+
+        utils::JobSystem& js = gEngine->getJobSystem();
+        utils::JobSystem::Job* job = utils::jobs::parallel_for(js, nullptr,
+            lodActors_.data(), (uint32_t)lodActors_.size(),
+            std::cref(selectLevel), utils::jobs::CountSplitter<64>());
+        js.runAndWait(job);
+
+        // the renderables are modified only when their level changes
+        for (const LodActor& lod_actor : lodActors_)
+        {
+            std::vector<VzPrimitive>& primitives = *lod_actor.geo->Get();
+            std::vector<uint8_t>& levels = lod_actor.actor->lodLevels;
+            levels.resize(primitives.size(), 0);
+            for (size_t i = 0, n = primitives.size(); i < n; ++i)
+            {
+                const VzPrimitive& prim = primitives[i];
+                const uint8_t level = (uint8_t)std::min<size_t>(lod_actor.level, prim.lods.size());
+                if (levels[i] == level)
+                {
+                    continue;
+                }
+                if (level == 0)
+                {
+                    rcm.setGeometryAt(lod_actor.ri, i, (RenderableManager::PrimitiveType)prim.ptype,
+                        prim.vertices, prim.indices, 0, prim.indices->getIndexCount());
+                }
+                else
+                {
+                    const VzLodLevel& lod = prim.lods[level - 1];
+                    rcm.setGeometryAt(lod_actor.ri, i, (RenderableManager::PrimitiveType)prim.ptype,
+                        prim.vertices, prim.lodIndices, lod.offset, lod.count);
+                }
+                levels[i] = level;
+            }
+        }
+    }
+
     void VzRenderPath::SetFixedTimeUpdate(const float targetFPS)
     {
         targetFrameRate_ = targetFPS;
@@ -2,13 +2,25 @@
 #define VZRENDERPATH_H
 #include "VzComponents.h"
 #include "FIncludes.h"
+#include "backend/VzMeshBVH.h"
+
+#include <filament/Fence.h>
+#include <filament/RenderTarget.h>
+
+#include <array>
+#include <vector>
 
 #define CANVAS_INIT_W 16u
 #define CANVAS_INIT_H 16u
 #define CANVAS_INIT_DPI 96.f
 
+#define MAX_FRAMES_IN_FLIGHT 3u
+
 namespace vzm
 {
+    struct VzActorRes;
+    struct VzGeometryRes;
+
     enum class ToneMapping : uint8_t {
         LINEAR = 0,
         ACES_LEGACY = 1,
@@ -126,6 +138,33 @@ namespace vzm
 
     // note that renderPath involves 
     // 1. canvas (render targets), 2. camera, 3. scene
+    struct VzBaseSprite;
+    // the mesh and sprite actors gathered for ray queries
+    struct RayQueryScene
+    {
+        std::vector<VID> meshActors;
+        std::vector<mat4f> meshInvWorlds;
+        std::vector<const VzMeshBVH*> meshBVHs;
+        std::vector<float3> meshBoxMins;
+        std::vector<float3> meshBoxMaxs;
+        std::vector<int> meshSprites; // index of the enclosing sprite (-1 if none)
+        std::vector<VzBaseSprite*> sprites; // an enclosing sprite precedes the sprites under it
+        std::vector<int> spriteParents; // index of the enclosing sprite (-1 if none)
+        VzSceneBVH sceneBVH;
+
+        void Clear()
+        {
+            meshActors.clear();
+            meshInvWorlds.clear();
+            meshBVHs.clear();
+            meshBoxMins.clear();
+            meshBoxMaxs.clear();
+            meshSprites.clear();
+            sprites.clear();
+            spriteParents.clear();
+        }
+    };
+
     class VzRenderPath : public VzCanvas
     {
     private:
@@ -156,15 +195,62 @@ namespace vzm
         // potentially possible to replace current headless texture-sharing mechanism
         // wo/ modifying filament core backend
         // 240926. using view's default (internal) depth buffer for depth test
-        Texture* rtTexture_ = nullptr;
-        //Texture* rtDepthTexture_ = nullptr;
-
-        Texture* rtGuiTexture_ = nullptr;
-        //Texture* rtGuiDepthTexture_ = nullptr;
-
-        RenderTarget* offscreenRT_ = nullptr;
-        RenderTarget* offscreenGuiRT_ = nullptr;
-
+        struct OffscreenTargets
+        {
+            Texture* rtTexture = nullptr;
+            //Texture* rtDepthTexture = nullptr;
+
+            Texture* rtGuiTexture = nullptr;
+            //Texture* rtGuiDepthTexture = nullptr;
+
+            RenderTarget* offscreenRT = nullptr;
+            RenderTarget* offscreenGuiRT = nullptr;
+
+            // signaled when the frame that last rendered into these targets has been consumed
+            // only waited for when the targets are recycled by a later frame
+            Fence* fence = nullptr;
+        };
+        // a ring of offscreen targets, one per in-flight frame
+        std::array<OffscreenTargets, MAX_FRAMES_IN_FLIGHT> offscreenTargets_ = {};
+        uint32_t framesInFlight_ = 1; // 1 : synchronous rendering (each frame waits for the driver)
+        uint32_t prevFramesInFlight_ = 0;
+        uint32_t targetIndex_ = 0;
+
+        // composited render mode: the main and gui views are rendered into the swapchain within a single frame
+        // and the gui view is blended over the main view by the view's own frame graph (transient color buffer),
+        // so neither the offscreen targets nor the compositor pass are required
+        bool compositedRenderMode_ = false;
+        bool prevCompositedRenderMode_ = false;
+
+        // camera-facing world transforms of the billboard actors in the scene being rendered
+        //  - the billboards come first, followed by their descendants, which keep their placement relative to
+        //    their billboard
+        //  - the transforms are passed to the scene as world transform overrides, the TransformManager is not modified
+        // flat arrays reused over frames (no allocation once they reach the number of billboards)
+        std::vector<Entity> billboardEntities_;
+        std::vector<mat4> billboardWorlds_;
+        std::vector<uint32_t> billboardOwners_; // index of the billboard of each entity
+        std::vector<mat4> billboardDeltas_;     // facing * inverse(world) of each billboard
+        size_t numBillboards_ = 0;
+
+        // actors whose geometry has levels of detail, in the scene being rendered
+        struct LodActor
+        {
+            RenderableManager::Instance ri;
+            TransformManager::Instance ti;
+            VzActorRes* actor;
+            VzGeometryRes* geo;
+            uint8_t level; // selected level of all the primitives of the actor (0 : base level)
+        };
+        std::vector<LodActor> lodActors_;
+
+        // ray query scratch (see VzRenderer::IntersectActors and IntersectRays)
+        RayQueryScene rayQueryScene_;
+
+        void destroyOffscreenTargets();
+        // (re)allocates the ring of offscreen targets, the swapchain is kept
+        void createOffscreenTargets();
+        // recreates the swapchain and the offscreen targets
         void resize();
 
     public:
@@ -174,11 +260,48 @@ namespace vzm
 
         bool TryResizeRenderTargets();
 
-        Texture* GetTextureRT() { return  rtTexture_; }
-        RenderTarget* GetOffscreenRT() { return  offscreenRT_; }
-
-        Texture* GetGuiTextureRT() { return  rtGuiTexture_; }
-        RenderTarget* GetOffscreenGuiRT() { return  offscreenGuiRT_; }
+        // pipelined rendering
+        //  - count == 1 : the main thread waits for the driver at every frame (default)
+        //  - count > 1 : up to 'count' frames are in flight, each owning its offscreen targets
+        void SetFramesInFlight(const uint32_t count);
+        uint32_t GetFramesInFlight() const { return framesInFlight_; }
+        bool IsPipelined() const { return framesInFlight_ > 1; }
+        // moves to the next offscreen targets and waits only if they are still used by an in-flight frame
+        void AcquireRenderTargets();
+        // marks the current offscreen targets as in-flight (call after Renderer::endFrame)
+        void SubmitRenderTargets();
+
+        // the offscreen targets are released (or reallocated) in the next TryResizeRenderTargets()
+        void SetCompositedRenderMode(const bool enabled) { compositedRenderMode_ = enabled; }
+        bool IsCompositedRenderMode() const { return compositedRenderMode_; }
+
+        Texture* GetTextureRT() { return  offscreenTargets_[targetIndex_].rtTexture; }
+        RenderTarget* GetOffscreenRT() { return  offscreenTargets_[targetIndex_].offscreenRT; }
+
+        Texture* GetGuiTextureRT() { return  offscreenTargets_[targetIndex_].rtGuiTexture; }
+        RenderTarget* GetOffscreenGuiRT() { return  offscreenTargets_[targetIndex_].offscreenGuiRT; }
+
+        // billboard pass
+        //  - ClearBillboards() and AddBillboard() gather the billboard actors of the scene
+        //  - ApplyBillboards() computes the camera-facing world transforms in parallel and sets them as the scene's
+        //    world transform overrides
+        //  - ResetBillboards() removes the overrides from the scene (call after rendering)
+        void ClearBillboards() { billboardEntities_.clear(); }
+        void AddBillboard(const Entity ett) { billboardEntities_.push_back(ett); }
+        void ApplyBillboards(Scene* scene, const Camera* camera);
+        void ResetBillboards(Scene* scene);
+
+        // LOD pass
+        //  - ClearLODs() and AddLOD() gather the actors whose geometry has levels of detail
+        //  - ApplyLODs() selects the levels from the projected bounding spheres in parallel, and swaps the index ranges
+        //    of the primitives whose level has changed since the previous frame
+        void ClearLODs() { lodActors_.clear(); }
+        void AddLOD(const Entity ett, VzActorRes* actorRes, VzGeometryRes* geoRes);
+        void ApplyLODs(const Camera* camera);
+        float lodPixelError = 1.f; // tolerated error of a level on screen, in pixels
+
+        // the arrays are cleared but not released, so repeated queries do not allocate
+        RayQueryScene& GetRayQueryScene() { return rayQueryScene_; }
 
         void SetFixedTimeUpdate(const float targetFPS);
         float GetFixedTimeUpdate() const;
@@ -0,0 +1,348 @@
+#include "../VzEngineApp.h"
+#include "../FIncludes.h"
+#include "VzAssetLoadQueue.h"
+
+#include <algorithm>
+#include <chrono>
+
+extern Engine* gEngine;
+extern vzm::VzEngineApp* gEngineApp;
+
+namespace vzm
+{
+    VzAssetLoadQueue::~VzAssetLoadQueue()
+    {
+        for (auto& slot : slots_)
+        {
+            if (slot->vidAsset != INVALID_VID)
+            {
+                slot->loader->asyncCancelLoad();
+            }
+            delete slot->loader;
+            delete slot->stbDecoder;
+            delete slot->ktxDecoder;
+        }
+        slots_.clear();
+    }
+
+    VzAssetLoadQueue::LoadSlot* VzAssetLoadQueue::findSlot(const VID vidAsset) const
+    {
+        for (auto& slot : slots_)
+        {
+            if (slot->vidAsset == vidAsset)
+            {
+                return slot.get();
+            }
+        }
+        return nullptr;
+    }
+
+    VzAssetLoadQueue::LoadSlot* VzAssetLoadQueue::acquireSlot()
+    {
+        size_t in_flight = 0;
+        LoadSlot* idle_slot = nullptr;
+        for (auto& slot : slots_)
+        {
+            if (slot->vidAsset != INVALID_VID)
+            {
+                in_flight++;
+            }
+            else if (idle_slot == nullptr)
+            {
+                idle_slot = slot.get();
+            }
+        }
+        if (in_flight >= maxInFlight_)
+        {
+            return nullptr;
+        }
+        if (idle_slot)
+        {
+            return idle_slot;
+        }
+
+        // a slot keeps its loader and texture providers for the next loads
+        gltfio::ResourceConfiguration configuration = {};
+        configuration.engine = gEngine;
+        configuration.gltfPath = "";
+        configuration.normalizeSkinningWeights = true;
+
+        auto slot = std::make_unique<LoadSlot>();
+        slot->loader = new gltfio::ResourceLoader(configuration);
+        slot->stbDecoder = gltfio::createStbProvider(gEngine);
+        slot->ktxDecoder = gltfio::createKtx2Provider(gEngine);
+        slot->loader->addTextureProvider("image/png", slot->stbDecoder);
+        slot->loader->addTextureProvider("image/jpeg", slot->stbDecoder);
+        slot->loader->addTextureProvider("image/ktx2", slot->ktxDecoder);
+        slots_.push_back(std::move(slot));
+        return slots_.back().get();
+    }
+
+    bool VzAssetLoadQueue::startLoad(LoadSlot& slot, const PendingLoad& request)
+    {
+        VzAssetRes* asset_res = gEngineApp->GetAssetRes(request.vidAsset);
+        if (asset_res == nullptr || asset_res->asset == nullptr)
+        {
+            return false;
+        }
+
+        gltfio::ResourceConfiguration configuration = {};
+        configuration.engine = gEngine;
+        configuration.gltfPath = request.gltfPath.c_str();
+        configuration.normalizeSkinningWeights = true;
+        configuration.optimizeMeshes = gEngineApp->importOptimizeMeshes;
+        slot.loader->setConfiguration(configuration);
+        slot.pushedBase = slot.stbDecoder->getPushedCount() + slot.ktxDecoder->getPushedCount();
+        slot.poppedBase = slot.stbDecoder->getPoppedCount() + slot.ktxDecoder->getPoppedCount();
+        if (!slot.loader->asyncBeginLoad(asset_res->asset))
+        {
+            return false;
+        }
+        // the source buffers are loaded (and kept until the asset's resources are evicted)
+        const VzEngineApp::LodSettings& lod_settings = gEngineApp->importLODs;
+        if (lod_settings.levelCount > 0)
+        {
+            for (GeometryVID vid_geo : asset_res->fromAssetGeometries)
+            {
+                VzGeometryRes* geo_res = gEngineApp->GetGeometryRes(vid_geo);
+                if (geo_res && geo_res->sourceMesh)
+                {
+                    geo_res->GenerateLODs(lod_settings.levelCount, lod_settings.reduction, lod_settings.maxError);
+                }
+            }
+        }
+        slot.vidAsset = request.vidAsset;
+        slot.priority = request.priority;
+        slot.order = request.order;
+        slot.lastUpdateFrame = frameCount_;
+        return true;
+    }
+
+    void VzAssetLoadQueue::startPendingLoads()
+    {
+        while (!pending_.empty())
+        {
+            LoadSlot* slot = acquireSlot();
+            if (slot == nullptr)
+            {
+                return;
+            }
+            auto it = std::min_element(pending_.begin(), pending_.end(), [](const PendingLoad& a, const PendingLoad& b) {
+                return a.priority != b.priority ? a.priority > b.priority : a.order < b.order;
+                });
+            PendingLoad request = std::move(*it);
+            pending_.erase(it);
+            if (!startLoad(*slot, request))
+            {
+                backlog::post("Unable to start loading resources for asset (" + std::to_string(request.vidAsset) + ")", backlog::LogLevel::Error);
+                releaseAsyncTextures(request.vidAsset);
+            }
+        }
+    }
+
+    float VzAssetLoadQueue::getSlotProgress(const LoadSlot& slot)
+    {
+        const size_t pushed = slot.stbDecoder->getPushedCount() + slot.ktxDecoder->getPushedCount() - slot.pushedBase;
+        const size_t popped = slot.stbDecoder->getPoppedCount() + slot.ktxDecoder->getPoppedCount() - slot.poppedBase;
+        const float progress = pushed == 0 ? 1.f : (float)popped / (float)pushed;
+        // the loader's own progress also counts the textures still to be downloaded (without a file system)
+        return std::min(progress, slot.loader->asyncGetLoadProgress());
+    }
+
+    void VzAssetLoadQueue::releaseAsyncTextures(const VID vidAsset)
+    {
+        VzAssetRes* asset_res = gEngineApp->GetAssetRes(vidAsset);
+        if (asset_res == nullptr)
+        {
+            return;
+        }
+        filament::gltfio::FFilamentAsset* fasset = downcast(asset_res->asset);
+        for (auto& it : asset_res->asyncTextures)
+        {
+            VzTextureRes* tex_res = gEngineApp->GetTextureRes(it.second);
+            if (tex_res == nullptr)
+            {
+                continue;
+            }
+            tex_res->texture = fasset->mTextures[it.first].texture;
+            tex_res->isAsyncLocked = false;
+        }
+        asset_res->asyncTextures.clear();
+    }
+
+    bool VzAssetLoadQueue::Enqueue(const VID vidAsset, const std::string& gltfPath, const int priority)
+    {
+        if (GetProgress(vidAsset) >= 0.f)
+        {
+            backlog::post("Asset (" + std::to_string(vidAsset) + ") is already queued for loading", backlog::LogLevel::Warning);
+            return true;
+        }
+        PendingLoad request = { vidAsset, gltfPath, priority, requestCount_++ };
+
+        // starts right away unless a pending request goes first
+        const bool preceded = std::any_of(pending_.begin(), pending_.end(), [priority](const PendingLoad& pending) {
+            return pending.priority >= priority;
+            });
+        LoadSlot* slot = preceded ? nullptr : acquireSlot();
+        if (slot == nullptr)
+        {
+            pending_.push_back(std::move(request));
+            return true;
+        }
+        return startLoad(*slot, request);
+    }
+
+    bool VzAssetLoadQueue::SetPriority(const VID vidAsset, const int priority)
+    {
+        if (LoadSlot* slot = findSlot(vidAsset))
+        {
+            slot->priority = priority;
+            return true;
+        }
+        for (PendingLoad& pending : pending_)
+        {
+            if (pending.vidAsset == vidAsset)
+            {
+                pending.priority = priority;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool VzAssetLoadQueue::Cancel(const VID vidAsset)
+    {
+        if (LoadSlot* slot = findSlot(vidAsset))
+        {
+            // only cancels the decoding jobs of this slot's texture providers
+            slot->loader->asyncCancelLoad();
+            slot->vidAsset = INVALID_VID;
+            releaseAsyncTextures(vidAsset);
+            return true;
+        }
+        auto it = std::find_if(pending_.begin(), pending_.end(), [vidAsset](const PendingLoad& pending) {
+            return pending.vidAsset == vidAsset;
+            });
+        if (it == pending_.end())
+        {
+            return false;
+        }
+        pending_.erase(it);
+        releaseAsyncTextures(vidAsset);
+        return true;
+    }
+
+    void VzAssetLoadQueue::CancelAll()
+    {
+        std::vector<VID> vids;
+        for (PendingLoad& pending : pending_)
+        {
+            vids.push_back(pending.vidAsset);
+        }
+        for (auto& slot : slots_)
+        {
+            if (slot->vidAsset != INVALID_VID)
+            {
+                vids.push_back(slot->vidAsset);
+            }
+        }
+        for (VID vid : vids)
+        {
+            Cancel(vid);
+        }
+    }
+
+    void VzAssetLoadQueue::Update()
+    {
+        frameCount_++;
+        startPendingLoads();
+
+        std::vector<LoadSlot*> in_flight;
+        for (auto& slot : slots_)
+        {
+            if (slot->vidAsset != INVALID_VID)
+            {
+                in_flight.push_back(slot.get());
+            }
+        }
+        // among the same priority, the least recently updated load goes first so that none of them starves
+        std::sort(in_flight.begin(), in_flight.end(), [](const LoadSlot* a, const LoadSlot* b) {
+            if (a->priority != b->priority) return a->priority > b->priority;
+            if (a->lastUpdateFrame != b->lastUpdateFrame) return a->lastUpdateFrame < b->lastUpdateFrame;
+            return a->order < b->order;
+            });
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < in_flight.size(); ++i)
+        {
+            if (i > 0)
+            {
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+                if (elapsed.count() >= uploadBudgetMs_)
+                {
+                    break;
+                }
+            }
+            LoadSlot* slot = in_flight[i];
+            slot->loader->asyncUpdateLoad(); // uploads the decoded textures
+            slot->lastUpdateFrame = frameCount_;
+            if (getSlotProgress(*slot) >= 1.f)
+            {
+                releaseAsyncTextures(slot->vidAsset);
+                slot->vidAsset = INVALID_VID;
+            }
+        }
+
+        startPendingLoads();
+    }
+
+    float VzAssetLoadQueue::GetProgress(const VID vidAsset) const
+    {
+        if (LoadSlot* slot = findSlot(vidAsset))
+        {
+            return getSlotProgress(*slot);
+        }
+        for (const PendingLoad& pending : pending_)
+        {
+            if (pending.vidAsset == vidAsset)
+            {
+                return 0.f;
+            }
+        }
+        return -1.f;
+    }
+
+    float VzAssetLoadQueue::GetProgress() const
+    {
+        const size_t count = GetQueuedCount();
+        if (count == 0)
+        {
+            return 1.f;
+        }
+        float progress = 0.f; // the pending loads count as 0
+        for (auto& slot : slots_)
+        {
+            if (slot->vidAsset != INVALID_VID)
+            {
+                progress += getSlotProgress(*slot);
+            }
+        }
+        return progress / (float)count;
+    }
+
+    size_t VzAssetLoadQueue::GetQueuedCount() const
+    {
+        size_t count = pending_.size();
+        for (auto& slot : slots_)
+        {
+            count += slot->vidAsset != INVALID_VID ? 1 : 0;
+        }
+        return count;
+    }
+
+    void VzAssetLoadQueue::SetMaxInFlight(const size_t maxInFlight)
+    {
+        // the loads beyond a lowered limit keep running until they finish
+        maxInFlight_ = std::max(maxInFlight, (size_t)1);
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef VZASSETLOADQUEUE_H
+#define VZASSETLOADQUEUE_H
+
+#include "../VizComponentAPIs.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace filament::gltfio
+{
+    class ResourceLoader;
+    class TextureProvider;
+}
+
+namespace vzm
+{
+    // asynchronous resource loading of glTF assets
+    //  - up to maxInFlight loads run at once, each in its own slot (a gltfio::ResourceLoader with its own texture providers),
+    //    so the progress and the cancellation of a load do not involve the others
+    //  - the texture decoding of all the slots runs on the engine's JobSystem
+    //  - the other requests wait in the queue, higher priority first (then in request order)
+    //  - Update (once per frame) uploads the decoded textures of the in-flight loads, higher priority first,
+    //    until the per-frame upload budget is spent (at least one load is updated per frame)
+    class VzAssetLoadQueue
+    {
+    private:
+        struct LoadSlot
+        {
+            filament::gltfio::ResourceLoader* loader = nullptr;
+            filament::gltfio::TextureProvider* stbDecoder = nullptr;
+            filament::gltfio::TextureProvider* ktxDecoder = nullptr;
+            VID vidAsset = INVALID_VID; // INVALID_VID : idle slot
+            int priority = 0;
+            uint64_t order = 0;
+            uint64_t lastUpdateFrame = 0;
+            // texture counts of the providers when the load started (the providers count over their lifetime)
+            size_t pushedBase = 0;
+            size_t poppedBase = 0;
+        };
+        struct PendingLoad
+        {
+            VID vidAsset = INVALID_VID;
+            std::string gltfPath;
+            int priority = 0;
+            uint64_t order = 0;
+        };
+
+        std::vector<std::unique_ptr<LoadSlot>> slots_;
+        std::vector<PendingLoad> pending_;
+        size_t maxInFlight_ = 2;
+        double uploadBudgetMs_ = 4.0;
+        uint64_t requestCount_ = 0;
+        uint64_t frameCount_ = 0;
+
+        LoadSlot* findSlot(const VID vidAsset) const;
+        LoadSlot* acquireSlot();
+        bool startLoad(LoadSlot& slot, const PendingLoad& request);
+        void startPendingLoads();
+        static float getSlotProgress(const LoadSlot& slot);
+        // hands the textures of the asset over to its VzTextures (also when the load is canceled)
+        static void releaseAsyncTextures(const VID vidAsset);
+    public:
+        VzAssetLoadQueue() = default;
+        ~VzAssetLoadQueue();
+
+        // the resources of the asset are loaded (asyncBeginLoad) right away if a slot is available,
+        // returns false if that immediate start fails
+        bool Enqueue(const VID vidAsset, const std::string& gltfPath, const int priority = 0);
+        bool SetPriority(const VID vidAsset, const int priority);
+        bool Cancel(const VID vidAsset);
+        void CancelAll();
+        void Update();
+
+        // [0, 1] for the queued (pending or in-flight) assets, -1 if the asset is not queued
+        float GetProgress(const VID vidAsset) const;
+        // progress over all the queued assets (1 if none)
+        float GetProgress() const;
+        size_t GetQueuedCount() const;
+
+        void SetMaxInFlight(const size_t maxInFlight);
+        void SetUploadBudget(const double uploadBudgetMs) { uploadBudgetMs_ = uploadBudgetMs; }
+    };
+}
+#endif
@@ -214,8 +214,13 @@ namespace filament::gltfio {
         return createInstancedAsset(bytes, byteCount, &instances, 1);
     }
 
+    FFilamentAsset* VzAssetLoader::createAsset(const uint8_t* bytes, uint32_t byteCount, std::shared_ptr<void> owner) {
+        FilamentInstance* instances;
+        return createInstancedAsset(bytes, byteCount, &instances, 1, std::move(owner));
+    }
+
     FFilamentAsset* VzAssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_t byteCount,
-        FilamentInstance** instances, size_t numInstances) {
+        FilamentInstance** instances, size_t numInstances, std::shared_ptr<void> owner) {
         // This method can be used to load JSON or GLB. By using a default options struct, we are asking
         // cgltf to examine the magic identifier to determine which type of file is being loaded.
         cgltf_options options{};
@@ -236,13 +241,17 @@ namespace filament::gltfio {
 
         // Clients can free up their source blob immediately, but cgltf has pointers into the data that
         // need to stay valid. Therefore we create a copy of the source blob and stash it inside the
-        // asset.
-        utils::FixedCapacityVector<uint8_t> glbdata(byteCount);
-        std::copy_n(bytes, byteCount, glbdata.data());
+        // asset, unless the client hands over an owner of the blob (e.g. a memory-mapped file).
+        utils::FixedCapacityVector<uint8_t> glbdata;
+        if (!owner) {
+            glbdata = utils::FixedCapacityVector<uint8_t>(byteCount);
+            std::copy_n(bytes, byteCount, glbdata.data());
+            bytes = glbdata.data();
+        }
 
         // The ownership of an allocated `sourceAsset` will be moved to FFilamentAsset::mSourceAsset.
         cgltf_data* sourceAsset;
-        cgltf_result result = cgltf_parse(&options, glbdata.data(), byteCount, &sourceAsset);
+        cgltf_result result = cgltf_parse(&options, bytes, byteCount, &sourceAsset);
         if (result != cgltf_result_success) {
             backlog::post("Unable to parse glTF file.", LogLevel::Error);
             return nullptr;
@@ -256,6 +265,7 @@ namespace filament::gltfio {
             return nullptr;
         }
         glbdata.swap(fAsset->mSourceAsset->glbData);
+        fAsset->mSourceAsset->glbOwner = std::move(owner);
 
         createInstances(numInstances, fAsset);
         if (mError) {
@@ -650,7 +660,9 @@ namespace filament::gltfio {
             CopyFPrim2VFrim(&outputPrim, &v_prim);
             v_prims.push_back(v_prim);
         }
-        mGeometryMap[(cgltf_mesh*)(mesh - gltf->meshes)] = gEngineApp->CreateGeometry(name, v_prims)->GetVID();
+        VzGeometry* v_geo = gEngineApp->CreateGeometry(name, v_prims);
+        gEngineApp->GetGeometryRes(v_geo->GetVID())->sourceMesh = mesh;
+        mGeometryMap[(cgltf_mesh*)(mesh - gltf->meshes)] = v_geo->GetVID();
 
         mat4f worldTransform;
         cgltf_node_transform_world(node, &worldTransform[0][0]);
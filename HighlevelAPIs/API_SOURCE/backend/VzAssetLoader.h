@@ -149,8 +149,10 @@ namespace filament::gltfio {
         std::string mAssetName = "";
 
         FFilamentAsset* createAsset(const uint8_t* bytes, uint32_t nbytes);
+        // parses the blob in place (no copy), the asset keeps the owner alive as long as cgltf points into the blob
+        FFilamentAsset* createAsset(const uint8_t* bytes, uint32_t nbytes, std::shared_ptr<void> owner);
         FFilamentAsset* createInstancedAsset(const uint8_t* bytes, uint32_t numBytes,
-            FilamentInstance** instances, size_t numInstances);
+            FilamentInstance** instances, size_t numInstances, std::shared_ptr<void> owner = nullptr);
         FilamentInstance* createInstance(FFilamentAsset* fAsset);
 
         static void destroy(VzAssetLoader** loader) noexcept {
@@ -0,0 +1,249 @@
+#include "../VzEngineApp.h"
+#include "VzBlobCache.h"
+
+#include <utils/Hash.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace vzm
+{
+    namespace
+    {
+        constexpr uint32_t BLOB_FILE_MAGIC = 0x424d5a56; // "VZMB"
+        constexpr uint32_t BLOB_FILE_VERSION = 1;
+        constexpr const char* BLOB_FILE_EXTENSION = ".blob";
+
+        struct BlobFileHeader
+        {
+            uint32_t magic = BLOB_FILE_MAGIC;
+            uint32_t version = BLOB_FILE_VERSION;
+            uint32_t keySize = 0;
+            uint32_t valueSize = 0;
+            uint32_t valueChecksum = 0;
+            uint32_t reserved = 0;
+        };
+
+        uint32_t checksum(const void* data, const size_t size)
+        {
+            return size == 0 ? 0 : utils::hash::murmurSlow((const uint8_t*)data, size, 0);
+        }
+    }
+
+    uint64_t VzBlobCache::hashKey(const void* key, const size_t keySize)
+    {
+        // two seeds for a 64-bit name, the stored key tells the remaining collisions apart
+        const uint8_t* bytes = (const uint8_t*)key;
+        return ((uint64_t)utils::hash::murmurSlow(bytes, keySize, 0x9e3779b9u) << 32)
+            | (uint64_t)utils::hash::murmurSlow(bytes, keySize, 0x85ebca6bu);
+    }
+
+    std::string VzBlobCache::getFilePath(const uint64_t hash) const
+    {
+        char name[40];
+        snprintf(name, sizeof(name), "%02x/%016llx", (unsigned)(hash >> 56), (unsigned long long)hash);
+        return (fs::path(directory_) / (std::string(name) + BLOB_FILE_EXTENSION)).string();
+    }
+
+    void VzBlobCache::touch(const uint64_t hash, const size_t size)
+    {
+        FileInfo& info = files_[hash];
+        totalBytes_ = totalBytes_ - info.size + size;
+        info.size = size;
+        info.lastUse = ++useCount_;
+    }
+
+    void VzBlobCache::evict()
+    {
+        while (totalBytes_ > capacity_ && !files_.empty())
+        {
+            auto oldest = files_.begin();
+            for (auto it = files_.begin(); it != files_.end(); ++it)
+            {
+                if (it->second.lastUse < oldest->second.lastUse)
+                {
+                    oldest = it;
+                }
+            }
+            std::error_code ec;
+            fs::remove(getFilePath(oldest->first), ec); // another process may have removed it already
+            totalBytes_ -= oldest->second.size;
+            files_.erase(oldest);
+            evictions_++;
+        }
+    }
+
+    bool VzBlobCache::Open(const std::string& directory, const size_t capacityBytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::error_code ec;
+        fs::create_directories(directory, ec);
+        if (!fs::is_directory(directory, ec))
+        {
+            backlog::post("Unable to open the blob cache directory: " + directory, backlog::LogLevel::Error);
+            return false;
+        }
+        directory_ = directory;
+        capacity_ = capacityBytes;
+        files_.clear();
+        totalBytes_ = 0;
+        useCount_ = 0;
+
+        struct Found
+        {
+            fs::file_time_type time;
+            uint64_t hash;
+            size_t size;
+        };
+        std::vector<Found> found;
+        const auto stale_time = fs::file_time_type::clock::now() - std::chrono::hours(1);
+        for (auto it = fs::recursive_directory_iterator(directory_, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec))
+        {
+            if (!it->is_regular_file(ec))
+            {
+                continue;
+            }
+            const fs::path& path = it->path();
+            const fs::file_time_type time = it->last_write_time(ec);
+            if (path.extension() != BLOB_FILE_EXTENSION)
+            {
+                // leftovers of a process that stopped while writing
+                if (path.extension() == ".tmp" && time < stale_time)
+                {
+                    fs::remove(path, ec);
+                }
+                continue;
+            }
+            const std::string stem = path.stem().string();
+            char* end = nullptr;
+            const uint64_t hash = std::strtoull(stem.c_str(), &end, 16);
+            if (stem.size() != 16 || end != stem.c_str() + stem.size())
+            {
+                continue;
+            }
+            found.push_back({ time, hash, (size_t)it->file_size(ec) });
+        }
+        // the use order of the previous launches
+        std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) { return a.time < b.time; });
+        for (const Found& file : found)
+        {
+            touch(file.hash, file.size);
+        }
+        evict();
+        return true;
+    }
+
+    void VzBlobCache::Insert(const void* key, const size_t keySize, const void* value, const size_t valueSize)
+    {
+        if (!IsOpen() || keySize > UINT32_MAX || valueSize > UINT32_MAX)
+        {
+            return;
+        }
+        const uint64_t hash = hashKey(key, keySize);
+        const std::string path = getFilePath(hash);
+        std::error_code ec;
+        fs::create_directories(fs::path(path).parent_path(), ec);
+
+        // unique among the threads and the processes writing the same key
+        static const uint64_t process_salt = std::random_device{}();
+        char suffix[64];
+        snprintf(suffix, sizeof(suffix), ".%llx.%llx.%zx.tmp", (unsigned long long)process_salt,
+            (unsigned long long)tempCount_++, std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        const std::string temp_path = path + suffix;
+        {
+            std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+            if (!out)
+            {
+                return;
+            }
+            BlobFileHeader header;
+            header.keySize = (uint32_t)keySize;
+            header.valueSize = (uint32_t)valueSize;
+            header.valueChecksum = checksum(value, valueSize);
+            out.write((const char*)&header, sizeof(header));
+            out.write((const char*)key, keySize);
+            out.write((const char*)value, valueSize);
+            if (!out)
+            {
+                out.close();
+                fs::remove(temp_path, ec);
+                return;
+            }
+        }
+        fs::rename(temp_path, path, ec);
+        if (ec)
+        {
+            // e.g., the destination is open in another process (Windows), which is as good as inserted
+            fs::remove(temp_path, ec);
+            return;
+        }
+        bytesWritten_ += valueSize;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        touch(hash, sizeof(BlobFileHeader) + keySize + valueSize);
+        evict();
+    }
+
+    size_t VzBlobCache::Retrieve(const void* key, const size_t keySize, void* value, const size_t valueSize)
+    {
+        if (!IsOpen())
+        {
+            return 0;
+        }
+        const uint64_t hash = hashKey(key, keySize);
+        const std::string path = getFilePath(hash);
+        std::ifstream in(path, std::ios::binary);
+        BlobFileHeader header;
+        if (!in || !in.read((char*)&header, sizeof(header)) || header.magic != BLOB_FILE_MAGIC
+            || header.version != BLOB_FILE_VERSION || header.keySize != keySize)
+        {
+            misses_++;
+            return 0;
+        }
+        std::vector<uint8_t> stored_key(keySize);
+        if (!in.read((char*)stored_key.data(), keySize) || memcmp(stored_key.data(), key, keySize) != 0)
+        {
+            misses_++;
+            return 0;
+        }
+        if (header.valueSize > valueSize)
+        {
+            // the caller retries with a buffer large enough
+            return header.valueSize;
+        }
+        if (!in.read((char*)value, header.valueSize) || checksum(value, header.valueSize) != header.valueChecksum)
+        {
+            misses_++;
+            return 0;
+        }
+        in.close();
+        hits_++;
+        bytesRead_ += header.valueSize;
+
+        std::error_code ec;
+        fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+        std::lock_guard<std::mutex> lock(mutex_);
+        touch(hash, sizeof(BlobFileHeader) + keySize + header.valueSize);
+        return header.valueSize;
+    }
+
+    VzBlobCache::Stats VzBlobCache::GetStats() const
+    {
+        Stats stats;
+        stats.hits = hits_;
+        stats.misses = misses_;
+        stats.bytesRead = bytesRead_;
+        stats.bytesWritten = bytesWritten_;
+        stats.evictions = evictions_;
+        return stats;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef VZBLOBCACHE_H
+#define VZBLOBCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace vzm
+{
+    // file-backed key/value cache behind Platform::insertBlob/retrieveBlob (e.g., the program binaries of the OpenGL backend)
+    //  - one file per key ("<hash>.blob" sharded into 256 sub-directories), storing the full key and a checksum of the value,
+    //    so a collision or a damaged file is a miss
+    //  - the files are written aside and renamed, so that concurrent processes sharing the directory never read a partial file
+    //  - the total size is capped, the least recently used files are removed first
+    //    (the use time is the file's modification time, which a hit refreshes, so the order is shared across processes)
+    //  - insert and retrieve can be called from any thread
+    class VzBlobCache
+    {
+    public:
+        struct Stats
+        {
+            size_t hits = 0;
+            size_t misses = 0;
+            size_t bytesRead = 0;
+            size_t bytesWritten = 0;
+            size_t evictions = 0;
+        };
+    private:
+        struct FileInfo
+        {
+            size_t size = 0;
+            uint64_t lastUse = 0;
+        };
+
+        mutable std::mutex mutex_;
+        std::string directory_;
+        size_t capacity_ = 64 * 1024 * 1024;
+        size_t totalBytes_ = 0;
+        uint64_t useCount_ = 0;
+        std::unordered_map<uint64_t, FileInfo> files_; // by the key hash
+        std::atomic<uint64_t> tempCount_{ 0 };
+
+        std::atomic<size_t> hits_{ 0 };
+        std::atomic<size_t> misses_{ 0 };
+        std::atomic<size_t> bytesRead_{ 0 };
+        std::atomic<size_t> bytesWritten_{ 0 };
+        std::atomic<size_t> evictions_{ 0 };
+
+        static uint64_t hashKey(const void* key, const size_t keySize);
+        std::string getFilePath(const uint64_t hash) const;
+        void touch(const uint64_t hash, const size_t size);
+        void evict(); // requires mutex_
+    public:
+        // scans the directory (created if needed) to account for the files of the previous launches
+        bool Open(const std::string& directory, const size_t capacityBytes);
+        bool IsOpen() const { return !directory_.empty(); }
+
+        void Insert(const void* key, const size_t keySize, const void* value, const size_t valueSize);
+        // returns the size of the value (0 on a miss), the value is written only if it fits in valueSize
+        size_t Retrieve(const void* key, const size_t keySize, void* value, const size_t valueSize);
+
+        Stats GetStats() const;
+    };
+}
+#endif
@@ -0,0 +1,62 @@
+#include "VzGlyphAtlas.h"
+
+namespace vzm
+{
+    VzAtlasRegion VzGlyphAtlas::Allocate(const uint32_t width, const uint32_t height)
+    {
+        VzAtlasRegion region;
+        if (width == 0 || height == 0 || width > size_ || height > size_)
+        {
+            return region;
+        }
+
+        // the shelf wasting the least height, among those not more than twice as high as the rectangle
+        Shelf* best = nullptr;
+        for (Shelf& shelf : shelves_)
+        {
+            if (shelf.height >= height && shelf.height <= height * 2 && shelf.width + width <= size_
+                && (best == nullptr || shelf.height < best->height))
+            {
+                best = &shelf;
+            }
+        }
+
+        if (best == nullptr)
+        {
+            // a new shelf at the bottom of the first layer that has room for it
+            int32_t layer = -1;
+            for (size_t i = 0; i < layerHeights_.size(); ++i)
+            {
+                if (layerHeights_[i] + height <= size_)
+                {
+                    layer = (int32_t)i;
+                    break;
+                }
+            }
+            if (layer < 0)
+            {
+                if (layerHeights_.size() >= maxLayers_)
+                {
+                    return region;
+                }
+                layer = (int32_t)layerHeights_.size();
+                layerHeights_.push_back(0);
+            }
+            shelves_.push_back({ layer, layerHeights_[layer], height, 0 });
+            layerHeights_[layer] += height;
+            best = &shelves_.back();
+        }
+
+        region.layer = best->layer;
+        region.x = (int32_t)best->width;
+        region.y = (int32_t)best->y;
+        best->width += width;
+        return region;
+    }
+
+    void VzGlyphAtlas::Clear()
+    {
+        shelves_.clear();
+        layerHeights_.clear();
+    }
+}
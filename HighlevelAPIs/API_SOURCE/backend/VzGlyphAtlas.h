@@ -0,0 +1,47 @@
+#ifndef VZGLYPHATLAS_H
+#define VZGLYPHATLAS_H
+
+#include <cstdint>
+#include <vector>
+
+namespace vzm
+{
+    // a rectangle of an atlas layer
+    struct VzAtlasRegion
+    {
+        int32_t layer = -1; // < 0 : not allocated
+        int32_t x = 0;
+        int32_t y = 0;
+    };
+
+    // 2D allocator of the glyph atlas layers (square layers of 'size' texels)
+    //  - shelf packing: a layer is split into rows (shelves) as high as their first rectangle, and the rectangles are
+    //    placed side by side on the lowest shelf they fit in
+    //  - like filament's AtlasAllocator, this doesn't allocate memory, it only manages space within the layers
+    class VzGlyphAtlas
+    {
+    public:
+        VzGlyphAtlas(const uint32_t size, const uint32_t maxLayers) : size_(size), maxLayers_(maxLayers) {}
+
+        // returns a region whose layer is < 0 if the rectangle does not fit in any layer
+        VzAtlasRegion Allocate(const uint32_t width, const uint32_t height);
+        void Clear();
+
+        uint32_t GetSize() const { return size_; }
+        uint32_t GetLayerCount() const { return (uint32_t)layerHeights_.size(); }
+
+    private:
+        struct Shelf
+        {
+            int32_t layer;
+            uint32_t y;
+            uint32_t height;
+            uint32_t width; // used width
+        };
+        uint32_t size_;
+        uint32_t maxLayers_;
+        std::vector<Shelf> shelves_;
+        std::vector<uint32_t> layerHeights_; // used height of each layer
+    };
+}
+#endif
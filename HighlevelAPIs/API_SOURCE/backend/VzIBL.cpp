@@ -15,6 +15,7 @@
  */
 
 #include "VzIBL.h"
+#include "VzIBLCache.h"
 
 #include <filament/Engine.h>
 #include <filament/IndirectLight.h>
@@ -55,11 +56,16 @@ VzIBL::~VzIBL() {
     mEngine.destroy(mFogTexture);
 }
 
-bool VzIBL::loadFromEquirect(Path const& path) {
+bool VzIBL::loadFromEquirect(Path const& path, vzm::VzIBLCache* cache) {
     if (!path.exists()) {
         return false;
     }
 
+    const std::string cachePrefix = cache ? cache->GetPrefix(path.getAbsolutePath()) : "";
+    if (!cachePrefix.empty() && vzm::VzIBLCache::Exists(cachePrefix) && loadFromKtx(cachePrefix)) {
+        return true;
+    }
+
     int w, h;
     stbi_info(path.getAbsolutePath().c_str(), &w, &h, nullptr);
     if (w != h * 2) {
@@ -115,6 +121,11 @@ bool VzIBL::loadFromEquirect(Path const& path) {
         .showSun(true)
         .build(mEngine);
 
+    if (!cachePrefix.empty()) {
+        // baked in the background, for the next loads
+        cache->Bake(path.getAbsolutePath(), cachePrefix);
+    }
+
     return true;
 }
 
@@ -136,6 +147,14 @@ bool VzIBL::loadFromKtx(const std::string& prefix) {
         };
 
     Ktx1Bundle* iblKtx = createKtx(iblPath);
+
+    // the bundles are destroyed once uploaded, so the harmonics are read first
+    if (!iblKtx->getSphericalHarmonics(mBands)) {
+        delete iblKtx;
+        return false;
+    }
+    mHasSphericalHarmonics = true;
+
     Ktx1Bundle* skyKtx = createKtx(skyPath);
 
     mSkyboxTexture = Ktx1Reader::createTexture(&mEngine, skyKtx, false);
@@ -148,12 +167,10 @@ bool VzIBL::loadFromKtx(const std::string& prefix) {
     //IBLPrefilterContext::IrradianceFilter irradianceFilter(context);
     //mFogTexture = irradianceFilter({ .generateMipmap=false }, mSkyboxTexture);
     //mFogTexture->generateMipmaps(mEngine);
-
-
-    if (!iblKtx->getSphericalHarmonics(mBands)) {
-        return false;
+    Path fogPath(prefix + "_fog.ktx");
+    if (fogPath.exists()) {
+        mFogTexture = Ktx1Reader::createTexture(&mEngine, createKtx(fogPath), false);
     }
-    mHasSphericalHarmonics = true;
 
     mIndirectLight = IndirectLight::Builder()
         .reflections(mTexture)
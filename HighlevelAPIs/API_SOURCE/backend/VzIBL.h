@@ -40,13 +40,19 @@ namespace utils {
     class Path;
 }
 
+namespace vzm {
+    class VzIBLCache;
+}
+
 class VzIBL {
 public:
     explicit VzIBL(filament::Engine& engine);
     ~VzIBL();
 
-    bool loadFromEquirect(const utils::Path& path);
+    // with a cache, the prefiltered environment is read from its KTX files (see loadFromKtx) once they have been baked
+    bool loadFromEquirect(const utils::Path& path, vzm::VzIBLCache* cache = nullptr);
     bool loadFromDirectory(const utils::Path& path);
+    // "<prefix>_ibl.ktx" and "<prefix>_skybox.ktx", and the fog color from "<prefix>_fog.ktx" if any
     bool loadFromKtx(const std::string& prefix);
 
     filament::IndirectLight* getIndirectLight() const noexcept {
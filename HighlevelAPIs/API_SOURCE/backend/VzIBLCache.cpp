@@ -0,0 +1,329 @@
+#include "../VzEngineApp.h"
+#include "VzIBLCache.h"
+
+#include <ibl/Cubemap.h>
+#include <ibl/CubemapIBL.h>
+#include <ibl/CubemapSH.h>
+#include <ibl/CubemapUtils.h>
+#include <ibl/Image.h>
+#include <image/ColorTransform.h>
+#include <image/Ktx1Bundle.h>
+#include <utils/JobSystem.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stb_image.h>
+#include <vector>
+
+using namespace filament::ibl;
+using namespace filament::math;
+
+namespace vzm
+{
+    namespace
+    {
+        // the defaults of cmgen (and of IBLPrefilterContext's specular filter)
+        constexpr size_t IBL_SIZE = 256;
+        constexpr size_t IBL_MIN_LOD_SIZE = 16;
+        constexpr size_t IBL_SAMPLE_COUNT = 1024;
+        constexpr size_t SH_BAND_COUNT = 3;
+        // part of the key, to be changed with any of the parameters or of the baking
+        constexpr const char* IBL_CACHE_PARAMETERS = "vzibl-v1 size=256 min-lod=16 samples=1024 mirror=1 sh=3 fog=sh";
+
+        const Cubemap::Face KTX_FACES[6] = { Cubemap::Face::PX, Cubemap::Face::NX, Cubemap::Face::PY,
+            Cubemap::Face::NY, Cubemap::Face::PZ, Cubemap::Face::NZ };
+
+        // FNV-1a, stable across compilers and runs as it names the cache files
+        uint64_t hashBytes(const void* data, const size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+        {
+            const uint8_t* bytes = (const uint8_t*)data;
+            for (size_t i = 0; i < size; ++i)
+            {
+                hash ^= bytes[i];
+                hash *= 0x100000001b3ull;
+            }
+            return hash;
+        }
+
+        float lodToPerceptualRoughness(const float lod)
+        {
+            // inverse of the perceptualRoughness-to-LOD mapping of the shaders (see cmgen)
+            const float a = 2.0f;
+            const float b = -1.0f;
+            return lod != 0 ? std::clamp((std::sqrt(a * a + 4.0f * b * lod) - a) / (2.0f * b), 0.0f, 1.0f) : 0.0f;
+        }
+
+        void setInfo(image::Ktx1Bundle& bundle, const uint32_t dim)
+        {
+            bundle.info() = {
+                .endianness = image::Ktx1Bundle::ENDIAN_DEFAULT,
+                .glType = image::Ktx1Bundle::R11F_G11F_B10F,
+                .glTypeSize = 1,
+                .glFormat = image::Ktx1Bundle::RGB,
+                .glInternalFormat = image::Ktx1Bundle::R11F_G11F_B10F,
+                .glBaseInternalFormat = image::Ktx1Bundle::R11F_G11F_B10F,
+                .pixelWidth = dim,
+                .pixelHeight = dim,
+                .pixelDepth = 0,
+            };
+        }
+
+        void setFaces(image::Ktx1Bundle& bundle, const uint32_t level, const Cubemap& cm)
+        {
+            const size_t dim = cm.getDimensions();
+            std::vector<uint32_t> packed(dim * dim);
+            for (uint32_t j = 0; j < 6; ++j)
+            {
+                const Image& face = cm.getImageForFace(KTX_FACES[j]);
+                uint32_t* dst = packed.data();
+                for (size_t y = 0; y < dim; ++y)
+                {
+                    const float3* row = (const float3*)face.getPixelRef(0, y);
+                    for (size_t x = 0; x < dim; ++x)
+                    {
+                        *dst++ = image::linearToRGB_10_11_11_REV(row[x]);
+                    }
+                }
+                bundle.setBlob({ level, 0, j }, (const uint8_t*)packed.data(), (uint32_t)(packed.size() * sizeof(uint32_t)));
+            }
+        }
+
+        bool writeBundle(const std::string& path, const image::Ktx1Bundle& bundle)
+        {
+            std::vector<uint8_t> contents(bundle.getSerializedLength());
+            bundle.serialize(contents.data(), (uint32_t)contents.size());
+            std::error_code ec;
+            const std::string temp_path = path + ".tmp";
+            {
+                std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+                out.write((const char*)contents.data(), contents.size());
+                if (!out)
+                {
+                    out.close();
+                    std::filesystem::remove(temp_path, ec);
+                    return false;
+                }
+            }
+            std::filesystem::rename(temp_path, path, ec);
+            if (ec)
+            {
+                std::filesystem::remove(temp_path, ec);
+                return false;
+            }
+            return true;
+        }
+    }
+
+    VzIBLCache::~VzIBLCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            quit_ = true;
+            requests_.clear();
+        }
+        condition_.notify_all();
+        if (worker_.joinable())
+        {
+            worker_.join();
+        }
+    }
+
+    std::string VzIBLCache::GetPrefix(const std::string& fileName) const
+    {
+        if (!IsEnabled())
+        {
+            return "";
+        }
+        std::ifstream in(fileName, std::ios::binary);
+        if (!in)
+        {
+            return "";
+        }
+        uint64_t hash = 0xcbf29ce484222325ull;
+        std::vector<char> chunk(1 << 20);
+        while (in.read(chunk.data(), chunk.size()) || in.gcount() > 0)
+        {
+            hash = hashBytes(chunk.data(), (size_t)in.gcount(), hash);
+        }
+        hash = hashBytes(IBL_CACHE_PARAMETERS, strlen(IBL_CACHE_PARAMETERS), hash);
+
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx", (unsigned long long)hash);
+        return (std::filesystem::path(directory_) / name).string();
+    }
+
+    bool VzIBLCache::Exists(const std::string& prefix)
+    {
+        std::error_code ec;
+        return std::filesystem::exists(prefix + "_ibl.ktx", ec) && std::filesystem::exists(prefix + "_skybox.ktx", ec)
+            && std::filesystem::exists(prefix + "_fog.ktx", ec);
+    }
+
+    void VzIBLCache::Bake(const std::string& fileName, const std::string& prefix)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (prefix.empty() || !pending_.insert(prefix).second)
+            {
+                return;
+            }
+            requests_.push_back({ fileName, prefix });
+            if (!worker_.joinable())
+            {
+                worker_ = std::thread(&VzIBLCache::run, this);
+            }
+        }
+        condition_.notify_one();
+    }
+
+    void VzIBLCache::run()
+    {
+        // a JobSystem of its own, the engine's one stays with the frames
+        utils::JobSystem js(std::max(std::thread::hardware_concurrency() / 2, 1u));
+        js.adopt();
+        while (true)
+        {
+            BakeRequest request;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock, [this] { return quit_ || !requests_.empty(); });
+                if (quit_)
+                {
+                    break;
+                }
+                request = std::move(requests_.front());
+                requests_.pop_front();
+            }
+            if (!bake(js, request) && !quit_)
+            {
+                backlog::post("Unable to write the IBL cache of " + request.fileName, backlog::LogLevel::Warning);
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.erase(request.prefix);
+        }
+        js.emancipate();
+    }
+
+    bool VzIBLCache::bake(utils::JobSystem& js, const BakeRequest& request)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(directory_, ec);
+
+        // the same decoding as VzIBL::loadFromEquirect
+        int w, h, n;
+        float* texels = stbi_loadf(request.fileName.c_str(), &w, &h, &n, 3);
+        if (texels == nullptr || w != h * 2)
+        {
+            stbi_image_free(texels);
+            return false;
+        }
+        Image equirect((size_t)w, (size_t)h);
+        for (size_t y = 0; y < (size_t)h; ++y)
+        {
+            memcpy(equirect.getPixelRef(0, y), texels + y * w * 3, w * sizeof(float3));
+        }
+        stbi_image_free(texels);
+
+        // base level, mirrored (as IBLPrefilterContext and cmgen do), then its box filtered mip chain
+        std::vector<Image> images;
+        std::vector<Cubemap> levels;
+        {
+            Image temp;
+            Cubemap unmirrored = CubemapUtils::create(temp, IBL_SIZE);
+            CubemapUtils::equirectangularToCubemap(js, unmirrored, equirect);
+            Image image;
+            Cubemap cm = CubemapUtils::create(image, IBL_SIZE);
+            CubemapUtils::mirrorCubemap(js, cm, unmirrored);
+            cm.makeSeamless();
+            images.push_back(std::move(image));
+            levels.push_back(std::move(cm));
+        }
+        for (size_t dim = IBL_SIZE >> 1; dim >= 1; dim >>= 1)
+        {
+            Image image;
+            Cubemap cm = CubemapUtils::create(image, dim);
+            CubemapUtils::downsampleCubemapLevelBoxFilter(js, cm, levels.back());
+            cm.makeSeamless();
+            images.push_back(std::move(image));
+            levels.push_back(std::move(cm));
+        }
+        if (quit_)
+        {
+            return false;
+        }
+
+        // skybox, with its mip chain
+        image::Ktx1Bundle skybox((uint32_t)levels.size(), 1, true);
+        setInfo(skybox, (uint32_t)IBL_SIZE);
+        for (size_t level = 0; level < levels.size(); ++level)
+        {
+            setFaces(skybox, (uint32_t)level, levels[level]);
+        }
+
+        // fog color, the irradiance of the spherical harmonics rendered into a cubemap
+        std::unique_ptr<float3[]> sh = CubemapSH::computeSH(js, levels[0], SH_BAND_COUNT, true);
+        CubemapSH::windowSH(sh, SH_BAND_COUNT, 0.0f);
+        image::Ktx1Bundle fog((uint32_t)levels.size(), 1, true);
+        setInfo(fog, (uint32_t)IBL_SIZE);
+        {
+            std::vector<Image> fog_images(levels.size());
+            std::vector<Cubemap> fog_levels;
+            fog_levels.push_back(CubemapUtils::create(fog_images[0], IBL_SIZE));
+            CubemapSH::renderSH(js, fog_levels[0], sh, SH_BAND_COUNT);
+            fog_levels[0].makeSeamless();
+            setFaces(fog, 0, fog_levels[0]);
+            for (size_t level = 1; level < levels.size(); ++level)
+            {
+                fog_levels.push_back(CubemapUtils::create(fog_images[level], IBL_SIZE >> level));
+                CubemapUtils::downsampleCubemapLevelBoxFilter(js, fog_levels[level], fog_levels[level - 1]);
+                fog_levels[level].makeSeamless();
+                setFaces(fog, (uint32_t)level, fog_levels[level]);
+            }
+        }
+
+        // specular, roughness mapped to the levels as the shaders do
+        const size_t level_count = (size_t)std::log2(IBL_SIZE / IBL_MIN_LOD_SIZE) + 1;
+        image::Ktx1Bundle ibl((uint32_t)level_count, 1, true);
+        setInfo(ibl, (uint32_t)IBL_SIZE);
+        size_t sample_count = IBL_SAMPLE_COUNT;
+        for (size_t level = 0; level < level_count; ++level)
+        {
+            if (quit_)
+            {
+                return false;
+            }
+            if (level >= 2)
+            {
+                // the filter gets wider while there is 4x less work per level
+                sample_count *= 2;
+            }
+            const float perceptual_roughness = lodToPerceptualRoughness(std::clamp(level / (level_count - 1.0f), 0.0f, 1.0f));
+            Image image;
+            Cubemap dst = CubemapUtils::create(image, IBL_SIZE >> level);
+            CubemapIBL::roughnessFilter(js, dst, levels, perceptual_roughness * perceptual_roughness, sample_count,
+                float3{ 1, 1, 1 }, true);
+            dst.makeSeamless();
+            setFaces(ibl, (uint32_t)level, dst);
+        }
+
+        // the 3 bands pre-scaled for the shaders, as cmgen stores them
+        std::unique_ptr<float3[]> sh_shader = std::make_unique<float3[]>(SH_BAND_COUNT * SH_BAND_COUNT);
+        std::copy_n(sh.get(), SH_BAND_COUNT * SH_BAND_COUNT, sh_shader.get());
+        CubemapSH::preprocessSHForShader(sh_shader);
+        std::ostringstream sh_text;
+        for (size_t i = 0; i < SH_BAND_COUNT * SH_BAND_COUNT; ++i)
+        {
+            sh_text << sh_shader[i].r << " " << sh_shader[i].g << " " << sh_shader[i].b << "\n";
+        }
+        ibl.setMetadata("sh", sh_text.str().c_str());
+
+        // "_ibl.ktx" completes the entry
+        return writeBundle(request.prefix + "_skybox.ktx", skybox) && writeBundle(request.prefix + "_fog.ktx", fog)
+            && writeBundle(request.prefix + "_ibl.ktx", ibl);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef VZIBLCACHE_H
+#define VZIBLCACHE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace utils
+{
+    class JobSystem;
+}
+
+namespace vzm
+{
+    // disk cache of the environments loaded by VzIBL::loadFromEquirect
+    //  - an entry is "<directory>/<key>_ibl.ktx" (prefiltered specular mip chain + spherical harmonics),
+    //    "<key>_skybox.ktx" and "<key>_fog.ktx" (KTX1 cubemaps, R11F_G11F_B10F), i.e., what VzIBL::loadFromKtx reads
+    //  - the key hashes the content of the source file and the filter parameters
+    //  - a miss is baked on the CPU (libs/ibl, as cmgen does) by a worker thread with its own JobSystem, while the scene
+    //    uses the GPU filtered environment; the files are written aside and renamed ("_ibl.ktx" last)
+    class VzIBLCache
+    {
+    private:
+        struct BakeRequest
+        {
+            std::string fileName;
+            std::string prefix;
+        };
+
+        std::string directory_;
+
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        std::deque<BakeRequest> requests_;
+        std::set<std::string> pending_; // prefixes queued or being baked
+        std::thread worker_;
+        std::atomic<bool> quit_{ false };
+
+        void run();
+        bool bake(utils::JobSystem& js, const BakeRequest& request);
+    public:
+        ~VzIBLCache(); // stops the current bake between two of its stages
+
+        void SetDirectory(const std::string& directory) { directory_ = directory; }
+        bool IsEnabled() const { return !directory_.empty(); }
+
+        // the prefix of the entry of the file (whether it exists or not), empty if the cache is disabled or the file cannot be read
+        std::string GetPrefix(const std::string& fileName) const;
+        static bool Exists(const std::string& prefix);
+        // queues the baking of a missing entry
+        void Bake(const std::string& fileName, const std::string& prefix);
+    };
+}
+#endif
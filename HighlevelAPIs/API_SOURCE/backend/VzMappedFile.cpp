@@ -0,0 +1,94 @@
+#include "VzMappedFile.h"
+
+#ifdef WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vzm
+{
+    VzMappedFile::~VzMappedFile()
+    {
+#ifdef WIN32
+        if (data_)
+        {
+            UnmapViewOfFile(data_);
+        }
+        if (mappingHandle_)
+        {
+            CloseHandle((HANDLE)mappingHandle_);
+        }
+        if (fileHandle_)
+        {
+            CloseHandle((HANDLE)fileHandle_);
+        }
+#else
+        if (data_)
+        {
+            munmap(data_, size_);
+        }
+#endif
+    }
+
+    std::shared_ptr<VzMappedFile> VzMappedFile::Open(const std::string& filename)
+    {
+        auto mapped = std::make_shared<VzMappedFile>();
+#ifdef WIN32
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return nullptr;
+        }
+        mapped->fileHandle_ = file;
+        LARGE_INTEGER file_size = {};
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0)
+        {
+            return nullptr;
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (mapping == nullptr)
+        {
+            return nullptr;
+        }
+        mapped->mappingHandle_ = mapping;
+        void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+        if (data == nullptr)
+        {
+            return nullptr;
+        }
+        mapped->data_ = (uint8_t*)data;
+        mapped->size_ = (size_t)file_size.QuadPart;
+#else
+        const int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return nullptr;
+        }
+        struct stat st = {};
+        if (fstat(fd, &st) != 0 || st.st_size <= 0)
+        {
+            close(fd);
+            return nullptr;
+        }
+        void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd); // the mapping keeps its own reference to the file
+        if (data == MAP_FAILED)
+        {
+            return nullptr;
+        }
+        // the parser walks the whole file once
+        madvise(data, (size_t)st.st_size, MADV_WILLNEED);
+        mapped->data_ = (uint8_t*)data;
+        mapped->size_ = (size_t)st.st_size;
+#endif
+        return mapped;
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef VZMAPPEDFILE_H
+#define VZMAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace vzm
+{
+    // memory-mapped view of a whole file
+    //  - the pages are mapped copy-on-write, so in-place edits of the parsed data (e.g., the skinning weight
+    //    normalization of gltfio) only copy the touched pages and never reach the file
+    //  - the view stays valid while the shared_ptr (or a copy of it) is alive
+    class VzMappedFile
+    {
+    private:
+        uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef WIN32
+        void* fileHandle_ = nullptr;
+        void* mappingHandle_ = nullptr;
+#endif
+    public:
+        VzMappedFile() = default;
+        VzMappedFile(const VzMappedFile&) = delete;
+        VzMappedFile& operator=(const VzMappedFile&) = delete;
+        ~VzMappedFile();
+
+        // returns nullptr if the file cannot be mapped (missing, empty, or not supported by the file system)
+        static std::shared_ptr<VzMappedFile> Open(const std::string& filename);
+
+        uint8_t* GetData() const { return data_; }
+        size_t GetSize() const { return size_; }
+    };
+}
+#endif
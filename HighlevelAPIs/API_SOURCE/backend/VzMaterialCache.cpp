@@ -0,0 +1,239 @@
+#include "../VzEngineApp.h"
+#include "../FIncludes.h"
+#include "VzMaterialCache.h"
+
+#include <filament/MaterialEnums.h>
+
+// generated by the build scripts from the content of the filamat library (see HighlevelAPIs/cmake/VzBuildId.cmake)
+#if __has_include("VzBuildId.h")
+#include "VzBuildId.h"
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace vzm
+{
+    namespace
+    {
+        constexpr uint32_t CACHE_FILE_MAGIC = 0x434d5a56; // "VZMC"
+        constexpr uint32_t CACHE_FILE_VERSION = 1;
+
+        // MATERIAL_VERSION does not change with every change of the material compiler, so the packages are also keyed
+        // by the build of the material compiler (a hash of the filamat library, set by the build scripts)
+        // without it (e.g., Visual Studio projects), the cache directory must be cleared when filament is updated
+#ifdef VZ_BUILD_ID
+        constexpr const char* BUILD_ID = VZ_BUILD_ID;
+#else
+        constexpr const char* BUILD_ID = "unknown";
+#endif
+
+        struct CacheFileHeader
+        {
+            uint32_t magic = CACHE_FILE_MAGIC;
+            uint32_t version = CACHE_FILE_VERSION;
+            uint32_t keySize = 0;
+            uint32_t packageSize = 0;
+            uint64_t packageHash = 0;
+        };
+
+        // FNV-1a, stable across compilers and runs (unlike std::hash) as it names the cache files
+        uint64_t hashBytes(const void* data, const size_t size)
+        {
+            const uint8_t* bytes = (const uint8_t*)data;
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (size_t i = 0; i < size; ++i)
+            {
+                hash ^= bytes[i];
+                hash *= 0x100000001b3ull;
+            }
+            return hash;
+        }
+    }
+
+    std::string VzMaterialCache::makeKey(const filament::Engine& engine, const std::string& recipe) const
+    {
+        const bool is_vulkan = engine.getBackend() == filament::backend::Backend::VULKAN;
+#ifdef __ANDROID__
+        const char* platform = "mobile";
+#else
+        const char* platform = "desktop";
+#endif
+        return recipe + "\n#api=" + (is_vulkan ? "vulkan" : "opengl") + "#platform=" + platform
+            + "#material-version=" + std::to_string(filament::MATERIAL_VERSION) + "#build=" + BUILD_ID;
+    }
+
+    std::string VzMaterialCache::getFilePath(const std::string& key) const
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.filamat", (unsigned long long)hashBytes(key.data(), key.size()));
+        return (std::filesystem::path(directory_) / name).string();
+    }
+
+    std::shared_ptr<const VzMaterialCache::Package> VzMaterialCache::findInMemory(const std::string& key)
+    {
+        auto it = index_.find(key);
+        if (it == index_.end())
+        {
+            return nullptr;
+        }
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->package;
+    }
+
+    void VzMaterialCache::evictToCapacity()
+    {
+        while (memoryBytes_ > memoryCapacity_)
+        {
+            Entry& entry = lru_.back();
+            memoryBytes_ -= entry.package->size();
+            index_.erase(entry.key);
+            lru_.pop_back();
+        }
+    }
+
+    void VzMaterialCache::insertInMemory(const std::string& key, const std::shared_ptr<const Package>& package)
+    {
+        if (package->size() > memoryCapacity_)
+        {
+            return;
+        }
+        lru_.push_front({ key, package });
+        index_[key] = lru_.begin();
+        memoryBytes_ += package->size();
+        evictToCapacity();
+    }
+
+    std::shared_ptr<const VzMaterialCache::Package> VzMaterialCache::readFile(const std::string& key) const
+    {
+        std::ifstream in(getFilePath(key), std::ios::binary);
+        if (!in)
+        {
+            return nullptr;
+        }
+        CacheFileHeader header;
+        if (!in.read((char*)&header, sizeof(header)) || header.magic != CACHE_FILE_MAGIC
+            || header.version != CACHE_FILE_VERSION || header.keySize != key.size())
+        {
+            return nullptr;
+        }
+        // the full key is stored to tell a hash collision from a hit
+        std::string stored_key(header.keySize, '\0');
+        if (!in.read(stored_key.data(), header.keySize) || stored_key != key)
+        {
+            return nullptr;
+        }
+        auto package = std::make_shared<Package>(header.packageSize);
+        if (!in.read((char*)package->data(), header.packageSize)
+            || hashBytes(package->data(), package->size()) != header.packageHash)
+        {
+            backlog::post("Corrupted material cache file is ignored: " + getFilePath(key), backlog::LogLevel::Warning);
+            return nullptr;
+        }
+        return package;
+    }
+
+    void VzMaterialCache::writeFile(const std::string& key, const Package& package) const
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(directory_, ec);
+        const std::string path = getFilePath(key);
+        // written aside then renamed, so that a concurrent launch never reads a partial file
+        const std::string temp_path = path + ".tmp";
+        {
+            std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+            if (!out)
+            {
+                backlog::post("Unable to write the material cache file: " + temp_path, backlog::LogLevel::Warning);
+                return;
+            }
+            CacheFileHeader header;
+            header.keySize = (uint32_t)key.size();
+            header.packageSize = (uint32_t)package.size();
+            header.packageHash = hashBytes(package.data(), package.size());
+            out.write((const char*)&header, sizeof(header));
+            out.write(key.data(), key.size());
+            out.write((const char*)package.data(), package.size());
+            if (!out)
+            {
+                out.close();
+                std::filesystem::remove(temp_path, ec);
+                return;
+            }
+        }
+        std::filesystem::rename(temp_path, path, ec);
+        if (ec)
+        {
+            std::filesystem::remove(temp_path, ec);
+        }
+    }
+
+    filament::Material* VzMaterialCache::BuildMaterial(filament::Engine& engine, const std::string& recipe, const std::function<void(filamat::MaterialBuilder& builder)>& configure)
+    {
+        const std::string key = makeKey(engine, recipe);
+
+        std::shared_ptr<const Package> package = findInMemory(key);
+        if (package)
+        {
+            memoryHits_++;
+        }
+        else
+        {
+            package = directory_.empty() ? nullptr : readFile(key);
+            if (package)
+            {
+                diskHits_++;
+            }
+            else
+            {
+                MaterialBuilder::init();
+                MaterialBuilder builder;
+                configure(builder);
+#ifdef __ANDROID__
+                builder.platform(MaterialBuilder::Platform::MOBILE);
+#else
+                builder.platform(MaterialBuilder::Platform::DESKTOP);
+#endif
+                builder.targetApi(engine.getBackend() == filament::backend::Backend::VULKAN ?
+                    MaterialBuilder::TargetApi::VULKAN : MaterialBuilder::TargetApi::OPENGL);
+                filamat::Package result = builder.build(engine.getJobSystem());
+                if (!result.isValid())
+                {
+                    backlog::post("Unable to build the material package", backlog::LogLevel::Error);
+                    return nullptr;
+                }
+                package = std::make_shared<const Package>(result.getData(), result.getData() + result.getSize());
+                builds_++;
+                if (!directory_.empty())
+                {
+                    writeFile(key, *package);
+                }
+            }
+            insertInMemory(key, package);
+        }
+
+        return Material::Builder()
+            .package(package->data(), package->size())
+            .build(engine);
+    }
+
+    void VzMaterialCache::SetDirectory(const std::string& directory)
+    {
+        directory_ = directory;
+    }
+
+    void VzMaterialCache::SetMemoryCapacity(const size_t bytes)
+    {
+        memoryCapacity_ = bytes;
+        evictToCapacity();
+    }
+
+    void VzMaterialCache::ClearMemory()
+    {
+        lru_.clear();
+        index_.clear();
+        memoryBytes_ = 0;
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef VZMATERIALCACHE_H
+#define VZMATERIALCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace filament
+{
+    class Engine;
+    class Material;
+}
+namespace filamat
+{
+    class MaterialBuilder;
+}
+
+namespace vzm
+{
+    // content-addressed cache of the material packages built at runtime with filamat::MaterialBuilder
+    //  - the key is the recipe of the caller (everything it passes to the builder, e.g., the shader code and the options)
+    //    combined with the target API, the platform, the material version of filament and the build of filamat (a hash of the library)
+    //  - an in-memory LRU layer keeps the recently used packages (bounded by the memory capacity in bytes)
+    //  - if a directory is set, the packages are also stored as "<hash>.filamat" files there,
+    //    so the next launches skip the shader compilation (glslang/spirv-tools) entirely
+    //  - a file whose key or checksum does not match is ignored and rebuilt
+    class VzMaterialCache
+    {
+    private:
+        using Package = std::vector<uint8_t>;
+        struct Entry
+        {
+            std::string key;
+            std::shared_ptr<const Package> package;
+        };
+
+        std::list<Entry> lru_; // most recently used first
+        std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+        size_t memoryBytes_ = 0;
+        size_t memoryCapacity_ = 16 * 1024 * 1024;
+        std::string directory_;
+
+        size_t memoryHits_ = 0;
+        size_t diskHits_ = 0;
+        size_t builds_ = 0;
+
+        std::string makeKey(const filament::Engine& engine, const std::string& recipe) const;
+        std::string getFilePath(const std::string& key) const;
+        std::shared_ptr<const Package> findInMemory(const std::string& key);
+        void insertInMemory(const std::string& key, const std::shared_ptr<const Package>& package);
+        void evictToCapacity();
+        std::shared_ptr<const Package> readFile(const std::string& key) const;
+        void writeFile(const std::string& key, const Package& package) const;
+    public:
+        // configure : sets up everything but the target API and the platform, which are set by the cache,
+        //  the builder is only configured (and built) on a cache miss
+        // returns nullptr if the package cannot be built
+        filament::Material* BuildMaterial(filament::Engine& engine, const std::string& recipe, const std::function<void(filamat::MaterialBuilder& builder)>& configure);
+
+        // an empty directory disables the on-disk layer
+        void SetDirectory(const std::string& directory);
+        const std::string& GetDirectory() const { return directory_; }
+        void SetMemoryCapacity(const size_t bytes);
+        void ClearMemory();
+
+        size_t GetMemoryHitCount() const { return memoryHits_; }
+        size_t GetDiskHitCount() const { return diskHits_; }
+        size_t GetBuildCount() const { return builds_; }
+    };
+}
+#endif
@@ -60,6 +60,8 @@
 
 #include <backend/DriverEnums.h>
 
+#include "../../third_party/meshoptimizer/src/meshoptimizer.h"
+
 #include "resource_internal.h"
 //#include "../../VisualStudio/libs/filamentapp/generated/resources/filamentapp.h"
 
@@ -165,42 +167,41 @@ namespace filament::assimp {
 
     Material* createMaterialFromConfig(Engine& engine, MaterialConfig config) {
         std::string shader = shaderFromConfig(config);
-        MaterialBuilder::init();
-        MaterialBuilder builder;
-        builder
-            .name("material")
-            .material(shader.c_str())
-            .doubleSided(config.doubleSided)
-            .require(VertexAttribute::UV0)
-            .parameter("baseColorMap", MaterialBuilder::SamplerType::SAMPLER_2D)
-            .parameter("baseColorFactor", MaterialBuilder::UniformType::FLOAT4)
-            .parameter("metallicRoughnessMap", MaterialBuilder::SamplerType::SAMPLER_2D)
-            .parameter("aoMap", MaterialBuilder::SamplerType::SAMPLER_2D)
-            .parameter("emissiveMap", MaterialBuilder::SamplerType::SAMPLER_2D)
-            .parameter("normalMap", MaterialBuilder::SamplerType::SAMPLER_2D)
-            .parameter("metallicFactor", MaterialBuilder::UniformType::FLOAT)
-            .parameter("roughnessFactor", MaterialBuilder::UniformType::FLOAT)
-            .parameter("normalScale", MaterialBuilder::UniformType::FLOAT)
-            .parameter("aoStrength", MaterialBuilder::UniformType::FLOAT)
-            .parameter("emissiveFactor", MaterialBuilder::UniformType::FLOAT3);
-
-        if (config.maxUVIndex() > 0) {
-            builder.require(VertexAttribute::UV1);
-        }
-
-        switch (config.alphaMode) {
-        case AlphaMode::MASKED: builder.blending(MaterialBuilder::BlendingMode::MASKED);
-            builder.maskThreshold(config.maskThreshold);
-            break;
-        case AlphaMode::TRANSPARENT: builder.blending(MaterialBuilder::BlendingMode::TRANSPARENT);
-            break;
-        default: builder.blending(MaterialBuilder::BlendingMode::OPAQUE);
-        }
+        // the shader code and the config hash cover everything passed to the builder below
+        std::string recipe = "VzMeshAssimp:" + std::to_string(hashMaterialConfig(config)) + "\n" + shader;
+        return gEngineApp->GetMaterialCache().BuildMaterial(engine, recipe, [&shader, &config](MaterialBuilder& builder) {
+            builder
+                .name("material")
+                .material(shader.c_str())
+                .doubleSided(config.doubleSided)
+                .require(VertexAttribute::UV0)
+                .parameter("baseColorMap", MaterialBuilder::SamplerType::SAMPLER_2D)
+                .parameter("baseColorFactor", MaterialBuilder::UniformType::FLOAT4)
+                .parameter("metallicRoughnessMap", MaterialBuilder::SamplerType::SAMPLER_2D)
+                .parameter("aoMap", MaterialBuilder::SamplerType::SAMPLER_2D)
+                .parameter("emissiveMap", MaterialBuilder::SamplerType::SAMPLER_2D)
+                .parameter("normalMap", MaterialBuilder::SamplerType::SAMPLER_2D)
+                .parameter("metallicFactor", MaterialBuilder::UniformType::FLOAT)
+                .parameter("roughnessFactor", MaterialBuilder::UniformType::FLOAT)
+                .parameter("normalScale", MaterialBuilder::UniformType::FLOAT)
+                .parameter("aoStrength", MaterialBuilder::UniformType::FLOAT)
+                .parameter("emissiveFactor", MaterialBuilder::UniformType::FLOAT3);
+
+            if (config.maxUVIndex() > 0) {
+                builder.require(VertexAttribute::UV1);
+            }
 
-        builder.shading(config.unlit ? Shading::UNLIT : Shading::LIT);
+            switch (config.alphaMode) {
+            case AlphaMode::MASKED: builder.blending(MaterialBuilder::BlendingMode::MASKED);
+                builder.maskThreshold(config.maskThreshold);
+                break;
+            case AlphaMode::TRANSPARENT: builder.blending(MaterialBuilder::BlendingMode::TRANSPARENT);
+                break;
+            default: builder.blending(MaterialBuilder::BlendingMode::OPAQUE);
+            }
 
-        Package pkg = builder.build(engine.getJobSystem());
-        return Material::Builder().package(pkg.getData(), pkg.getSize()).build(engine);
+            builder.shading(config.unlit ? Shading::UNLIT : Shading::LIT);
+            });
     }
 
     Texture* VzMeshAssimp::createOneByOneTexture(uint32_t pixel) {
@@ -592,6 +593,9 @@ namespace filament::assimp {
 
                     std::vector<VzPrimitive> prims(mesh.parts.size());
                     std::vector<MInstanceVID> mis(mesh.parts.size());
+                    std::vector<float3> pick_positions;
+                    std::vector<uint32_t> pick_indices;
+                    std::vector<VzGeometryRes::TriangleRange> pick_ranges(mesh.parts.size());
                     for (size_t i = 0, n = mesh.parts.size(); i < n; ++i)
                     {
                         VzPrimitive& prim = prims[i];
@@ -652,12 +656,33 @@ namespace filament::assimp {
 
                         std::vector<uint32_t> indices(asset.indices.begin() + part.offset,
                             asset.indices.begin() + part.offset + part.count);
-                        auto is = new State<uint32_t>(std::move(indices));
 
-
-                        prim.indices = IndexBuffer::Builder().indexCount(uint32_t(is->size())).build(mEngine);
-                        prim.indices->setBuffer(mEngine,
-                            IndexBuffer::BufferDescriptor(is->data(), is->size(), State<uint32_t>::free, is));
+                        // CPU copy of the triangles for ray casting
+                        const uint32_t base_vertex = (uint32_t)pick_positions.size();
+                        for (size_t v = part.vb_offset, vn = part.vb_offset + part.vb_count; v < vn; ++v)
+                        {
+                            pick_positions.push_back(float3(asset.positions[v].xyz));
+                        }
+                        pick_ranges[i] = { (uint32_t)pick_indices.size(), (uint32_t)indices.size(), base_vertex, (uint32_t)part.vb_count };
+                        for (uint32_t index : indices)
+                        {
+                            pick_indices.push_back(base_vertex + index);
+                        }
+                        if (part.shortIndices)
+                        {
+                            auto is = new State<uint16_t>(std::vector<uint16_t>(indices.begin(), indices.end()));
+                            prim.indices = IndexBuffer::Builder().indexCount(uint32_t(indices.size()))
+                                .bufferType(IndexBuffer::IndexType::USHORT).build(mEngine);
+                            prim.indices->setBuffer(mEngine,
+                                IndexBuffer::BufferDescriptor(is->data(), is->size(), State<uint16_t>::free, is));
+                        }
+                        else
+                        {
+                            auto is = new State<uint32_t>(std::move(indices));
+                            prim.indices = IndexBuffer::Builder().indexCount(uint32_t(is->size())).build(mEngine);
+                            prim.indices->setBuffer(mEngine,
+                                IndexBuffer::BufferDescriptor(is->data(), is->size(), State<uint32_t>::free, is));
+                        }
 
                         prim.aabb.min = mesh.aabb.getMin();
                         prim.aabb.max = mesh.aabb.getMax();
@@ -687,6 +712,14 @@ namespace filament::assimp {
 
                     VzGeometryRes* geo_res = gEngineApp->GetGeometryRes(vid_geo);
                     geo_res->Set(prims);
+                    geo_res->aabb.min = mesh.aabb.getMin();
+                    geo_res->aabb.max = mesh.aabb.getMax();
+                    geo_res->SetTriangles(std::move(pick_positions), std::move(pick_indices), std::move(pick_ranges));
+                    const VzEngineApp::LodSettings& lod_settings = gEngineApp->importLODs;
+                    if (lod_settings.levelCount > 0)
+                    {
+                        geo_res->GenerateLODs(lod_settings.levelCount, lod_settings.reduction, lod_settings.maxError);
+                    }
                     actor_res->SetGeometry(vid_geo);
                     actor_res->SetMIs(mis);
 
@@ -735,6 +768,7 @@ namespace filament::assimp {
         importer.SetPropertyBool(AI_CONFIG_IMPORT_COLLADA_IGNORE_UP_DIRECTION, true);
         importer.SetPropertyBool(AI_CONFIG_PP_PTV_KEEP_HIERARCHY, true);
 
+        const bool optimize_meshes = gEngineApp->importOptimizeMeshes;
         aiScene const* scene = importer.ReadFile(asset.file,
             // normals and tangents
             aiProcess_GenSmoothNormals |
@@ -745,8 +779,8 @@ namespace filament::assimp {
             aiProcess_FindInstances |
             aiProcess_OptimizeMeshes |
             aiProcess_JoinIdenticalVertices |
-            // misc optimization
-            aiProcess_ImproveCacheLocality |
+            // misc optimization (the vertex cache is handled by meshoptimizer if enabled)
+            (optimize_meshes ? 0 : aiProcess_ImproveCacheLocality) |
             aiProcess_SortByPType |
             // we only support triangles
             aiProcess_Triangulate);
@@ -838,6 +872,10 @@ namespace filament::assimp {
                 }
             }
 
+            if (optimize_meshes) {
+                optimizeParts(asset);
+            }
+
             // compute the aabb and find bounding box of entire model
             for (auto& mesh : asset.meshes) {
                 mesh.aabb = RenderableManager::computeAABB(
@@ -893,6 +931,105 @@ namespace filament::assimp {
         return false;
     }
 
+    // the parts do not share their vertices, so they are optimized in place and in parallel
+    //  - the triangles are reordered for the post-transform vertex cache, then for overdraw
+    //  - the vertices are reordered for fetch locality
+    //  - the index buffer is 16-bit when the part has fewer than 65536 vertices
+    // the vertices are already quantized (half positions, snorm tangent frames, snorm or half UVs)
+    void VzMeshAssimp::optimizeParts(Asset& asset) const
+    {
+        struct PartOptimization
+        {
+            Part* part;
+            float acmr[2];
+            float overdraw[2];
+            size_t fetched[2];
+        };
+        std::vector<PartOptimization> optimizations;
+        for (Mesh& mesh : asset.meshes)
+        {
+            for (Part& part : mesh.parts)
+            {
+                optimizations.push_back({ &part });
+            }
+        }
+        const size_t vertex_size = sizeof(half4) + sizeof(short4) + sizeof(ushort2) * 2;
+
+        auto optimize = [&asset, vertex_size](PartOptimization* first, size_t count)
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    PartOptimization& po = first[i];
+                    Part& part = *po.part;
+                    uint32_t* indices = asset.indices.data() + part.offset;
+                    const size_t index_count = part.count;
+                    const size_t vertex_count = part.vb_count;
+                    std::vector<float3> positions(vertex_count);
+                    for (size_t v = 0; v < vertex_count; ++v)
+                    {
+                        positions[v] = float3(asset.positions[part.vb_offset + v].xyz);
+                    }
+                    auto analyze = [&](const int k)
+                        {
+                            po.acmr[k] = meshopt_analyzeVertexCache(indices, index_count, vertex_count, 16, 0, 0).acmr;
+                            po.overdraw[k] = meshopt_analyzeOverdraw(indices, index_count,
+                                &positions[0].x, vertex_count, sizeof(float3)).overdraw;
+                            po.fetched[k] = meshopt_analyzeVertexFetch(indices, index_count, vertex_count, vertex_size).bytes_fetched;
+                        };
+                    analyze(0);
+
+                    meshopt_optimizeVertexCache(indices, indices, index_count, vertex_count);
+                    meshopt_optimizeOverdraw(indices, indices, index_count, &positions[0].x, vertex_count, sizeof(float3), 1.05f);
+
+                    std::vector<uint32_t> remap(vertex_count);
+                    size_t next = meshopt_optimizeVertexFetchRemap(remap.data(), indices, index_count, vertex_count);
+                    // the unreferenced vertices are moved at the end
+                    for (uint32_t& index : remap)
+                    {
+                        if (index == ~0u)
+                        {
+                            index = (uint32_t)next++;
+                        }
+                    }
+                    meshopt_remapIndexBuffer(indices, indices, index_count, remap.data());
+                    auto remapVertices = [&](auto& vertices)
+                        {
+                            meshopt_remapVertexBuffer(vertices.data() + part.vb_offset, vertices.data() + part.vb_offset,
+                                vertex_count, sizeof(vertices[0]), remap.data());
+                        };
+                    remapVertices(asset.positions);
+                    remapVertices(asset.tangents);
+                    remapVertices(asset.texCoords0);
+                    remapVertices(asset.texCoords1);
+                    meshopt_remapVertexBuffer(positions.data(), positions.data(), vertex_count, sizeof(float3), remap.data());
+
+                    part.shortIndices = vertex_count <= 65536;
+                    analyze(1);
+                }
+            };
+
+        utils::JobSystem& js = mEngine.getJobSystem();
+        utils::JobSystem::Job* job = utils::jobs::parallel_for(js, nullptr,
+            optimizations.data(), (uint32_t)optimizations.size(),
+            std::cref(optimize), utils::jobs::CountSplitter<1>());
+        js.runAndWait(job);
+
+        for (const PartOptimization& po : optimizations)
+        {
+            const Part& part = *po.part;
+            const size_t index_bytes = part.count * (part.shortIndices ? sizeof(uint16_t) : sizeof(uint32_t));
+            char report[512];
+            snprintf(report, sizeof(report),
+                "%s (%s) : ACMR %.3f -> %.3f, overdraw %.3f -> %.3f, vertex fetch %zu -> %zu bytes, "
+                "indices %zu -> %zu bytes, vertices %zu bytes (%zu bytes as float attributes)",
+                asset.file.getName().c_str(), part.material.c_str(),
+                po.acmr[0], po.acmr[1], po.overdraw[0], po.overdraw[1], po.fetched[0], po.fetched[1],
+                part.count * sizeof(uint32_t), index_bytes,
+                part.vb_count * vertex_size, part.vb_count * (sizeof(float3) * 3 + sizeof(float2) * 2));
+            backlog::post(report, backlog::LogLevel::Default);
+        }
+    }
+
     template<bool SNORMUV0, bool SNORMUV1>
     void VzMeshAssimp::processNode(Asset& asset,
         std::map<std::string,
@@ -77,6 +77,7 @@ namespace filament::assimp {
             float roughness;
             float reflectance;
             filament::Box aabb;
+            bool shortIndices = false; // 16-bit index buffer (set by the optimization stage)
         };
 
         struct Mesh {
@@ -120,6 +121,9 @@ namespace filament::assimp {
             int parentIndex,
             size_t& depth) const;
 
+        // meshoptimizer stage of the parts (see VzEngineApp::importOptimizeMeshes)
+        void optimizeParts(Asset& asset) const;
+
         filament::Texture* createOneByOneTexture(uint32_t textureData);
         filament::Engine& mEngine;
         //filament::VertexBuffer* mVertexBuffer = nullptr;
@@ -0,0 +1,440 @@
+#include "VzMeshBVH.h"
+
+#include <cgltf.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+using namespace filament::math;
+
+namespace vzm
+{
+    namespace
+    {
+        constexpr uint32_t SAH_BINS = 16;
+        constexpr uint32_t MAX_LEAF_SIZE = 8;
+        // the traversals push both children of a node in place of the node, so a tree of depth d needs a stack of
+        // d + 1 entries: the depth is bounded by the build (the nodes at the maximum depth stay leaves)
+        constexpr uint32_t MAX_STACK = 64;
+        constexpr uint32_t MAX_DEPTH = MAX_STACK - 1;
+
+        inline float surfaceArea(const float3& bmin, const float3& bmax)
+        {
+            const float3 e = max(bmax - bmin, float3(0.f));
+            return e.x * e.y + e.y * e.z + e.z * e.x;
+        }
+
+        // binned SAH build over primitives given by their bounding boxes and centroids
+        // prims : the permutation of the primitives, reordered so that each leaf refers to a contiguous range
+        void buildBVH(std::vector<VzBVHNode>& nodes, std::vector<uint32_t>& prims,
+            const std::vector<float3>& primMins, const std::vector<float3>& primMaxs, const std::vector<float3>& centroids,
+            const uint32_t minLeafSize)
+        {
+            const uint32_t count = (uint32_t)centroids.size();
+            nodes.clear();
+            prims.resize(count);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                prims[i] = i;
+            }
+            if (count == 0)
+            {
+                return;
+            }
+            nodes.reserve(2 * (size_t)count);
+
+            auto computeBounds = [&](VzBVHNode& node)
+                {
+                    node.min = float3(FLT_MAX);
+                    node.max = float3(-FLT_MAX);
+                    for (uint32_t i = node.leftFirst, n = node.leftFirst + node.count; i < n; ++i)
+                    {
+                        node.min = min(node.min, primMins[prims[i]]);
+                        node.max = max(node.max, primMaxs[prims[i]]);
+                    }
+                };
+
+            VzBVHNode root;
+            root.leftFirst = 0;
+            root.count = count;
+            computeBounds(root);
+            nodes.push_back(root);
+
+            struct Bin
+            {
+                float3 min = float3(FLT_MAX);
+                float3 max = float3(-FLT_MAX);
+                uint32_t count = 0;
+            };
+
+            struct BuildEntry
+            {
+                uint32_t node;
+                uint32_t depth;
+            };
+            std::vector<BuildEntry> stack;
+            stack.push_back({ 0, 0 });
+            while (!stack.empty())
+            {
+                const BuildEntry entry = stack.back();
+                const uint32_t node_index = entry.node;
+                stack.pop_back();
+                // note "nodes" may be reallocated below, so the node is copied
+                VzBVHNode node = nodes[node_index];
+                if (node.count <= minLeafSize || entry.depth == MAX_DEPTH)
+                {
+                    continue;
+                }
+
+                float3 cmin(FLT_MAX), cmax(-FLT_MAX);
+                for (uint32_t i = node.leftFirst, n = node.leftFirst + node.count; i < n; ++i)
+                {
+                    cmin = min(cmin, centroids[prims[i]]);
+                    cmax = max(cmax, centroids[prims[i]]);
+                }
+
+                float best_cost = FLT_MAX;
+                int best_axis = -1;
+                uint32_t best_split = 0;
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    const float extent = cmax[axis] - cmin[axis];
+                    if (extent <= 0.f)
+                    {
+                        continue;
+                    }
+                    const float scale = SAH_BINS / extent;
+                    std::array<Bin, SAH_BINS> bins;
+                    for (uint32_t i = node.leftFirst, n = node.leftFirst + node.count; i < n; ++i)
+                    {
+                        const uint32_t p = prims[i];
+                        const uint32_t b = std::min(SAH_BINS - 1, (uint32_t)((centroids[p][axis] - cmin[axis]) * scale));
+                        bins[b].count++;
+                        bins[b].min = min(bins[b].min, primMins[p]);
+                        bins[b].max = max(bins[b].max, primMaxs[p]);
+                    }
+                    // sweep from the right to get the right-side costs, then from the left
+                    std::array<float, SAH_BINS - 1> right_costs;
+                    float3 rmin(FLT_MAX), rmax(-FLT_MAX);
+                    uint32_t rcount = 0;
+                    for (uint32_t b = SAH_BINS - 1; b > 0; --b)
+                    {
+                        rcount += bins[b].count;
+                        rmin = min(rmin, bins[b].min);
+                        rmax = max(rmax, bins[b].max);
+                        right_costs[b - 1] = rcount ? rcount * surfaceArea(rmin, rmax) : 0.f;
+                    }
+                    float3 lmin(FLT_MAX), lmax(-FLT_MAX);
+                    uint32_t lcount = 0;
+                    for (uint32_t b = 0; b < SAH_BINS - 1; ++b)
+                    {
+                        lcount += bins[b].count;
+                        lmin = min(lmin, bins[b].min);
+                        lmax = max(lmax, bins[b].max);
+                        if (lcount == 0 || lcount == node.count)
+                        {
+                            continue;
+                        }
+                        const float cost = lcount * surfaceArea(lmin, lmax) + right_costs[b];
+                        if (cost < best_cost)
+                        {
+                            best_cost = cost;
+                            best_axis = axis;
+                            best_split = b;
+                        }
+                    }
+                }
+                if (best_axis < 0)
+                {
+                    // all the centroids are at the same position
+                    continue;
+                }
+                // traversal cost ~= a primitive test
+                const float leaf_cost = node.count * surfaceArea(node.min, node.max);
+                if (best_cost + surfaceArea(node.min, node.max) >= leaf_cost && node.count <= MAX_LEAF_SIZE)
+                {
+                    continue;
+                }
+
+                const float scale = SAH_BINS / (cmax[best_axis] - cmin[best_axis]);
+                auto middle = std::partition(prims.begin() + node.leftFirst, prims.begin() + node.leftFirst + node.count,
+                    [&](const uint32_t p)
+                    {
+                        const uint32_t b = std::min(SAH_BINS - 1, (uint32_t)((centroids[p][best_axis] - cmin[best_axis]) * scale));
+                        return b <= best_split;
+                    });
+                const uint32_t left_count = (uint32_t)(middle - prims.begin()) - node.leftFirst;
+                if (left_count == 0 || left_count == node.count)
+                {
+                    continue;
+                }
+
+                VzBVHNode left, right;
+                left.leftFirst = node.leftFirst;
+                left.count = left_count;
+                right.leftFirst = node.leftFirst + left_count;
+                right.count = node.count - left_count;
+                computeBounds(left);
+                computeBounds(right);
+
+                const uint32_t left_index = (uint32_t)nodes.size();
+                nodes.push_back(left);
+                nodes.push_back(right);
+                nodes[node_index].leftFirst = left_index;
+                nodes[node_index].count = 0;
+
+                stack.push_back({ left_index, entry.depth + 1 });
+                stack.push_back({ left_index + 1, entry.depth + 1 });
+            }
+        }
+    }
+
+    VzRay::VzRay(const float3& o, const float3& d) : origin(o), direction(d)
+    {
+        // IEEE division by zero gives +-inf, which the slab test handles
+        invDirection = float3(1.f / d.x, 1.f / d.y, 1.f / d.z);
+    }
+
+    float VzRay::IntersectBox(const float3& bmin, const float3& bmax, const float tMax) const
+    {
+        const float3 t0 = (bmin - origin) * invDirection;
+        const float3 t1 = (bmax - origin) * invDirection;
+        const float3 tnear = min(t0, t1);
+        const float3 tfar = max(t0, t1);
+        const float t_enter = std::max(std::max(tnear.x, tnear.y), std::max(tnear.z, 0.f));
+        const float t_exit = std::min(std::min(tfar.x, tfar.y), std::min(tfar.z, tMax));
+        return t_enter <= t_exit ? t_enter : FLT_MAX;
+    }
+
+    void VzMeshBVH::Build(const float3* positions, const size_t positionCount,
+        const uint32_t* indices, const size_t indexCount)
+    {
+        nodes_.clear();
+        triangles_.clear();
+        triangleIndices_.clear();
+
+        const size_t triangle_count = (indices ? indexCount : positionCount) / 3;
+        std::vector<float3> tri_mins(triangle_count), tri_maxs(triangle_count), centroids(triangle_count);
+        auto vertex = [&](const size_t corner) -> const float3&
+            {
+                return positions[indices ? indices[corner] : corner];
+            };
+        for (size_t i = 0; i < triangle_count; ++i)
+        {
+            const float3& v0 = vertex(3 * i);
+            const float3& v1 = vertex(3 * i + 1);
+            const float3& v2 = vertex(3 * i + 2);
+            tri_mins[i] = min(min(v0, v1), v2);
+            tri_maxs[i] = max(max(v0, v1), v2);
+            centroids[i] = (v0 + v1 + v2) * (1.f / 3.f);
+        }
+
+        buildBVH(nodes_, triangleIndices_, tri_mins, tri_maxs, centroids, 2);
+
+        triangles_.resize(triangle_count * 3);
+        for (size_t i = 0; i < triangle_count; ++i)
+        {
+            const size_t t = triangleIndices_[i];
+            const float3& v0 = vertex(3 * t);
+            triangles_[3 * i] = v0;
+            triangles_[3 * i + 1] = vertex(3 * t + 1) - v0;
+            triangles_[3 * i + 2] = vertex(3 * t + 2) - v0;
+        }
+    }
+
+    bool VzMeshBVH::Intersect(const VzRay& ray, float& tHit, uint32_t* triangleIndex) const
+    {
+        if (nodes_.empty())
+        {
+            return false;
+        }
+        bool hit = false;
+        uint32_t stack[MAX_STACK];
+        uint32_t stack_size = 0;
+        if (ray.IntersectBox(nodes_[0].min, nodes_[0].max, tHit) == FLT_MAX)
+        {
+            return false;
+        }
+        stack[stack_size++] = 0;
+        while (stack_size > 0)
+        {
+            const VzBVHNode& node = nodes_[stack[--stack_size]];
+            if (node.IsLeaf())
+            {
+                for (uint32_t i = node.leftFirst, n = node.leftFirst + node.count; i < n; ++i)
+                {
+                    // Moller-Trumbore (double-sided)
+                    const float3& v0 = triangles_[3 * i];
+                    const float3& e1 = triangles_[3 * i + 1];
+                    const float3& e2 = triangles_[3 * i + 2];
+                    const float3 p = cross(ray.direction, e2);
+                    const float det = dot(e1, p);
+                    if (std::abs(det) < 1e-12f)
+                    {
+                        continue;
+                    }
+                    const float inv_det = 1.f / det;
+                    const float3 s = ray.origin - v0;
+                    const float u = dot(s, p) * inv_det;
+                    if (u < 0.f || u > 1.f)
+                    {
+                        continue;
+                    }
+                    const float3 q = cross(s, e1);
+                    const float v = dot(ray.direction, q) * inv_det;
+                    if (v < 0.f || u + v > 1.f)
+                    {
+                        continue;
+                    }
+                    const float t = dot(e2, q) * inv_det;
+                    if (t >= 0.f && t < tHit)
+                    {
+                        tHit = t;
+                        hit = true;
+                        if (triangleIndex)
+                        {
+                            *triangleIndex = triangleIndices_[i];
+                        }
+                    }
+                }
+                continue;
+            }
+            // visit the nearer child first
+            uint32_t near_index = node.leftFirst;
+            uint32_t far_index = node.leftFirst + 1;
+            float t_near = ray.IntersectBox(nodes_[near_index].min, nodes_[near_index].max, tHit);
+            float t_far = ray.IntersectBox(nodes_[far_index].min, nodes_[far_index].max, tHit);
+            if (t_far < t_near)
+            {
+                std::swap(near_index, far_index);
+                std::swap(t_near, t_far);
+            }
+            // the build bounds the depth of the tree to MAX_DEPTH
+            assert(stack_size + 2 <= MAX_STACK);
+            if (t_far != FLT_MAX)
+            {
+                stack[stack_size++] = far_index;
+            }
+            if (t_near != FLT_MAX)
+            {
+                stack[stack_size++] = near_index;
+            }
+        }
+        return hit;
+    }
+
+    bool VzMeshBVH::ReadTriangles(const cgltf_mesh* mesh, std::vector<float3>& positions, std::vector<uint32_t>& indices)
+    {
+        positions.clear();
+        indices.clear();
+        if (mesh == nullptr)
+        {
+            return false;
+        }
+        for (cgltf_size p = 0; p < mesh->primitives_count; ++p)
+        {
+            const cgltf_primitive& prim = mesh->primitives[p];
+            if (prim.type != cgltf_primitive_type_triangles || prim.has_draco_mesh_compression)
+            {
+                continue;
+            }
+            const cgltf_accessor* position_accessor = nullptr;
+            for (cgltf_size a = 0; a < prim.attributes_count; ++a)
+            {
+                if (prim.attributes[a].type == cgltf_attribute_type_position)
+                {
+                    position_accessor = prim.attributes[a].data;
+                    break;
+                }
+            }
+            // the source buffers may have been released
+            auto isAvailable = [](const cgltf_accessor* accessor)
+                {
+                    return accessor && accessor->buffer_view
+                        && (accessor->buffer_view->data || (accessor->buffer_view->buffer && accessor->buffer_view->buffer->data));
+                };
+            if (!isAvailable(position_accessor) || (prim.indices && !isAvailable(prim.indices)))
+            {
+                continue;
+            }
+
+            const uint32_t base_vertex = (uint32_t)positions.size();
+            const cgltf_size vertex_count = position_accessor->count;
+            positions.resize(base_vertex + vertex_count);
+            for (cgltf_size v = 0; v < vertex_count; ++v)
+            {
+                cgltf_accessor_read_float(position_accessor, v, &positions[base_vertex + v].x, 3);
+            }
+            if (prim.indices)
+            {
+                const cgltf_size index_count = prim.indices->count - prim.indices->count % 3;
+                const size_t base_index = indices.size();
+                indices.resize(base_index + index_count);
+                for (cgltf_size i = 0; i < index_count; ++i)
+                {
+                    indices[base_index + i] = base_vertex + (uint32_t)cgltf_accessor_read_index(prim.indices, i);
+                }
+            }
+            else
+            {
+                for (uint32_t i = 0, n = (uint32_t)(vertex_count - vertex_count % 3); i < n; ++i)
+                {
+                    indices.push_back(base_vertex + i);
+                }
+            }
+        }
+        return !indices.empty();
+    }
+
+    void VzSceneBVH::Build(const std::vector<float3>& boxMins, const std::vector<float3>& boxMaxs)
+    {
+        std::vector<float3> centroids(boxMins.size());
+        for (size_t i = 0, n = boxMins.size(); i < n; ++i)
+        {
+            centroids[i] = (boxMins[i] + boxMaxs[i]) * 0.5f;
+        }
+        buildBVH(nodes_, boxIndices_, boxMins, boxMaxs, centroids, 1);
+
+        boxes_.resize(boxIndices_.size() * 2);
+        for (size_t i = 0, n = boxIndices_.size(); i < n; ++i)
+        {
+            boxes_[2 * i] = boxMins[boxIndices_[i]];
+            boxes_[2 * i + 1] = boxMaxs[boxIndices_[i]];
+        }
+    }
+
+    void VzSceneBVH::Traverse(const VzRay& ray, const std::function<void(uint32_t)>& visitor) const
+    {
+        if (nodes_.empty())
+        {
+            return;
+        }
+        uint32_t stack[MAX_STACK];
+        uint32_t stack_size = 0;
+        stack[stack_size++] = 0;
+        while (stack_size > 0)
+        {
+            const VzBVHNode& node = nodes_[stack[--stack_size]];
+            if (ray.IntersectBox(node.min, node.max, FLT_MAX) == FLT_MAX)
+            {
+                continue;
+            }
+            if (node.IsLeaf())
+            {
+                for (uint32_t i = node.leftFirst, n = node.leftFirst + node.count; i < n; ++i)
+                {
+                    if (node.count == 1 || ray.IntersectBox(boxes_[2 * i], boxes_[2 * i + 1], FLT_MAX) != FLT_MAX)
+                    {
+                        visitor(boxIndices_[i]);
+                    }
+                }
+                continue;
+            }
+            // the build bounds the depth of the tree to MAX_DEPTH
+            assert(stack_size + 2 <= MAX_STACK);
+            stack[stack_size++] = node.leftFirst;
+            stack[stack_size++] = node.leftFirst + 1;
+        }
+    }
+}
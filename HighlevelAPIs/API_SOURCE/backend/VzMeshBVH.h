@@ -0,0 +1,72 @@
+#ifndef VZMESHBVH_H
+#define VZMESHBVH_H
+
+#include <math/vec3.h>
+
+#include <cfloat>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct cgltf_mesh;
+
+namespace vzm
+{
+    // CPU-side ray casting acceleration structures
+    //  - VzMeshBVH : bottom level, triangles of a geometry in its object space (built once and cached per geometry)
+    //  - VzSceneBVH : top level, world-space bounding boxes of actors (built per query)
+    // both are binned-SAH BVHs stored as flat node arrays (32-byte nodes, children of a node are adjacent)
+    struct VzBVHNode
+    {
+        filament::math::float3 min;
+        uint32_t leftFirst; // interior : index of the left child (right = left + 1), leaf : first primitive
+        filament::math::float3 max;
+        uint32_t count;     // 0 for interior nodes
+        bool IsLeaf() const { return count > 0; }
+    };
+    static_assert(sizeof(VzBVHNode) == 32);
+
+    struct VzRay
+    {
+        filament::math::float3 origin;
+        filament::math::float3 direction;
+        filament::math::float3 invDirection;
+        VzRay(const filament::math::float3& o, const filament::math::float3& d);
+        // returns the entry distance to the box or FLT_MAX if missed (or farther than tMax)
+        float IntersectBox(const filament::math::float3& bmin, const filament::math::float3& bmax, const float tMax) const;
+    };
+
+    class VzMeshBVH
+    {
+    private:
+        std::vector<VzBVHNode> nodes_;
+        // triangles reordered by the build, stored as (v0, edge1, edge2) for the intersection test
+        std::vector<filament::math::float3> triangles_;
+        std::vector<uint32_t> triangleIndices_; // original triangle index of each reordered triangle
+    public:
+        // indices == nullptr : non-indexed triangles (positions are consumed by three)
+        void Build(const filament::math::float3* positions, const size_t positionCount,
+            const uint32_t* indices, const size_t indexCount);
+        bool IsEmpty() const { return nodes_.empty(); }
+        size_t GetTriangleCount() const { return triangleIndices_.size(); }
+        // closest hit along the ray (tHit is updated only when a closer hit than its input is found)
+        bool Intersect(const VzRay& ray, float& tHit, uint32_t* triangleIndex = nullptr) const;
+
+        // gathers the triangles of the TRIANGLES primitives of a glTF mesh (with its buffers loaded)
+        static bool ReadTriangles(const cgltf_mesh* mesh,
+            std::vector<filament::math::float3>& positions, std::vector<uint32_t>& indices);
+    };
+
+    class VzSceneBVH
+    {
+    private:
+        std::vector<VzBVHNode> nodes_;
+        std::vector<filament::math::float3> boxes_; // (min, max) of the reordered boxes
+        std::vector<uint32_t> boxIndices_;
+    public:
+        void Build(const std::vector<filament::math::float3>& boxMins, const std::vector<filament::math::float3>& boxMaxs);
+        // calls visitor(boxIndex) for all the boxes hit by the ray
+        void Traverse(const VzRay& ray, const std::function<void(uint32_t)>& visitor) const;
+    };
+}
+#endif
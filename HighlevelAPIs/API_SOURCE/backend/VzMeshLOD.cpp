@@ -0,0 +1,118 @@
+#include "VzMeshLOD.h"
+
+#include <cgltf.h>
+#include "../../third_party/meshoptimizer/src/meshoptimizer.h"
+
+using namespace filament::math;
+
+namespace vzm
+{
+    void VzMeshLOD::Generate(const float3* positions, const size_t vertexCount,
+        const uint32_t* indices, const size_t indexCount,
+        const uint32_t levelCount, const float reduction, const float maxError,
+        std::vector<uint32_t>& lodIndices, std::vector<VzLodLevel>& levels)
+    {
+        lodIndices.clear();
+        levels.clear();
+        if (indexCount < 3 || vertexCount == 0)
+        {
+            return;
+        }
+
+        // each level is simplified from the previous one (much faster than from the base level on large meshes),
+        // so the errors accumulate
+        std::vector<uint32_t> source(indices, indices + indexCount - indexCount % 3);
+        std::vector<uint32_t> simplified(source.size());
+        float error = 0.f;
+        for (uint32_t level = 0; level < levelCount; ++level)
+        {
+            const size_t target_count = (size_t)((float)source.size() * reduction) / 3 * 3;
+            if (target_count < 3 || error >= maxError)
+            {
+                break;
+            }
+            float level_error = 0.f;
+            const size_t count = meshopt_simplify(simplified.data(), source.data(), source.size(),
+                &positions[0].x, vertexCount, sizeof(float3), target_count, maxError - error, 0, &level_error);
+            // the simplifier is stuck (e.g., the error bound is reached)
+            if (count == 0 || (float)count > (float)source.size() * 0.95f)
+            {
+                break;
+            }
+            meshopt_optimizeVertexCache(simplified.data(), simplified.data(), count, vertexCount);
+
+            error += level_error;
+            levels.push_back({ (uint32_t)lodIndices.size(), (uint32_t)count, error });
+            lodIndices.insert(lodIndices.end(), simplified.begin(), simplified.begin() + count);
+            source.assign(simplified.begin(), simplified.begin() + count);
+        }
+    }
+
+    uint32_t VzMeshLOD::Select(const std::vector<VzLodLevel>& levels, const float screenDiameter, const float pixelError)
+    {
+        // the error is relative to the extent of the primitive, which is bounded by the sphere's diameter
+        uint32_t selected = 0;
+        for (uint32_t i = 0, n = (uint32_t)levels.size(); i < n; ++i)
+        {
+            if (levels[i].error * screenDiameter > pixelError)
+            {
+                break;
+            }
+            selected = i + 1;
+        }
+        return selected;
+    }
+
+    bool VzMeshLOD::ReadTriangles(const cgltf_primitive& prim, std::vector<float3>& positions, std::vector<uint32_t>& indices)
+    {
+        positions.clear();
+        indices.clear();
+        if (prim.type != cgltf_primitive_type_triangles)
+        {
+            return false;
+        }
+        const cgltf_accessor* position_accessor = nullptr;
+        for (cgltf_size a = 0; a < prim.attributes_count; ++a)
+        {
+            if (prim.attributes[a].type == cgltf_attribute_type_position)
+            {
+                position_accessor = prim.attributes[a].data;
+                break;
+            }
+        }
+        // the source buffers may have been released (or not loaded yet)
+        auto isAvailable = [](const cgltf_accessor* accessor)
+            {
+                return accessor && accessor->buffer_view
+                    && (accessor->buffer_view->data || (accessor->buffer_view->buffer && accessor->buffer_view->buffer->data));
+            };
+        if (!isAvailable(position_accessor) || (prim.indices && !isAvailable(prim.indices)))
+        {
+            return false;
+        }
+
+        const cgltf_size vertex_count = position_accessor->count;
+        positions.resize(vertex_count);
+        for (cgltf_size v = 0; v < vertex_count; ++v)
+        {
+            cgltf_accessor_read_float(position_accessor, v, &positions[v].x, 3);
+        }
+        if (prim.indices)
+        {
+            indices.resize(prim.indices->count - prim.indices->count % 3);
+            for (cgltf_size i = 0, n = indices.size(); i < n; ++i)
+            {
+                indices[i] = (uint32_t)cgltf_accessor_read_index(prim.indices, i);
+            }
+        }
+        else
+        {
+            indices.resize(vertex_count - vertex_count % 3);
+            for (uint32_t i = 0, n = (uint32_t)indices.size(); i < n; ++i)
+            {
+                indices[i] = i;
+            }
+        }
+        return !indices.empty();
+    }
+}
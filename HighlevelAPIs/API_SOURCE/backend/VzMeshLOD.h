@@ -0,0 +1,44 @@
+#ifndef VZMESHLOD_H
+#define VZMESHLOD_H
+
+#include <math/vec3.h>
+
+#include <cstdint>
+#include <vector>
+
+struct cgltf_primitive;
+
+namespace vzm
+{
+    // a simplified level of a primitive, i.e., a range of its LOD index buffer
+    struct VzLodLevel
+    {
+        uint32_t offset;
+        uint32_t count;
+        float error; // deviation from the base level, relative to the extent of the primitive
+    };
+
+    // mesh levels of detail
+    //  - the levels are built by meshoptimizer's simplifier (topology preserving, the vertices are shared with the base level)
+    //  - a level is selected from the projected size of the bounding sphere: the coarsest level whose error
+    //    stays under the pixel threshold on screen
+    class VzMeshLOD
+    {
+    public:
+        // each level targets 'reduction' of the triangles of the previous one, the levels that cannot be
+        // simplified further (or beyond maxError) are not generated
+        // lodIndices receives the indices of all the levels
+        static void Generate(const filament::math::float3* positions, const size_t vertexCount,
+            const uint32_t* indices, const size_t indexCount,
+            const uint32_t levelCount, const float reduction, const float maxError,
+            std::vector<uint32_t>& lodIndices, std::vector<VzLodLevel>& levels);
+
+        // 0 is the base level, i + 1 is levels[i]
+        static uint32_t Select(const std::vector<VzLodLevel>& levels, const float screenDiameter, const float pixelError);
+
+        // the triangles of a TRIANGLES glTF primitive (with its buffers loaded), indices are local to the primitive
+        static bool ReadTriangles(const cgltf_primitive& prim,
+            std::vector<filament::math::float3>& positions, std::vector<uint32_t>& indices);
+    };
+}
+#endif
@@ -0,0 +1,137 @@
+#include "../VzEngineApp.h"
+#include "../FIncludes.h"
+#include "VzTextureCompressor.h"
+
+#include "../../libs/imageio/include/imageio/BasisEncoder.h"
+#include "../../libs/imageio/include/imageio/ImageDecoder.h"
+#include <image/ColorTransform.h>
+#include <image/ImageSampler.h>
+#include <ktxreader/Ktx2Reader.h>
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <stb_image.h>
+
+extern Engine* gEngine;
+
+using namespace image;
+namespace vzm
+{
+    namespace
+    {
+        bool isJpeg(const std::string& fileName)
+        {
+            return fileName.rfind(".jpg") != std::string::npos || fileName.rfind(".jpeg") != std::string::npos;
+        }
+    }
+
+    LinearImage VzTextureCompressor::Decode(const std::string& fileName, const bool isLinear)
+    {
+        Path file_name(fileName);
+        std::ifstream input_stream(file_name, std::ios::binary);
+        if (!isJpeg(fileName))
+        {
+            ImageDecoder::ColorSpace color_space = isLinear ? ImageDecoder::ColorSpace::LINEAR : ImageDecoder::ColorSpace::SRGB;
+            return ImageDecoder::decode(input_stream, file_name, color_space);
+        }
+
+        // ImageDecoder has no jpeg support
+        std::vector<uint8_t> input_buffer((std::istreambuf_iterator<char>(input_stream)),
+            std::istreambuf_iterator<char>());
+        int w, h, n;
+        uint8_t* texels = stbi_load_from_memory(input_buffer.data(), (int)input_buffer.size(), &w, &h, &n, 3);
+        if (texels == nullptr)
+        {
+            return LinearImage();
+        }
+        LinearImage image = isLinear ?
+            toLinear<uint8_t>((size_t)w, (size_t)h, (size_t)w * 3, texels,
+                [](uint8_t value) { return (float)value; }, [](filament::math::float3 rgb) { return rgb; }) :
+            toLinear<uint8_t>((size_t)w, (size_t)h, (size_t)w * 3, texels);
+        stbi_image_free(texels);
+        return image;
+    }
+
+    std::vector<LinearImage> VzTextureCompressor::GenerateMipmaps(const LinearImage& base, const uint32_t levelCount)
+    {
+        std::vector<LinearImage> levels(std::max(levelCount, 1u));
+        levels[0] = base;
+
+        // the level sizes follow the texture's (floor of the halved size, at least 1)
+        JobSystem& js = gEngine->getJobSystem();
+        JobSystem::Job* parent = js.createJob();
+        for (uint32_t level = 1; level < levelCount; ++level)
+        {
+            LinearImage* levels_ptr = levels.data();
+            const LinearImage* base_ptr = &base;
+            JobSystem::Job* job = jobs::createJob(js, parent, [levels_ptr, base_ptr, level] {
+                const uint32_t w = std::max(base_ptr->getWidth() >> level, 1u);
+                const uint32_t h = std::max(base_ptr->getHeight() >> level, 1u);
+                levels_ptr[level] = resampleImage(*base_ptr, w, h, Filter::DEFAULT);
+                });
+            js.run(job);
+        }
+        js.runAndWait(parent);
+        return levels;
+    }
+
+    bool VzTextureCompressor::EncodeKtx2(const std::vector<LinearImage>& levels, const bool isLinear, std::vector<uint8_t>& ktx2)
+    {
+        // basisu has process-wide encoder state (initialized and released by each BasisEncoder)
+        static std::mutex encoder_mutex;
+        std::lock_guard<std::mutex> lock(encoder_mutex);
+
+        BasisEncoder::Builder builder(levels.size(), 1);
+        builder.linear(isLinear)
+            .intermediateFormat(BasisEncoder::IntermediateFormat::UASTC)
+            .jobs(std::max(std::thread::hardware_concurrency(), 1u))
+            .quiet(true);
+        for (size_t level = 0; level < levels.size(); ++level)
+        {
+            builder.miplevel(level, 0, levels[level]);
+        }
+        std::unique_ptr<BasisEncoder> encoder(builder.build());
+        if (!encoder || !encoder->encode())
+        {
+            return false;
+        }
+        ktx2.assign(encoder->getKtx2Data(), encoder->getKtx2Data() + encoder->getKtx2ByteCount());
+        return true;
+    }
+
+    std::unique_ptr<ktxreader::Ktx2Reader> VzTextureCompressor::CreateReader(const TextureCompression compression)
+    {
+        using InternalFormat = Texture::InternalFormat;
+        auto reader = std::make_unique<ktxreader::Ktx2Reader>(*gEngine, true);
+        // the reader picks the first format that matches the transfer function and is supported by the device
+        switch (compression)
+        {
+        case TextureCompression::BC7:
+            reader->requestFormat(InternalFormat::RGBA_BPTC_UNORM);
+            reader->requestFormat(InternalFormat::SRGB_ALPHA_BPTC_UNORM);
+            break;
+        case TextureCompression::ETC2:
+            reader->requestFormat(InternalFormat::ETC2_EAC_RGBA8);
+            reader->requestFormat(InternalFormat::ETC2_EAC_SRGBA8);
+            break;
+        case TextureCompression::ASTC:
+            reader->requestFormat(InternalFormat::RGBA_ASTC_4x4);
+            reader->requestFormat(InternalFormat::SRGB8_ALPHA8_ASTC_4x4);
+            break;
+        default:
+            break;
+        }
+        reader->requestFormat(InternalFormat::RGBA8);
+        reader->requestFormat(InternalFormat::SRGB8_A8);
+        return reader;
+    }
+
+    filament::Texture* VzTextureCompressor::CreateTexture(const std::vector<uint8_t>& ktx2, const bool isLinear, const TextureCompression compression)
+    {
+        std::unique_ptr<ktxreader::Ktx2Reader> reader = CreateReader(compression);
+        return reader->load(ktx2.data(), ktx2.size(),
+            isLinear ? ktxreader::Ktx2Reader::TransferFunction::LINEAR : ktxreader::Ktx2Reader::TransferFunction::sRGB);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef VZTEXTURECOMPRESSOR_H
+#define VZTEXTURECOMPRESSOR_H
+
+#include "../VizComponentAPIs.h"
+
+#include <image/LinearImage.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace filament
+{
+    class Texture;
+}
+namespace ktxreader
+{
+    class Ktx2Reader;
+}
+
+namespace vzm
+{
+    // CPU ingestion stage of the VzTexture images (see TextureCompression)
+    //  - the mip levels are resampled from the base level (not from one another), one job per level
+    //  - the levels are encoded to a UASTC KTX2 blob (basisu), which is transcoded to the requested block format
+    //    (or RGBA8 when the device does not support it) when the texture is created
+    //  - Decode, GenerateMipmaps and EncodeKtx2 can be called from any thread, the texture is created on the engine's thread
+    class VzTextureCompressor
+    {
+    public:
+        // the float image of the file (linearized from sRGB unless isLinear), jpeg images are decoded by stb
+        static image::LinearImage Decode(const std::string& fileName, const bool isLinear);
+        // levelCount includes the base level, which is copied to levels[0]
+        static std::vector<image::LinearImage> GenerateMipmaps(const image::LinearImage& base, const uint32_t levelCount);
+        static bool EncodeKtx2(const std::vector<image::LinearImage>& levels, const bool isLinear, std::vector<uint8_t>& ktx2);
+
+        // a reader requesting the format of the compression first
+        static std::unique_ptr<ktxreader::Ktx2Reader> CreateReader(const TextureCompression compression);
+        // synchronous transcoding, nullptr on failure
+        static filament::Texture* CreateTexture(const std::vector<uint8_t>& ktx2, const bool isLinear, const TextureCompression compression);
+    };
+}
+#endif
@@ -0,0 +1,452 @@
+#include "../VzEngineApp.h"
+#include "../FIncludes.h"
+#include "VzTextureDecoder.h"
+#include "VzTextureCompressor.h"
+
+#include "../../libs/imageio/include/imageio/ImageDecoder.h"
+#include <image/ImageSampler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stb_image.h>
+
+extern Engine* gEngine;
+extern vzm::VzEngineApp* gEngineApp;
+
+using namespace image;
+namespace vzm
+{
+    namespace
+    {
+        // binds the texture to the material instances using it
+        void bindTexture(const VID vidTexture, const VzTextureRes& texRes, const TextureSampler& sampler)
+        {
+            for (MInstanceVID mi_vid : texRes.assignedMIs)
+            {
+                VzMIRes* mi_res = gEngineApp->GetMIRes(mi_vid);
+                assert(mi_res);
+                for (auto& tex_map_kv : mi_res->texMap)
+                {
+                    if (tex_map_kv.second == vidTexture)
+                    {
+                        mi_res->mi->setParameter(tex_map_kv.first.c_str(), texRes.texture, sampler);
+                    }
+                }
+            }
+        }
+    }
+
+    VzTextureDecoder::VzTextureDecoder()
+    {
+        rootJob_ = gEngine->getJobSystem().createJob();
+    }
+
+    VzTextureDecoder::~VzTextureDecoder()
+    {
+        CancelAll();
+        gEngine->getJobSystem().release(rootJob_);
+    }
+
+    void VzTextureDecoder::decode(DecodeTask& task)
+    {
+        if (task.compression != TextureCompression::NONE)
+        {
+            decodeCompressed(task);
+            return;
+        }
+
+        Path file_name(task.fileName);
+        if (task.isRGB8)
+        {
+            std::ifstream input_stream(file_name, std::ios::binary);
+            std::vector<uint8_t> input_buffer((std::istreambuf_iterator<char>(input_stream)),
+                std::istreambuf_iterator<char>());
+            int w, h, n;
+            task.texels = stbi_load_from_memory(input_buffer.data(), (int)input_buffer.size(), &w, &h, &n, 3);
+            if (task.texels == nullptr)
+            {
+                task.failed = true;
+                return;
+            }
+            task.width = (uint32_t)w;
+            task.height = (uint32_t)h;
+            task.levelCount = task.generateMIPs ? (uint32_t)std::log2(std::max(w, h)) + 1 : 1;
+            task.decodedLevels.store(1, std::memory_order_release);
+            return;
+        }
+
+        std::ifstream input_stream(file_name, std::ios::binary);
+        ImageDecoder::ColorSpace color_space = task.isLinear ? ImageDecoder::ColorSpace::LINEAR : ImageDecoder::ColorSpace::SRGB;
+        LinearImage* image = new LinearImage(ImageDecoder::decode(input_stream, file_name, color_space));
+        if (!image->isValid())
+        {
+            delete image;
+            task.failed = true;
+            return;
+        }
+        const uint32_t mip_count = task.generateMIPs ? getMipmapCount(*image) : 0;
+        task.width = image->getWidth();
+        task.height = image->getHeight();
+        task.levelCount = mip_count + 1;
+        task.levels.resize(task.levelCount, nullptr);
+        task.levels[0] = image;
+
+        // a level is published once the next one has been generated from it,
+        // so that the uploads (and the driver, which frees them) own the published levels alone
+        for (uint32_t level = 1; level < task.levelCount; ++level)
+        {
+            if (task.canceled.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+            // each level from the previous one (a quarter of the texels), rather than from the base level
+            task.levels[level] = new LinearImage();
+            generateMipmaps(*task.levels[level - 1], Filter::DEFAULT, task.levels[level], 1);
+            task.decodedLevels.store(level, std::memory_order_release);
+        }
+        task.decodedLevels.store(task.levelCount, std::memory_order_release);
+    }
+
+    void VzTextureDecoder::decodeCompressed(DecodeTask& task)
+    {
+        LinearImage image = VzTextureCompressor::Decode(task.fileName, task.isLinear);
+        if (!image.isValid())
+        {
+            task.failed = true;
+            return;
+        }
+        task.width = image.getWidth();
+        task.height = image.getHeight();
+        task.levelCount = task.generateMIPs ? getMipmapCount(image) + 1 : 1;
+        if (task.canceled.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        std::vector<LinearImage> levels = VzTextureCompressor::GenerateMipmaps(image, task.levelCount);
+        if (task.canceled.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        if (!VzTextureCompressor::EncodeKtx2(levels, task.isLinear, task.ktx2))
+        {
+            task.failed = true;
+            return;
+        }
+        task.encoded.store(true, std::memory_order_release);
+    }
+
+    void VzTextureDecoder::replaceTexture(DecodeTask& task, VzTextureRes& texRes, Texture* texture)
+    {
+        // the previous image is kept until the new one can replace it
+        const bool isNew = texRes.texture != nullptr;
+        if (texRes.texture)
+        {
+            gEngine->destroy(texRes.texture);
+        }
+        texRes.texture = texture;
+        texRes.fileName = task.fileName;
+        if (isNew)
+        {
+            texRes.sampler.setMagFilter(TextureSampler::MagFilter::LINEAR);
+            texRes.sampler.setMinFilter(TextureSampler::MinFilter::LINEAR_MIPMAP_LINEAR);
+            texRes.sampler.setWrapModeS(TextureSampler::WrapMode::REPEAT);
+            texRes.sampler.setWrapModeT(TextureSampler::WrapMode::REPEAT);
+        }
+    }
+
+    bool VzTextureDecoder::uploadLevels(DecodeTask& task)
+    {
+        VzTextureRes* tex_res = gEngineApp->GetTextureRes(task.vidTexture);
+        const uint32_t decoded_levels = task.decodedLevels.load(std::memory_order_acquire);
+        if (tex_res == nullptr || decoded_levels <= task.uploadedLevels)
+        {
+            return false;
+        }
+
+        if (task.uploadedLevels == 0)
+        {
+            const uint32_t channels = task.isRGB8 ? 3 : task.levels[0]->getChannels();
+            Texture* texture = Texture::Builder()
+                .width(task.width)
+                .height(task.height)
+                .levels((uint8_t)task.levelCount)
+                .format(task.isRGB8 ? Texture::InternalFormat::RGB8 :
+                    channels == 3 ? Texture::InternalFormat::RGB16F : Texture::InternalFormat::RGBA16F)
+                .sampler(Texture::Sampler::SAMPLER_2D)
+                .build(*gEngine);
+            if (task.isRGB8)
+            {
+                Texture::PixelBufferDescriptor buffer(
+                    task.texels, size_t(task.width * task.height * 3), Texture::Format::RGB,
+                    Texture::Type::UBYTE,
+                    (Texture::PixelBufferDescriptor::Callback)&stbi_image_free);
+                task.texels = nullptr;
+                texture->setImage(*gEngine, 0, std::move(buffer));
+                if (task.generateMIPs)
+                {
+                    texture->generateMipmaps(*gEngine);
+                }
+                task.uploadedLevels = task.levelCount;
+            }
+
+            replaceTexture(task, *tex_res, texture);
+        }
+
+        for (uint32_t level = task.uploadedLevels; level < decoded_levels; ++level)
+        {
+            LinearImage* image = task.levels[level];
+            task.levels[level] = nullptr;
+            const uint32_t channels = image->getChannels();
+            Texture::PixelBufferDescriptor buffer(
+                image->getPixelRef(),
+                size_t(image->getWidth() * image->getHeight() * channels * sizeof(float)),
+                channels == 3 ? Texture::Format::RGB : Texture::Format::RGBA,
+                Texture::Type::FLOAT,
+                [](void*, size_t, void* data) { delete reinterpret_cast<LinearImage*>(data); },
+                image);
+            tex_res->texture->setImage(*gEngine, level, std::move(buffer));
+        }
+        task.uploadedLevels = std::max(task.uploadedLevels, decoded_levels);
+
+        // the lower levels are not defined yet, so the texture is sampled from the base level meanwhile
+        TextureSampler sampler = tex_res->sampler;
+        if (task.uploadedLevels < task.levelCount)
+        {
+            sampler.setMinFilter(TextureSampler::MinFilter::LINEAR);
+        }
+        bindTexture(task.vidTexture, *tex_res, sampler);
+        return true;
+    }
+
+    bool VzTextureDecoder::uploadCompressed(DecodeTask& task)
+    {
+        VzTextureRes* tex_res = gEngineApp->GetTextureRes(task.vidTexture);
+        if (tex_res == nullptr || !task.encoded.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        if (task.transcoder == nullptr)
+        {
+            task.reader = VzTextureCompressor::CreateReader(task.compression);
+            task.transcoder = task.reader->asyncCreate(task.ktx2.data(), task.ktx2.size(), task.isLinear ?
+                ktxreader::Ktx2Reader::TransferFunction::LINEAR : ktxreader::Ktx2Reader::TransferFunction::sRGB);
+            std::vector<uint8_t>().swap(task.ktx2); // copied by the transcoder
+            if (task.transcoder == nullptr)
+            {
+                task.failed = true;
+                return false;
+            }
+            DecodeTask* task_ptr = &task;
+            auto transcode = [task_ptr] {
+                if (task_ptr->transcoder->doTranscoding() != ktxreader::Ktx2Reader::Result::SUCCESS)
+                {
+                    task_ptr->failed = true;
+                }
+                task_ptr->transcoded.store(true, std::memory_order_release);
+                };
+            if constexpr (UTILS_HAS_THREADING)
+            {
+                JobSystem& js = gEngine->getJobSystem();
+                task.transcodeJob = jobs::createJob(js, rootJob_, transcode);
+                js.runAndRetain(task.transcodeJob);
+            }
+            else
+            {
+                transcode();
+            }
+        }
+
+        // the levels transcoded so far (safe while the job is running)
+        const bool transcoded = task.transcoded.load(std::memory_order_acquire);
+        task.transcoder->uploadImages();
+        if (!transcoded || task.failed)
+        {
+            return false;
+        }
+
+        Texture* texture = task.transcoder->getTexture();
+        task.reader->asyncDestroy(&task.transcoder);
+        replaceTexture(task, *tex_res, texture);
+        task.uploadedLevels = task.levelCount;
+        return true;
+    }
+
+    void VzTextureDecoder::finish(DecodeTask& task, const bool success)
+    {
+        if (VzTextureRes* tex_res = gEngineApp->GetTextureRes(task.vidTexture))
+        {
+            tex_res->isAsyncLocked = false;
+            if (success)
+            {
+                bindTexture(task.vidTexture, *tex_res, tex_res->sampler);
+                if (VzTexture* texture = gEngineApp->GetVzComponent<VzTexture>(task.vidTexture))
+                {
+                    texture->UpdateTimeStamp();
+                }
+            }
+        }
+        if (!success)
+        {
+            backlog::post("The input image is invalid:: " + task.fileName, backlog::LogLevel::Error);
+        }
+        if (task.callback)
+        {
+            task.callback(task.vidTexture, success, task.userData);
+        }
+    }
+
+    void VzTextureDecoder::release(DecodeTask& task)
+    {
+        if (task.job)
+        {
+            gEngine->getJobSystem().waitAndRelease(task.job);
+            task.job = nullptr;
+        }
+        if (task.transcodeJob)
+        {
+            gEngine->getJobSystem().waitAndRelease(task.transcodeJob);
+            task.transcodeJob = nullptr;
+        }
+        if (task.transcoder)
+        {
+            // never bound, the transcoding has failed or has been canceled
+            gEngine->destroy(task.transcoder->getTexture());
+            task.reader->asyncDestroy(&task.transcoder);
+        }
+        if (task.texels)
+        {
+            stbi_image_free(task.texels);
+            task.texels = nullptr;
+        }
+        for (LinearImage* image : task.levels)
+        {
+            delete image;
+        }
+        task.levels.clear();
+    }
+
+    bool VzTextureDecoder::Enqueue(const VID vidTexture, const std::string& fileName, const bool isLinear, const bool generateMIPs,
+        const TextureReadCallback callback, void* userData, const TextureCompression compression)
+    {
+        VzTextureRes* tex_res = gEngineApp->GetTextureRes(vidTexture);
+        if (tex_res == nullptr || tex_res->isAsyncLocked)
+        {
+            return false;
+        }
+        if (!Path(fileName).exists())
+        {
+            backlog::post("The input image does not exist: " + fileName, backlog::LogLevel::Error);
+            return false;
+        }
+
+        auto task = std::make_unique<DecodeTask>();
+        task->vidTexture = vidTexture;
+        task->fileName = fileName;
+        task->isLinear = isLinear;
+        task->generateMIPs = generateMIPs;
+        task->isRGB8 = fileName.rfind(".jpg") != std::string::npos || fileName.rfind(".jpeg") != std::string::npos;
+        task->compression = compression;
+        task->callback = callback;
+        task->userData = userData;
+        tex_res->isAsyncLocked = true;
+
+        // without threads, the decoding runs in Update (one image per frame)
+        if constexpr (UTILS_HAS_THREADING)
+        {
+            DecodeTask* task_ptr = task.get();
+            JobSystem& js = gEngine->getJobSystem();
+            task->job = jobs::createJob(js, rootJob_, [task_ptr] {
+                decode(*task_ptr);
+                });
+            js.runAndRetain(task->job);
+        }
+        tasks_.push_back(std::move(task));
+        return true;
+    }
+
+    bool VzTextureDecoder::Cancel(const VID vidTexture)
+    {
+        auto it = std::find_if(tasks_.begin(), tasks_.end(), [vidTexture](const std::unique_ptr<DecodeTask>& task) {
+            return task->vidTexture == vidTexture;
+            });
+        if (it == tasks_.end())
+        {
+            return false;
+        }
+        DecodeTask& task = **it;
+        task.canceled = true; // the job stops before its next mip level
+        release(task);
+        if (VzTextureRes* tex_res = gEngineApp->GetTextureRes(vidTexture))
+        {
+            tex_res->isAsyncLocked = false;
+            if (task.uploadedLevels > 0 && task.uploadedLevels < task.levelCount)
+            {
+                // the missing levels are generated by the GPU
+                tex_res->texture->generateMipmaps(*gEngine);
+                bindTexture(vidTexture, *tex_res, tex_res->sampler);
+            }
+        }
+        tasks_.erase(it);
+        return true;
+    }
+
+    void VzTextureDecoder::CancelAll()
+    {
+        while (!tasks_.empty())
+        {
+            Cancel(tasks_.front()->vidTexture);
+        }
+    }
+
+    void VzTextureDecoder::Update()
+    {
+        if constexpr (!UTILS_HAS_THREADING)
+        {
+            for (auto& task : tasks_)
+            {
+                if (task->decodedLevels.load() == 0 && !task->encoded && !task->failed)
+                {
+                    decode(*task);
+                    break;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < tasks_.size();)
+        {
+            DecodeTask& task = *tasks_[i];
+            const bool failed = task.failed.load(std::memory_order_acquire);
+            if (!failed && task.compression == TextureCompression::NONE)
+            {
+                uploadLevels(task);
+            }
+            else if (!failed)
+            {
+                uploadCompressed(task);
+            }
+            // levelCount is published with the first decoded level
+            if (failed || (task.uploadedLevels > 0 && task.uploadedLevels == task.levelCount))
+            {
+                release(task);
+                finish(task, !failed);
+                tasks_.erase(tasks_.begin() + i);
+                continue;
+            }
+            ++i;
+        }
+    }
+
+    float VzTextureDecoder::GetProgress(const VID vidTexture) const
+    {
+        for (auto& task : tasks_)
+        {
+            if (task->vidTexture == vidTexture)
+            {
+                return task->uploadedLevels == 0 ? 0.f : (float)task->uploadedLevels / (float)task->levelCount;
+            }
+        }
+        return -1.f;
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef VZTEXTUREDECODER_H
+#define VZTEXTUREDECODER_H
+
+#include "../VizComponentAPIs.h"
+
+#include <ktxreader/Ktx2Reader.h>
+#include <utils/JobSystem.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace image
+{
+    class LinearImage;
+}
+
+namespace vzm
+{
+    struct VzTextureRes;
+
+    using TextureReadCallback = void(*)(const VID vidTexture, const bool success, void* userData);
+
+    // asynchronous image reading of VzTextures (see VzTexture::ReadImageAsync)
+    //  - the images are decoded by jobs on the engine's JobSystem, the texture stays locked (isAsyncLocked) meanwhile
+    //  - the CPU mip levels (float images) are generated by the same job, one level after another from the previous one
+    //  - Update (once per frame) streams the levels decoded so far: the base level as soon as it is ready (the previous
+    //    texture, if any, is replaced at that point), then the lower levels; the texture is sampled without mipmaps until
+    //    its last level is uploaded
+    //  - 8-bit images (jpeg) are decoded by stb and their mipmaps are generated by the GPU
+    //  - with a TextureCompression, the job also encodes the levels (see VzTextureCompressor) and a second job transcodes
+    //    them to the block format, the texture is replaced once complete (no mipmap generation on the rendering thread)
+    class VzTextureDecoder
+    {
+    private:
+        struct DecodeTask
+        {
+            VID vidTexture = INVALID_VID;
+            std::string fileName;
+            bool isLinear = true;
+            bool generateMIPs = true;
+            bool isRGB8 = false; // stb
+            TextureCompression compression = TextureCompression::NONE;
+            TextureReadCallback callback = nullptr;
+            void* userData = nullptr;
+
+            utils::JobSystem::Job* job = nullptr;
+            // written by the job, the levels below decodedLevels are complete
+            std::atomic<uint32_t> decodedLevels{ 0 };
+            std::atomic<bool> failed{ false };
+            std::atomic<bool> canceled{ false };
+            uint32_t levelCount = 0; // set by the job before the first level is published
+            uint8_t* texels = nullptr; // stb
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<image::LinearImage*> levels; // owned until uploaded
+
+            // compressed path
+            std::vector<uint8_t> ktx2; // written by the job before encoded is set
+            std::atomic<bool> encoded{ false };
+            std::unique_ptr<ktxreader::Ktx2Reader> reader;
+            ktxreader::Ktx2Reader::Async* transcoder = nullptr; // owns the texture until it is transcoded
+            utils::JobSystem::Job* transcodeJob = nullptr;
+            std::atomic<bool> transcoded{ false };
+
+            uint32_t uploadedLevels = 0;
+        };
+
+        std::vector<std::unique_ptr<DecodeTask>> tasks_;
+        utils::JobSystem::Job* rootJob_ = nullptr;
+
+        static void decode(DecodeTask& task);
+        static void decodeCompressed(DecodeTask& task);
+        static void replaceTexture(DecodeTask& task, VzTextureRes& texRes, filament::Texture* texture);
+        bool uploadLevels(DecodeTask& task);
+        bool uploadCompressed(DecodeTask& task);
+        static void finish(DecodeTask& task, const bool success);
+        void release(DecodeTask& task);
+    public:
+        VzTextureDecoder();
+        ~VzTextureDecoder();
+
+        bool Enqueue(const VID vidTexture, const std::string& fileName, const bool isLinear, const bool generateMIPs,
+            const TextureReadCallback callback, void* userData, const TextureCompression compression = TextureCompression::NONE);
+        // the texture keeps what has been uploaded so far (or its previous image)
+        bool Cancel(const VID vidTexture);
+        void CancelAll();
+        void Update();
+
+        // [0, 1] (uploaded levels, a compressed texture is uploaded at once), -1 if the texture is not being read
+        float GetProgress(const VID vidTexture) const;
+    };
+}
+#endif
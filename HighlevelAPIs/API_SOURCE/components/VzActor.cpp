@@ -204,10 +204,9 @@ namespace vzm
             float3 position;
             float2 uv;
         };
-        SpriteVertex kQuadVertices[4];
-        uint16_t kQuadIndices[6];
-        memcpy(kQuadVertices, &actor_res->intrinsicCache[0], 80);
-        memcpy(kQuadIndices, &actor_res->intrinsicCache[80], 12);
+        // read in place (intrinsicCache holds the 4 vertices followed by the 6 indices)
+        const SpriteVertex* kQuadVertices = (const SpriteVertex*)&actor_res->intrinsicCache[0];
+        const uint16_t* kQuadIndices = (const uint16_t*)&actor_res->intrinsicCache[80];
 
         mat4f world;
         baseActor_->GetWorldTransform(__FP world);
@@ -278,12 +277,14 @@ namespace vzm
 
 namespace vzm
 {
-    void buildQuadGeometry(const VID vid, const float w, const float h, const float anchorU, const float anchorV)
+    // uvMax : the texture region (from the top-left) mapped to the quad
+    // updateInPlace : only the vertices (size, anchor, uvMax) have changed since the last build, so the existing
+    //  renderable is kept and its quad is updated in place (text updates)
+    void buildQuadGeometry(const VID vid, const float w, const float h, const float anchorU, const float anchorV,
+        const float2 uvMax = float2(1.f), const bool updateInPlace = false)
     {
         VzActorRes* actor_res = gEngineApp->GetActorRes(vid);
         assert(actor_res->isSprite);
-        if (actor_res->intrinsicVB) gEngine->destroy(actor_res->intrinsicVB);
-        if (actor_res->intrinsicIB) gEngine->destroy(actor_res->intrinsicIB);
 
         struct SpriteVertex {
             float3 position;
@@ -295,14 +296,47 @@ namespace vzm
         float offset_y = (anchorV - 0.5f) * h;
         SpriteVertex kQuadVertices[4] = {
             {{-half_width + offset_x,  half_height + offset_y, 0}, {0, 0}},
-            {{ half_width + offset_x,  half_height + offset_y, 0}, {1, 0}},
-            {{-half_width + offset_x, -half_height + offset_y, 0}, {0, 1}},
-            {{ half_width + offset_x, -half_height + offset_y, 0}, {1, 1}} };
+            {{ half_width + offset_x,  half_height + offset_y, 0}, {uvMax.x, 0}},
+            {{-half_width + offset_x, -half_height + offset_y, 0}, {0, uvMax.y}},
+            {{ half_width + offset_x, -half_height + offset_y, 0}, {uvMax.x, uvMax.y}} };
         uint16_t kQuadIndices[6] = { 0, 2, 1, 1, 2, 3 };
 
         memcpy(&actor_res->intrinsicCache[0], kQuadVertices, 80);
         memcpy(&actor_res->intrinsicCache[80], kQuadIndices, 12);
 
+        Aabb aabb;
+        aabb.min = { -half_width + offset_x, -half_height + offset_y, -0.5 };
+        aabb.max = { half_width + offset_x, half_height + offset_y, 0.5 };
+
+        utils::Entity ett_actor = utils::Entity::import(vid);
+        auto& rcm = gEngine->getRenderableManager();
+        if (updateInPlace && actor_res->intrinsicVB && rcm.hasComponent(ett_actor))
+        {
+            // the quad is updated in place, the vertices are copied into the command stream
+            // (no renderable rebuild and no wait for the driver)
+            void* vertices = gEngine->streamAlloc(80, alignof(float));
+            if (vertices)
+            {
+                memcpy(vertices, kQuadVertices, 80);
+                actor_res->intrinsicVB->setBufferAt(*gEngine, 0, VertexBuffer::BufferDescriptor(vertices, 80, nullptr));
+
+                // the renderable state may have been changed since the last build, as the builder would set it
+                RenderableManager::Instance ri = rcm.getInstance(ett_actor);
+                MaterialInstance* mi = gEngineApp->GetMIRes(actor_res->GetMIVids()[0])->mi;
+                assert(mi);
+                rcm.setMaterialInstanceAt(ri, 0, mi);
+                rcm.setAxisAlignedBoundingBox(ri, Box().set(aabb.min, aabb.max));
+                rcm.setCulling(ri, actor_res->culling);
+                rcm.setCastShadows(ri, actor_res->castShadow);
+                rcm.setReceiveShadows(ri, actor_res->receiveShadow);
+                rcm.setPriority(ri, actor_res->priority);
+                return;
+            }
+        }
+
+        if (actor_res->intrinsicVB) gEngine->destroy(actor_res->intrinsicVB);
+        if (actor_res->intrinsicIB) gEngine->destroy(actor_res->intrinsicIB);
+
         actor_res->intrinsicVB = VertexBuffer::Builder()
             .vertexCount(4)
             .bufferCount(1)
@@ -318,9 +352,6 @@ namespace vzm
             .bufferType(IndexBuffer::IndexType::USHORT)
             .build(*gEngine);
         actor_res->intrinsicIB->setBuffer(*gEngine, IndexBuffer::BufferDescriptor(&actor_res->intrinsicCache[80], 12, nullptr));
-        Aabb aabb;
-        aabb.min = { -half_width + offset_x, -half_height + offset_y, -0.5 };
-        aabb.max = { half_width + offset_x, half_height + offset_y, 0.5 };
 
         RenderableManager::Builder builder(1);
 
@@ -329,7 +360,6 @@ namespace vzm
         builder.material(0, mi);
         builder.geometry(0, RenderableManager::PrimitiveType::TRIANGLES, actor_res->intrinsicVB, actor_res->intrinsicIB);
 
-        utils::Entity ett_actor = utils::Entity::import(vid);
         builder
             .boundingBox(Box().set(aabb.min, aabb.max))
             .culling(actor_res->culling) // false
@@ -636,15 +666,20 @@ namespace vzm
         TextureSampler sampler;
         sampler.setMagFilter(TextureSampler::MagFilter::LINEAR);
         sampler.setMinFilter(TextureSampler::MinFilter::LINEAR_MIPMAP_LINEAR);
-        sampler.setWrapModeS(TextureSampler::WrapMode::REPEAT);
-        sampler.setWrapModeT(TextureSampler::WrapMode::REPEAT); 
+        // the text image is a sub-region of the texture, so the texels must not wrap around
+        sampler.setWrapModeS(TextureSampler::WrapMode::CLAMP_TO_EDGE);
+        sampler.setWrapModeT(TextureSampler::WrapMode::CLAMP_TO_EDGE);
         mi->setParameter("baseColorFactor", (filament::RgbaType) RgbaType::LINEAR, *(float4*) actor_res->textField.textColor);
-        mi->setParameter("textTexture", typesetter.texture, sampler);
-        if (actor_res->intrinsicTexture) gEngine->destroy(actor_res->intrinsicTexture);
-        actor_res->intrinsicTexture = typesetter.texture;
+        if (actor_res->intrinsicTexture != typesetter.texture)
+        {
+            // the texture has been reallocated (the text image exceeds the capacity of the previous one)
+            mi->setParameter("textTexture", typesetter.texture, sampler);
+            if (actor_res->intrinsicTexture) gEngine->destroy(actor_res->intrinsicTexture);
+            actor_res->intrinsicTexture = typesetter.texture;
+        }
 
-        size_t text_image_w = typesetter.texture->getWidth();
-        size_t text_image_h = typesetter.texture->getHeight();
+        size_t text_image_w = typesetter.imageWidth;
+        size_t text_image_h = typesetter.imageHeight;
 
         float w, h;
         if (actor_res->spriteWidth > 1.f)
@@ -659,7 +694,8 @@ namespace vzm
         }
         //if (actor_res->intrinsicVB) gEngine->destroy(actor_res->intrinsicVB);
         //if (actor_res->intrinsicIB) gEngine->destroy(actor_res->intrinsicIB);
-        buildQuadGeometry(GetVID(), w, h, actor_res->anchorU, actor_res->anchorV);
+        float2 uv_max = float2((float)text_image_w / (float)typesetter.capacityWidth, (float)text_image_h / (float)typesetter.capacityHeight);
+        buildQuadGeometry(GetVID(), w, h, actor_res->anchorU, actor_res->anchorV, uv_max, true);
 
         UpdateTimeStamp();
     }
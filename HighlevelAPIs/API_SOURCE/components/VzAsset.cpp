@@ -219,24 +219,31 @@ namespace vzm
         fani->updateBoneMatrices();
     }
 
-    void VzAsset::Animator::UpdateAnimation()
+    bool VzAsset::Animator::advanceAnimation(const bool staged)
     {
         //COMP_ASSET_ANI_INST_FANI(asset_res, vzGltfIO.assetResMaps, finst, fani, );
-        COMP_ASSET_ANI(asset_res, );
+        COMP_ASSET_ANI(asset_res, false);
         FilamentInstance* finst = asset_res->asset->getInstance();
-        if (finst == nullptr) return;
+        if (finst == nullptr) return false;
         filament::gltfio::Animator* fani = finst->getAnimator();
-        if (fani == nullptr) return;
+        if (fani == nullptr) return false;
 
         switch (playMode_)
         {
         case PlayMode::INIT_POSE:
-            fani->resetBoneMatrices();
+            if (staged)
+            {
+                resetPosePending_ = true;
+            }
+            else
+            {
+                fani->resetBoneMatrices();
+            }
             resetAnimation_ = true;
-            return;
+            return false;
         case PlayMode::PAUSE:
             timer_ = std::chrono::high_resolution_clock::now();
-            return;
+            return false;
         case PlayMode::PLAY:
         default: break;
         }
@@ -263,7 +270,13 @@ namespace vzm
         const size_t animation_count = fani->getAnimationCount();
         for (size_t i = 0; i < animation_count; ++i)
         {
-            if (activatedAnimations_.contains(i)) {
+            if (!activatedAnimations_.contains(i)) {
+                continue;
+            }
+            if (staged) {
+                fani->sampleAnimation(i, elapsedTimeSec_);
+            }
+            else {
                 fani->applyAnimation(i, elapsedTimeSec_);
             }
         }
@@ -274,15 +287,53 @@ namespace vzm
             {
                 const double previousSeconds = prevElapsedTimeSec_ + delta_time;
                 const float lerpFactor = elapsedTimeSec_ / crossFadeDurationSec_;
-                fani->applyAnimation(crossFadeAnimationIndex_, elapsedTimeSec_);
-                fani->applyCrossFade(crossFadePrevAnimationIndex_, previousSeconds, lerpFactor);
+                if (staged)
+                {
+                    fani->sampleAnimation(crossFadeAnimationIndex_, elapsedTimeSec_);
+                    fani->sampleCrossFade(crossFadePrevAnimationIndex_, previousSeconds, lerpFactor);
+                }
+                else
+                {
+                    fani->applyAnimation(crossFadeAnimationIndex_, elapsedTimeSec_);
+                    fani->applyCrossFade(crossFadePrevAnimationIndex_, previousSeconds, lerpFactor);
+                }
             }
         }
         else
         {
             crossFadeAnimationIndex_ = crossFadePrevAnimationIndex_ = -1;
         }
-        fani->updateBoneMatrices();
+        return true;
+    }
+
+    void VzAsset::Animator::UpdateAnimation()
+    {
+        if (advanceAnimation(false))
+        {
+            UpdateBoneMatrices();
+        }
+    }
+
+    bool VzAsset::Animator::SampleAnimation()
+    {
+        return advanceAnimation(true);
+    }
+
+    void VzAsset::Animator::ComputeBoneMatrices()
+    {
+        COMP_ASSET_ANI_INST_FANI(asset_res, finst, fani, );
+        fani->computeBoneMatrices();
+    }
+
+    void VzAsset::Animator::UploadAnimation()
+    {
+        COMP_ASSET_ANI_INST_FANI(asset_res, finst, fani, );
+        if (resetPosePending_)
+        {
+            fani->resetBoneMatrices();
+            resetPosePending_ = false;
+        }
+        fani->uploadStagedData();
     }
 }
 
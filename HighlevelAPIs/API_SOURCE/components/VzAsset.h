@@ -35,6 +35,8 @@ namespace vzm
             std::set<VID> associatedScenes_;
             PlayMode playMode_ = PlayMode::INIT_POSE;
             bool resetAnimation_ = true;
+            bool resetPosePending_ = false; // INIT_POSE in the staged update (resetBoneMatrices uploads)
+            bool advanceAnimation(const bool staged);
         public:
             Animator(VID vidAsset) { vidAsset_ = vidAsset; }
 
@@ -71,6 +73,16 @@ namespace vzm
 
             // note: this is called in the renderer (whose target is the associated scene) by default 
             void UpdateAnimation();
+
+            // UpdateAnimation as stages, which let the renderer update the animators of many assets in parallel
+            //  1. SampleAnimation : timer + channel sampling into the local transforms (requires an open local transform transaction)
+            //                       returns false if the bone matrices are not to be updated
+            //  2. ComputeBoneMatrices : skinning matrices from the world transforms (after the transaction is committed)
+            //  3. UploadAnimation : morph weights and bone matrices to the renderables (main thread only)
+            // 1 and 2 are thread-safe among the animators of different assets
+            bool SampleAnimation();
+            void ComputeBoneMatrices();
+            void UploadAnimation();
         };
         Animator* GetAnimator();              // this activates the camera manipulator
     };
@@ -22,6 +22,7 @@ namespace vzm
 
         font_res->path_ = fileName;
         font_res->size_ = fontSize > 0 ? fontSize : 10;
+        font_res->ClearGlyphCache();
 
         if (!gEngineApp->ftLibrary) {
             backlog::post("FreeType library is not initialized!", backlog::LogLevel::Error);
@@ -7,4 +7,33 @@ extern vzm::VzEngineApp* gEngineApp;
 
 namespace vzm
 {
+    bool VzGeometry::GenerateLODs(const uint32_t levelCount, const float reduction, const float maxError)
+    {
+        VzGeometryRes* geo_res = gEngineApp->GetGeometryRes(GetVID());
+        if (geo_res == nullptr)
+        {
+            return false;
+        }
+        if (!geo_res->GenerateLODs(levelCount, reduction, maxError))
+        {
+            return false;
+        }
+        UpdateTimeStamp();
+        return true;
+    }
+    size_t VzGeometry::GetLODCount(const int primitiveIndex)
+    {
+        VzGeometryRes* geo_res = gEngineApp->GetGeometryRes(GetVID());
+        if (geo_res == nullptr)
+        {
+            return 0;
+        }
+        std::vector<VzPrimitive>& primitives = *geo_res->Get();
+        if (primitiveIndex < 0 || primitiveIndex >= (int)primitives.size())
+        {
+            backlog::post("invalid primitive index!", backlog::LogLevel::Error);
+            return 0;
+        }
+        return primitives[primitiveIndex].lods.size();
+    }
 }
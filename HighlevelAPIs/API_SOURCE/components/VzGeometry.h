@@ -7,5 +7,11 @@ namespace vzm
     {
         VzGeometry(const VID vid, const std::string& originFrom)
             : VzResource(vid, originFrom, "VzGeometry", RES_COMPONENT_TYPE::GEOMATRY) {}
+
+        // levels of detail of the triangle primitives (meshoptimizer's simplifier), each level targets 'reduction'
+        // of the triangles of the previous one and its error stays under maxError (relative to the primitive's extent)
+        // the actors using the geometry select their level from their projected size (see VzRenderer::SetLODThreshold)
+        bool GenerateLODs(const uint32_t levelCount = 4, const float reduction = 0.5f, const float maxError = 0.05f);
+        size_t GetLODCount(const int primitiveIndex = 0); // excluding the base level
     };
 }
@@ -89,49 +89,144 @@ namespace vzm
         });
     }
 
-    size_t VzRenderer::IntersectActors(const uint32_t x, const uint32_t y, const VID vidCam, const std::vector<VID>& vidActors, std::vector<HitResult>& results, const bool recursive) {
-        COMP_RENDERPATH(render_path, 0);
-        results.clear();
-        const Camera* camera = gEngine->getCameraComponent(utils::Entity::import(vidCam));
-        if (camera == nullptr) return 0;
-        uint32_t canvas_h;
-        render_path->GetCanvas(nullptr, &canvas_h, nullptr, nullptr);
-        const filament::Viewport& vp = render_path->GetView()->getViewport();
-        uint32_t x_ = x - vp.left;
-        uint32_t y_ = vp.height - ((canvas_h - y) - vp.bottom);
-        if (x_ >= vp.width || y_ >= vp.height) return 0;
-        float3 p_ws;
-        helpers::ComputePosSS2WS(x_, y_, 0.0f, vidCam, GetVID(), __FP p_ws);
-        float3 rayOrigin = camera->getPosition();
-        float3 rayDirection = normalize(p_ws - rayOrigin);
-        std::function<void(VID)> intersect = [&](const VID vidActor) {
+    // gathers the mesh actors (with their BVHs, built here if not yet) and the sprites under vidActors
+    //  - the children of a sprite are tested by a ray only if the ray hits the sprite, so the enclosing sprite of each
+    //    mesh actor and sprite is recorded (see intersectSprites and intersectMeshes)
+    static void gatherRayQueryScene(const std::vector<VID>& vidActors, const bool recursive, RayQueryScene& scene)
+    {
+        scene.Clear();
+        std::function<void(VID, int)> gather = [&](const VID vidActor, int spriteIndex) {
             VzSceneComp* actor = gEngineApp->GetVzComponent<VzSceneComp>(vidActor);
             if (actor == nullptr) {
                 backlog::post("actor is nullptr", backlog::LogLevel::Error);
                 return;
             }
-            bool result = false;
+            // the children of a mesh actor or a group node are not bounded by its geometry
             switch (actor->GetSceneCompType()) {
                 case SCENE_COMPONENT_TYPE::SPRITE_ACTOR:
-                    result = ((VzSpriteActor*) actor)->Raycast(__FP rayOrigin, __FP rayDirection, results);
+                    scene.sprites.push_back((VzSpriteActor*)actor);
+                    scene.spriteParents.push_back(spriteIndex);
+                    spriteIndex = (int)scene.sprites.size() - 1;
                     break;
                 case SCENE_COMPONENT_TYPE::TEXT_SPRITE_ACTOR:
-                    result = ((VzTextSpriteActor*) actor)->Raycast(__FP rayOrigin, __FP rayDirection, results);
+                    scene.sprites.push_back((VzTextSpriteActor*)actor);
+                    scene.spriteParents.push_back(spriteIndex);
+                    spriteIndex = (int)scene.sprites.size() - 1;
+                    break;
+                case SCENE_COMPONENT_TYPE::ACTOR: {
+                    VzActorRes* actor_res = gEngineApp->GetActorRes(vidActor);
+                    VzGeometryRes* geo_res = actor_res ? gEngineApp->GetGeometryRes(actor_res->GetGeometryVid()) : nullptr;
+                    if (geo_res == nullptr || geo_res->aabb.isEmpty()) {
+                        break;
+                    }
+                    const VzMeshBVH* bvh = geo_res->GetBVH();
+                    if (bvh->IsEmpty()) {
+                        break;
+                    }
+                    mat4f world;
+                    actor->GetWorldTransform(__FP world);
+                    const Aabb box = geo_res->aabb.transform(world);
+                    scene.meshActors.push_back(vidActor);
+                    scene.meshInvWorlds.push_back(inverse(world));
+                    scene.meshBVHs.push_back(bvh);
+                    scene.meshBoxMins.push_back(box.min);
+                    scene.meshBoxMaxs.push_back(box.max);
+                    scene.meshSprites.push_back(spriteIndex);
                     break;
+                }
                 default:
-                    backlog::post("scene component type is not supported : " + std::to_string((int) actor->GetSceneCompType()), backlog::LogLevel::Error);
                     break;
             }
-            if (result && recursive) {
+            if (recursive) {
                 std::vector<VID> vidChildren = actor->GetChildren();
                 for (auto vidChild : vidChildren) {
-                    intersect(vidChild);
+                    gather(vidChild, spriteIndex);
                 }
             }
             };
         for (auto vidActor : vidActors) {
-            intersect(vidActor);
+            gather(vidActor, -1);
+        }
+        scene.sceneBVH.Build(scene.meshBoxMins, scene.meshBoxMaxs);
+    }
+
+    // raycasts the sprites whose enclosing sprite (if any) is hit, in gather order
+    //  - spriteHits : whether each sprite is hit
+    //  - hits : the sprite hits are appended
+    static void intersectSprites(const RayQueryScene& scene, const float3& rayOrigin, const float3& rayDirection,
+        std::vector<uint8_t>& spriteHits, std::vector<HitResult>& hits)
+    {
+        spriteHits.assign(scene.sprites.size(), 0);
+        for (size_t i = 0, n = scene.sprites.size(); i < n; ++i) {
+            const int parent = scene.spriteParents[i];
+            if (parent < 0 || spriteHits[parent]) {
+                spriteHits[i] = scene.sprites[i]->Raycast(__FP rayOrigin, __FP rayDirection, hits) ? 1 : 0;
+            }
         }
+    }
+
+    // visits the mesh actors hit by the ray (rayDirection is normalized) whose enclosing sprite (if any) is hit
+    //  - spriteHits : see intersectSprites
+    //  - onHit(index of the mesh actor, world-space distance)
+    template <typename OnHit>
+    static void intersectMeshes(const RayQueryScene& scene, const float3& rayOrigin, const float3& rayDirection,
+        const std::vector<uint8_t>& spriteHits, OnHit&& onHit)
+    {
+        if (scene.meshActors.empty()) {
+            return;
+        }
+        const VzRay ray(rayOrigin, rayDirection);
+        scene.sceneBVH.Traverse(ray, [&](const uint32_t index) {
+            const int sprite = scene.meshSprites[index];
+            if (sprite >= 0 && !spriteHits[sprite]) {
+                return;
+            }
+            // the object-space direction is not normalized, so that t is the world-space distance
+            const mat4f& inv_world = scene.meshInvWorlds[index];
+            const VzRay ray_os((inv_world * float4(rayOrigin, 1.f)).xyz, (inv_world * float4(rayDirection, 0.f)).xyz);
+            float t = FLT_MAX;
+            if (scene.meshBVHs[index]->Intersect(ray_os, t)) {
+                onHit(index, t);
+            }
+            });
+    }
+
+    static HitResult makeHitResult(const VID vidActor, const float3& rayOrigin, const float3& rayDirection, const float t)
+    {
+        HitResult hit;
+        const float3 p = rayOrigin + t * rayDirection;
+        hit.distance = t;
+        hit.point[0] = p.x;
+        hit.point[1] = p.y;
+        hit.point[2] = p.z;
+        hit.actor = vidActor;
+        return hit;
+    }
+
+    size_t VzRenderer::IntersectActors(const uint32_t x, const uint32_t y, const VID vidCam, const std::vector<VID>& vidActors, std::vector<HitResult>& results, const bool recursive) {
+        COMP_RENDERPATH(render_path, 0);
+        results.clear();
+        const Camera* camera = gEngine->getCameraComponent(utils::Entity::import(vidCam));
+        if (camera == nullptr) return 0;
+        uint32_t canvas_h;
+        render_path->GetCanvas(nullptr, &canvas_h, nullptr, nullptr);
+        const filament::Viewport& vp = render_path->GetView()->getViewport();
+        uint32_t x_ = x - vp.left;
+        uint32_t y_ = vp.height - ((canvas_h - y) - vp.bottom);
+        if (x_ >= vp.width || y_ >= vp.height) return 0;
+        float3 p_ws;
+        helpers::ComputePosSS2WS(x_, y_, 0.0f, vidCam, GetVID(), __FP p_ws);
+        float3 rayOrigin = camera->getPosition();
+        float3 rayDirection = normalize(p_ws - rayOrigin);
+
+        RayQueryScene& scene = render_path->GetRayQueryScene();
+        gatherRayQueryScene(vidActors, recursive, scene);
+        std::vector<uint8_t> sprite_hits;
+        intersectSprites(scene, rayOrigin, rayDirection, sprite_hits, results);
+        intersectMeshes(scene, rayOrigin, rayDirection, sprite_hits, [&](const uint32_t index, const float t) {
+            results.push_back(makeHitResult(scene.meshActors[index], rayOrigin, rayDirection, t));
+            });
+
         std::sort(results.begin(), results.end(), [](const HitResult& lhs, const HitResult& rhs) {
             return lhs.distance < rhs.distance;
         });
@@ -139,6 +234,57 @@ namespace vzm
         return results.size();
     }
 
+    size_t VzRenderer::IntersectRays(const float* rays, const size_t rayCount, const std::vector<VID>& vidActors, std::vector<HitResult>& hitResults, const bool recursive) {
+        COMP_RENDERPATH(render_path, 0);
+        hitResults.assign(rayCount, HitResult());
+        if (rays == nullptr || rayCount == 0) return 0;
+
+        // the BVHs are built (if not yet) here, so the jobs below only read the scene
+        RayQueryScene& scene = render_path->GetRayQueryScene();
+        gatherRayQueryScene(vidActors, recursive, scene);
+
+        // each ray writes its own hit record
+        auto intersectRays = [&scene, rays, &hitResults](HitResult* hits, size_t count)
+            {
+                const size_t first = hits - hitResults.data();
+                // one allocation per job at most
+                std::vector<uint8_t> sprite_hit_flags;
+                std::vector<HitResult> sprite_hits;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const float* ray = &rays[6 * (first + i)];
+                    const float3 ray_origin(ray[0], ray[1], ray[2]);
+                    const float3 ray_direction = normalize(float3(ray[3], ray[4], ray[5]));
+                    HitResult& hit = hits[i];
+                    sprite_hits.clear();
+                    intersectSprites(scene, ray_origin, ray_direction, sprite_hit_flags, sprite_hits);
+                    for (const HitResult& sprite_hit : sprite_hits) {
+                        if (sprite_hit.distance < hit.distance) {
+                            hit = sprite_hit;
+                        }
+                    }
+                    intersectMeshes(scene, ray_origin, ray_direction, sprite_hit_flags, [&](const uint32_t index, const float t) {
+                        if (t < hit.distance) {
+                            hit = makeHitResult(scene.meshActors[index], ray_origin, ray_direction, t);
+                        }
+                        });
+                }
+            };
+
+        utils::JobSystem& js = gEngine->getJobSystem();
+        utils::JobSystem::Job* job = utils::jobs::parallel_for(js, nullptr,
+            hitResults.data(), (uint32_t)rayCount,
+            std::cref(intersectRays), utils::jobs::CountSplitter<64>());
+        js.runAndWait(job);
+
+        size_t hit_count = 0;
+        for (const HitResult& hit : hitResults) {
+            hit_count += hit.actor != INVALID_VID ? 1 : 0;
+        }
+        UpdateTimeStamp();
+        return hit_count;
+    }
+
 #pragma region View
     void VzRenderer::SetPostProcessingEnabled(bool enabled)
     {
@@ -850,6 +996,36 @@ namespace vzm
         COMP_RENDERPATH(render_path, ShadowType::PCF);
         return (ShadowType) render_path->viewSettings.shadowType;
     }
+    void VzRenderer::SetShadowMapCaching(bool enabled)
+    {
+        COMP_RENDERPATH(render_path, );
+        View* view = render_path->GetView();
+        view->setShadowMapCachingEnabled(enabled);
+        UpdateTimeStamp();
+    }
+    bool VzRenderer::IsShadowMapCaching()
+    {
+        COMP_RENDERPATH(render_path, false);
+        return render_path->GetView()->isShadowMapCachingEnabled();
+    }
+    void VzRenderer::InvalidateShadowMapCache()
+    {
+        COMP_RENDERPATH(render_path, );
+        View* view = render_path->GetView();
+        view->invalidateShadowMapCache();
+        UpdateTimeStamp();
+    }
+    void VzRenderer::SetLODThreshold(float pixels)
+    {
+        COMP_RENDERPATH(render_path, );
+        render_path->lodPixelError = std::max(pixels, 0.f);
+        UpdateTimeStamp();
+    }
+    float VzRenderer::GetLODThreshold()
+    {
+        COMP_RENDERPATH(render_path, 1.f);
+        return render_path->lodPixelError;
+    }
     void VzRenderer::SetVsmHighPrecision(bool highPrecision)
     {
         COMP_RENDERPATH(render_path, );
@@ -1239,6 +1415,32 @@ namespace vzm
         clearOptions = (ClearOptions&) render_path->GetRenderer()->getClearOptions();
     }
 
+    void VzRenderer::SetFramesInFlight(const uint32_t count)
+    {
+        COMP_RENDERPATH(render_path, );
+        render_path->SetFramesInFlight(count);
+        UpdateTimeStamp();
+    }
+
+    uint32_t VzRenderer::GetFramesInFlight()
+    {
+        COMP_RENDERPATH(render_path, 1u);
+        return render_path->GetFramesInFlight();
+    }
+
+    void VzRenderer::SetCompositedRenderMode(const bool enabled)
+    {
+        COMP_RENDERPATH(render_path, );
+        render_path->SetCompositedRenderMode(enabled);
+        UpdateTimeStamp();
+    }
+
+    bool VzRenderer::IsCompositedRenderMode()
+    {
+        COMP_RENDERPATH(render_path, false);
+        return render_path->IsCompositedRenderMode();
+    }
+
     VZRESULT VzRenderer::Render(const VID vidScene, const VID vidCam)
     {
         VzRenderPath* render_path = gEngineApp->GetRenderPath(GetVID());
@@ -1259,6 +1461,7 @@ namespace vzm
             return VZ_FAIL;
         }
         render_path->TryResizeRenderTargets();
+        render_path->AcquireRenderTargets();
         view->setScene(scene);
         view->setCamera(camera);
         //view->setVisibleLayers(0x4, 0x4);
@@ -1311,64 +1514,77 @@ namespace vzm
             cameraCube->mapFrustum(*gEngine, camera);
         }
 
-        ResourceLoader* resource_loader = gEngineApp->GetGltfResourceLoader();
-        if (resource_loader)
+        VzAssetLoadQueue* load_queue = gEngineApp->GetAssetLoadQueue();
+        if (load_queue)
         {
-            resource_loader->asyncUpdateLoad();
-
-            //static std::set<Texture*> regTexMap;
-            VzAssetRes* asset_res = gEngineApp->GetAssetRes(gEngineApp->activeAsyncAsset);
-            if (asset_res && resource_loader->asyncGetLoadProgress() >= 1.)
-            {
-                int count = 0;
-                gEngineApp->activeAsyncAsset = INVALID_VID;
-                filament::gltfio::FFilamentAsset* fasset = downcast(asset_res->asset);
-                for (auto& it : asset_res->asyncTextures)
-                {
-                    VzTextureRes* tex_res = gEngineApp->GetTextureRes(it.second);
-                    tex_res->texture = fasset->mTextures[it.first].texture;
-                    tex_res->isAsyncLocked = false;
-                }
-                //backlog::post("REDUNDANT TEXTURES : " + std::to_string(count), backlog::LogLevel::Default);
-                asset_res->asyncTextures.clear();
-            }
+            // texture uploads of the in-flight loads (within the per-frame budget),
+            // the textures of the finished loads are handed over to their VzTextures
+            load_queue->Update();
         }
 
-        std::unordered_map<AssetVID, std::unique_ptr<VzAssetRes>>& assetResMap = *gEngineApp->GetAssetResMap();
+        VzTextureDecoder* texture_decoder = gEngineApp->GetTextureDecoder();
+        if (texture_decoder)
+        {
+            // streams the levels decoded so far by the asynchronous VzTexture::ReadImageAsync
+            texture_decoder->Update();
+        }
 
-        for (auto& it : assetResMap)
+        // the animators played in this scene are updated as a job graph
+        //  per-asset sampling (local transforms) -> join, world transform commit
+        //  -> per-asset bone matrices -> join, uploads on this thread (driver commands)
+        std::vector<vzm::VzAsset::Animator*> animators;
+        for (auto& it : gEngineApp->GetVzComponentPool(VZ_COMP_TYPE::ASSET))
         {
-            VzAssetRes* asset_res = it.second.get();
-            VzAsset* v_asset = gEngineApp->GetVzComponent<VzAsset>(it.first);
-            assert(v_asset);
+            VzAsset* v_asset = (VzAsset*)it.second;
             vzm::VzAsset::Animator* animator = v_asset->GetAnimator();
             if (animator->IsPlayScene(vidScene))
             {
-                animator->UpdateAnimation();
+                animators.push_back(animator);
             }
         }
+        std::vector<uint8_t> skinning(animators.size(), 0); // not std::vector<bool>, written by the jobs
+        utils::JobSystem& js = gEngine->getJobSystem();
 
         Renderer* renderer = render_path->GetRenderer();
 
         auto& tcm = gEngine->getTransformManager();
+        if (!animators.empty())
+        {
+            tcm.openLocalTransformTransaction();
+            auto sampleAnimations = [&animators, &skinning](vzm::VzAsset::Animator** first, size_t count) {
+                for (size_t i = 0; i < count; ++i) {
+                    skinning[first - animators.data() + i] = first[i]->SampleAnimation() ? 1 : 0;
+                }
+                };
+            utils::JobSystem::Job* job = utils::jobs::parallel_for(js, nullptr,
+                animators.data(), (uint32_t)animators.size(),
+                std::cref(sampleAnimations), utils::jobs::CountSplitter<1>());
+            js.runAndWait(job);
+        }
         tcm.commitLocalTransformTransaction();
 
-        double3 v = camera->getForwardVector();
-        double3 u = camera->getUpVector();
-        //auto ToString = [](double3 v) -> std::string
-        //    {
-        //        using namespace std;
-        //        return "(" + to_string(v.x) + ", " + to_string(v.y) + ", " + to_string(v.z) + ")";
-        //    };
-        //static size_t debug_count = 0;
-        //if (debug_count++ % 50 == 0)
-        //{
-        //    backlog::post("view : " + ToString(v), backlog::LogLevel::Default);
-        //    backlog::post("up   : " + ToString(u), backlog::LogLevel::Default);
-        //}
-
-        std::map<Entity, mat4f> restore_billboard_tr;
-        scene->forEach([&tcm, &restore_billboard_tr, &u, &v](Entity ett) {
+        if (!animators.empty())
+        {
+            auto computeBoneMatrices = [&animators, &skinning](vzm::VzAsset::Animator** first, size_t count) {
+                for (size_t i = 0; i < count; ++i) {
+                    if (skinning[first - animators.data() + i]) {
+                        first[i]->ComputeBoneMatrices();
+                    }
+                }
+                };
+            utils::JobSystem::Job* job = utils::jobs::parallel_for(js, nullptr,
+                animators.data(), (uint32_t)animators.size(),
+                std::cref(computeBoneMatrices), utils::jobs::CountSplitter<1>());
+            js.runAndWait(job);
+            for (vzm::VzAsset::Animator* animator : animators)
+            {
+                animator->UploadAnimation();
+            }
+        }
+
+        render_path->ClearBillboards();
+        render_path->ClearLODs();
+        scene->forEach([render_path](Entity ett) {
             VID vid = ett.getId();
 
             VzSceneComp* comp = gEngineApp->GetVzComponent<VzSceneComp>(vid);
@@ -1380,91 +1596,137 @@ namespace vzm
             VzActorRes* actor_res = gEngineApp->GetActorRes(vid);
             if (actor_res && actor_res->isBillboard)
             {
-                auto ti = tcm.getInstance(ett);
-                mat4f os2parent = tcm.getTransform(ti); // local
-                restore_billboard_tr[ett] = os2parent;
-
-                mat4 os2ws = (mat4)tcm.getWorldTransform(ti);
-                mat4 parent2ws = os2ws * inverse(os2parent); // fixed
-                double4 p_ws_h = os2ws * double4(0, 0, 0, 1);
-                double3 p_ws = p_ws_h.xyz / p_ws_h.w; // fixed
-
-                mat4 os2ws_new = mat4::lookTo(v, p_ws, u);
-                mat4 os2parent_new = inverse(parent2ws) * os2ws_new;
-
-                tcm.setTransform(ti, os2parent_new);
+                render_path->AddBillboard(ett);
+            }
+            if (actor_res)
+            {
+                VzGeometryRes* geo_res = gEngineApp->GetGeometryRes(actor_res->GetGeometryVid());
+                if (geo_res && (geo_res->HasLODs() || !actor_res->lodLevels.empty()))
+                {
+                    render_path->AddLOD(ett, actor_res, geo_res);
+                }
             }
             });
+        render_path->ApplyBillboards(scene, camera);
+        render_path->ApplyLODs(camera);
 
         filament::Texture* fogColorTexture = gEngineApp->GetSceneRes(vidScene)->GetIBL()->getFogTexture();
         render_path->viewSettings.fogSettings.fogColorTexture = fogColorTexture;
         render_path->ApplySettings();
 
-        // 1. main rendering 
-        view->setVisibleLayers(0x3, 0x1);
-        view->setPostProcessingEnabled(true);
-        view->setRenderTarget(render_path->GetOffscreenRT());
-        renderer->renderStandaloneView(view);
-
-        // 2. gui rendering wo/ postprocessing
+        const bool pipelined = render_path->IsPipelined();
+        filament::SwapChain* sc = render_path->GetSwapChain();
         View* view_gui = render_path->GetGuiView();
-        //scene->setSkybox(nullptr);
-        view_gui->setScene(scene);
-        view_gui->setCamera(camera);
-        view_gui->setPostProcessingEnabled(false);
-        view_gui->setVisibleLayers(0x3, 0x2);
-        view_gui->setRenderTarget(render_path->GetOffscreenGuiRT());
-
         Renderer::ClearOptions restore_clear_options = renderer->getClearOptions();
-        Renderer::ClearOptions clear_options;
-        clear_options.clearColor = float4{ 0, 0, 0, 0 };
-        clear_options.clear = true;
-        clear_options.discard = true;
-        renderer->setClearOptions(clear_options);
+
+        if (render_path->IsCompositedRenderMode())
+        {
+            // 1. main rendering into the swapchain
+            view->setVisibleLayers(0x3, 0x1);
+            view->setPostProcessingEnabled(true);
+            view->setRenderTarget(nullptr);
+
+            // 2. gui rendering wo/ postprocessing, blended over the main rendering
+            //  the gui is rendered into a transient color buffer of the gui view's frame graph,
+            //  which is then blended (premultiplied "over", same as compositor.mat) into the swapchain
+            view_gui->setScene(scene);
+            view_gui->setCamera(camera);
+            view_gui->setPostProcessingEnabled(false);
+            view_gui->setVisibleLayers(0x3, 0x2);
+            view_gui->setRenderTarget(nullptr);
+            view_gui->setBlendMode(BlendMode::TRANSLUCENT);
+
+            if (!pipelined)
+            {
+                Fence::waitAndDestroy(gEngine->createFence());
+            }
+
+            if (renderer->beginFrame(sc)) {
+                // the swapchain is cleared (renderer's clear options) only once, at the first view
+                renderer->render(view);
+
+                // as for the offscreen targets, the clear options are set for each view at every frame,
+                // the gui view is cleared to transparent black (clearColor) to be blended over the main view
+                Renderer::ClearOptions clear_options;
+                clear_options.clearColor = float4{ 0, 0, 0, 0 };
+                clear_options.clear = true;
+                clear_options.discard = true;
+                renderer->setClearOptions(clear_options);
+
+                renderer->render(view_gui);
+                renderer->endFrame();
+            }
+        }
+        else
+        {
+            // 1. main rendering 
+            view->setVisibleLayers(0x3, 0x1);
+            view->setPostProcessingEnabled(true);
+            view->setRenderTarget(render_path->GetOffscreenRT());
+            renderer->renderStandaloneView(view);
+
+            // 2. gui rendering wo/ postprocessing
+            //scene->setSkybox(nullptr);
+            view_gui->setScene(scene);
+            view_gui->setCamera(camera);
+            view_gui->setPostProcessingEnabled(false);
+            view_gui->setVisibleLayers(0x3, 0x2);
+            view_gui->setRenderTarget(render_path->GetOffscreenGuiRT());
+            view_gui->setBlendMode(BlendMode::OPAQUE);
+
+            Renderer::ClearOptions clear_options;
+            clear_options.clearColor = float4{ 0, 0, 0, 0 };
+            clear_options.clear = true;
+            clear_options.discard = true;
+            renderer->setClearOptions(clear_options);
         
-        renderer->renderStandaloneView(view_gui);
+            renderer->renderStandaloneView(view_gui);
 
-        // 3. compositor
-        CompositorQuad* compositor = gEngineApp->GetCompositorQuad();
-        View* view_compositor = render_path->GetCompositorView();
-        view_compositor->setCamera(compositor->GetQaudCamera());
-        view_compositor->setScene(compositor->GetQuadScene());
-        view_compositor->setPostProcessingEnabled(false);
-        view_compositor->setRenderTarget(nullptr);
+            // 3. compositor
+            CompositorQuad* compositor = gEngineApp->GetCompositorQuad();
+            View* view_compositor = render_path->GetCompositorView();
+            view_compositor->setCamera(compositor->GetQaudCamera());
+            view_compositor->setScene(compositor->GetQuadScene());
+            view_compositor->setPostProcessingEnabled(false);
+            view_compositor->setRenderTarget(nullptr);
 
-        MaterialInstance* quad_mi = compositor->GetMaterial();
+            MaterialInstance* quad_mi = compositor->GetMaterial();
 
-        quad_mi->setParameter("mainTexture", render_path->GetOffscreenRT()->getTexture(RenderTarget::AttachmentPoint::COLOR), compositor->sampler);
-        quad_mi->setParameter("guiTexture", render_path->GetOffscreenGuiRT()->getTexture(RenderTarget::AttachmentPoint::COLOR), compositor->sampler);
+            quad_mi->setParameter("mainTexture", render_path->GetOffscreenRT()->getTexture(RenderTarget::AttachmentPoint::COLOR), compositor->sampler);
+            quad_mi->setParameter("guiTexture", render_path->GetOffscreenGuiRT()->getTexture(RenderTarget::AttachmentPoint::COLOR), compositor->sampler);
 
-        //Texture* mainDepth = render_path->GetOffscreenRT()->getTexture(RenderTarget::AttachmentPoint::DEPTH);
-        //Texture* guiDepth = render_path->GetOffscreenGuiRT()->getTexture(RenderTarget::AttachmentPoint::DEPTH);
-        //quad_mi->setParameter("mainDepth", render_path->GetOffscreenRT()->getTexture(RenderTarget::AttachmentPoint::DEPTH), compositor->samplerPoint);
-        //quad_mi->setParameter("guiDepth", render_path->GetOffscreenGuiRT()->getTexture(RenderTarget::AttachmentPoint::DEPTH), compositor->samplerPoint);
-        //quad_mi->setParameter("baseColorMap", render_path->GetOffscreenRT()->getTexture(RenderTarget::AttachmentPoint::COLOR), sampler);
+            //Texture* mainDepth = render_path->GetOffscreenRT()->getTexture(RenderTarget::AttachmentPoint::DEPTH);
+            //Texture* guiDepth = render_path->GetOffscreenGuiRT()->getTexture(RenderTarget::AttachmentPoint::DEPTH);
+            //quad_mi->setParameter("mainDepth", render_path->GetOffscreenRT()->getTexture(RenderTarget::AttachmentPoint::DEPTH), compositor->samplerPoint);
+            //quad_mi->setParameter("guiDepth", render_path->GetOffscreenGuiRT()->getTexture(RenderTarget::AttachmentPoint::DEPTH), compositor->samplerPoint);
+            //quad_mi->setParameter("baseColorMap", render_path->GetOffscreenRT()->getTexture(RenderTarget::AttachmentPoint::COLOR), sampler);
 
-        clear_options.clear = false;
-        clear_options.discard = true;
-        renderer->setClearOptions(clear_options);
+            clear_options.clear = false;
+            clear_options.discard = true;
+            renderer->setClearOptions(clear_options);
 
-        Fence::waitAndDestroy(gEngine->createFence());
+            if (!pipelined)
+            {
+                Fence::waitAndDestroy(gEngine->createFence());
+            }
 
-        filament::SwapChain* sc = render_path->GetSwapChain();
-        if (renderer->beginFrame(sc)) {
-            renderer->render(view_compositor);
-            renderer->endFrame();
+            if (renderer->beginFrame(sc)) {
+                renderer->render(view_compositor);
+                renderer->endFrame();
+            }
+            // in the pipelined mode, the offscreen targets of this frame are waited for
+            // only when they are recycled (refer to VzRenderPath::AcquireRenderTargets)
+            render_path->SubmitRenderTargets();
         }
 
         renderer->setClearOptions(restore_clear_options);
 
-        for (auto& it : restore_billboard_tr)
-        {
-            auto ti = tcm.getInstance(it.first);
-            tcm.setTransform(ti, it.second);
-        }
+        render_path->ResetBillboards(scene);
 
         if (gEngine->getBackend() == Backend::OPENGL)
         {
+            // kept in the pipelined mode as well: the workaround is for the GL driver, not for the offscreen targets,
+            // so on OpenGL the frames are not overlapped (only the wait before the final pass is removed)
             //std::this_thread::sleep_for(std::chrono::milliseconds(1));
             //https://github.com/google/filament/discussions/7968#discussioncomment-11020205
             Fence::waitAndDestroy(gEngine->createFence());
@@ -20,6 +20,11 @@ namespace vzm
         void Pick(const uint32_t x, const uint32_t y, PickCallback callback);
 
         size_t IntersectActors(const uint32_t x, const uint32_t y, const VID vidCam, const std::vector<VID>& vidActors, std::vector<HitResult>& hitResults, const bool recursive = true);
+        // batch ray query (e.g., lasso selection, measurement tools, visibility probes), processed in parallel
+        //  - rays : world-space origin (xyz) and direction (xyz) per ray, so 6 * rayCount floats
+        //  - hitResults : the closest hit per ray (actor is INVALID_VID if the ray misses)
+        //  - returns the number of rays that hit
+        size_t IntersectRays(const float* rays, const size_t rayCount, const std::vector<VID>& vidActors, std::vector<HitResult>& hitResults, const bool recursive = true);
 
         // setters and getters of rendering options
         void SetPostProcessingEnabled(bool enabled);
@@ -217,6 +222,17 @@ namespace vzm
         void SetShadowType(ShadowType shadowType);
         ShadowType GetShadowType();
 
+        // the shadow map layers are kept across frames and rendered again only when their casters or light change
+        // (skinned, morphed or instanced casters re-render their shadow maps every frame)
+        void SetShadowMapCaching(bool enabled);
+        bool IsShadowMapCaching();
+        void InvalidateShadowMapCache(); // e.g., after the material of a caster is modified
+
+        // the actors whose geometry has levels of detail (see VzGeometry::GenerateLODs) use the coarsest level
+        // whose error stays under this threshold on screen, in pixels (0 : always the base level)
+        void SetLODThreshold(float pixels);
+        float GetLODThreshold();
+
         void SetVsmHighPrecision(bool highPrecision);
         bool IsVsmHighPrecision();
 
@@ -315,6 +331,20 @@ namespace vzm
         void SetClearOptions(const ClearOptions& clearOptions);
         void GetClearOptions(ClearOptions& clearOptions);
 
+        // the number of frames that can be in flight (1 ~ 3)
+        //  - 1 : the main thread waits until the driver has consumed the frame (default)
+        //  - 2 or 3 : the next frame is prepared while the driver/GPU is working on the previous ones
+        //    (on OpenGL, the wait at the end of the frame is kept as a driver workaround)
+        void SetFramesInFlight(const uint32_t count);
+        uint32_t GetFramesInFlight();
+
+        // composited render mode (default : false)
+        //  - true : the main and gui layers are rendered into the swapchain within a single frame,
+        //           the gui layer being blended over the main layer (no offscreen targets and no compositor pass)
+        //  - false : the main and gui layers are rendered into offscreen targets and composited by a full-screen quad
+        void SetCompositedRenderMode(const bool enabled);
+        bool IsCompositedRenderMode();
+
         VZRESULT Render(const VID vidScene, const VID vidCam);
         VZRESULT Render(const VzBaseComp* scene, const VzBaseComp* camera) { return Render(scene->GetVID(), camera->GetVID()); };
     };
@@ -23,7 +23,7 @@ namespace vzm
             return false;
         }
         if (!iblPath.isDirectory()) {
-            if (!ibl->loadFromEquirect(iblPath)) {
+            if (!ibl->loadFromEquirect(iblPath, &gEngineApp->GetIBLCache())) {
                 backlog::post("Could not load the specified IBL: " + path, backlog::LogLevel::Error);
                 return false;
             }
@@ -1,8 +1,10 @@
 #include "VzTexture.h"
 #include "../VzEngineApp.h"
 #include "../FIncludes.h"
+#include "../backend/VzTextureCompressor.h"
 
 #include "../../libs/imageio/include/imageio/ImageDecoder.h"
+#include <image/ImageSampler.h>
 
 #include <fstream>
 #include <iostream>
@@ -16,7 +18,7 @@ namespace vzm
 {
 #define ASYNCCHECK if (tex_res->isAsyncLocked) { backlog::post("Texture (" + GetName() + ") is under asynchronuous loading, so not allowed be to update!", backlog::LogLevel::Error); return false; }
 
-    bool VzTexture::ReadImage(const std::string& fileName, const bool isLinear, const bool generateMIPs)
+    bool VzTexture::ReadImage(const std::string& fileName, const bool isLinear, const bool generateMIPs, const TextureCompression compression)
     {
         // need 'safe check'
         // check if the texture is async texture
@@ -38,7 +40,26 @@ namespace vzm
 
         tex_res->fileName = fileName;
 
-        if ((fileName.rfind(".jpg") != std::string::npos) ||
+        if (compression != TextureCompression::NONE) {
+            LinearImage image = VzTextureCompressor::Decode(fileName, isLinear);
+            if (!image.isValid()) {
+                backlog::post("The input image is invalid:: " + fileName, backlog::LogLevel::Error);
+                return false;
+            }
+
+            const uint32_t level_count = generateMIPs ? getMipmapCount(image) + 1 : 1;
+            std::vector<uint8_t> ktx2;
+            Texture* texture = nullptr;
+            if (VzTextureCompressor::EncodeKtx2(VzTextureCompressor::GenerateMipmaps(image, level_count), isLinear, ktx2)) {
+                texture = VzTextureCompressor::CreateTexture(ktx2, isLinear, compression);
+            }
+            if (texture == nullptr) {
+                backlog::post("Unable to compress the input image: " + fileName, backlog::LogLevel::Error);
+                return false;
+            }
+
+            tex_res->texture = texture;
+        } else if ((fileName.rfind(".jpg") != std::string::npos) ||
             (fileName.rfind(".jpeg") != std::string::npos)) {
             std::ifstream inputStream(file_name, std::ios::binary);
 
@@ -114,7 +135,7 @@ namespace vzm
             tex_res->texture = texture;
         }
 
-        if (generateMIPs) {
+        if (generateMIPs && compression == TextureCompression::NONE) {
           tex_res->texture->generateMipmaps(*gEngine);
         }
 
@@ -144,6 +165,24 @@ namespace vzm
         return true;
     }
 
+    bool VzTexture::ReadImageAsync(const std::string& fileName, const bool isLinear, const bool generateMIPs,
+        void(*callback)(const VID vidTexture, const bool success, void* userData), void* userData, const TextureCompression compression)
+    {
+        VzTextureRes* tex_res = gEngineApp->GetTextureRes(GetVID());
+        ASYNCCHECK;
+        return gEngineApp->GetTextureDecoder()->Enqueue(GetVID(), fileName, isLinear, generateMIPs, callback, userData, compression);
+    }
+
+    float VzTexture::GetReadProgress()
+    {
+        return gEngineApp->GetTextureDecoder()->GetProgress(GetVID());
+    }
+
+    bool VzTexture::CancelReadImageAsync()
+    {
+        return gEngineApp->GetTextureDecoder()->Cancel(GetVID());
+    }
+
     std::string VzTexture::GetImageFileName()
     {
         VzTextureRes* tex_res = gEngineApp->GetTextureRes(GetVID());
@@ -7,7 +7,20 @@ namespace vzm
     {
         VzTexture(const VID vid, const std::string& originFrom)
             : VzResource(vid, originFrom, "VzTexture", RES_COMPONENT_TYPE::TEXTURE) {}
-        bool ReadImage(const std::string& fileName, const bool isLinear = true, const bool generateMIPs = true);
+        // compression: the mipmaps are generated and the image is block-compressed on the CPU before the upload
+        //  (the texture takes 4-8x less GPU memory than the uncompressed float or 8-bit image, see TextureCompression)
+        bool ReadImage(const std::string& fileName, const bool isLinear = true, const bool generateMIPs = true,
+            const TextureCompression compression = TextureCompression::NONE);
+        // decodes the image on the engine's job system (the texture is locked until it completes)
+        //  - the base level is shown as soon as it is decoded, then the lower mip levels are streamed in
+        //  - the callback (if any) is called on the rendering thread when the texture is complete or the decoding fails
+        //  - return false if the read cannot start (e.g., the texture is already under asynchronous loading)
+        bool ReadImageAsync(const std::string& fileName, const bool isLinear = true, const bool generateMIPs = true,
+            void(*callback)(const VID vidTexture, const bool success, void* userData) = nullptr, void* userData = nullptr,
+            const TextureCompression compression = TextureCompression::NONE);
+        // [0, 1] (uploaded mip levels), -1 if the texture is not being read asynchronously
+        float GetReadProgress();
+        bool CancelReadImageAsync();
         std::string GetImageFileName();
 
         // sampler
@@ -0,0 +1,114 @@
+#include "VizEngineAPIs.h"
+#include "VzEngineApp.h"
+#include "FIncludes.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cwchar>
+#include <string>
+#include <vector>
+
+extern Engine* gEngine;
+extern vzm::VzEngineApp* gEngineApp;
+
+// Per-frame cost of live-updating text labels (e.g. telemetry readouts): each label gets a new
+// string and is built again (VzTypesetter::Typeset, which places the glyphs, re-blits the changed
+// lines and uploads their rows, then the in-place update of the sprite quad).
+// The argument is the number of lines (out of 3) whose value changes at each frame.
+// The NOOP backend is used, so this measures the CPU side; the commands of a frame are flushed
+// and executed at the end of the frame, as the renderer would.
+class TextUpdateFixture : public benchmark::Fixture
+{
+protected:
+    static constexpr size_t LABEL_COUNT = 1000;
+    static constexpr uint32_t LINE_COUNT = 3;
+
+    std::vector<vzm::VzTextSpriteActor*> labels;
+    uint32_t frame = 0;
+    bool ready = false;
+
+    // fixed-width values, so the text image keeps its size
+    static std::wstring makeText(const size_t label, const uint32_t frame, const uint32_t changedLines)
+    {
+        uint32_t values[LINE_COUNT];
+        for (uint32_t line = 0; line < LINE_COUNT; ++line)
+        {
+            const uint32_t t = line < changedLines ? frame : 0;
+            values[line] = (uint32_t)((label * 7919 + line * 104729 + t * 31) % 100000);
+        }
+        wchar_t text[64];
+        std::swprintf(text, 64, L"ALT %05u m\nSPD %05u kt\nHDG %05u", values[0], values[1], values[2]);
+        return text;
+    }
+
+public:
+    void SetUp(const benchmark::State& state) override
+    {
+        vzm::ParamMap<std::string> arguments;
+        arguments.SetString("api", "noop");
+        if (vzm::InitEngineLib(arguments) != VZ_OK)
+        {
+            return;
+        }
+        vzm::VzFont* font = (vzm::VzFont*)vzm::NewResComponent(vzm::RES_COMPONENT_TYPE::FONT, "benchmark font");
+        if (!font->ReadFont(VZ_BENCHMARK_FONT, 30))
+        {
+            return;
+        }
+        for (size_t i = 0; i < LABEL_COUNT; ++i)
+        {
+            vzm::VzTextSpriteActor* label = (vzm::VzTextSpriteActor*)vzm::NewSceneComponent(
+                vzm::SCENE_COMPONENT_TYPE::TEXT_SPRITE_ACTOR, "label " + std::to_string(i));
+            label->SetFont(font->GetVID());
+            // the first build allocates the texture and the renderable
+            label->SetTextW(makeText(i, 0, 0))
+                .SetAnchorU(0.5f)
+                .SetAnchorV(0.5f)
+                .SetFontHeight(1.0f)
+                .Build();
+            labels.push_back(label);
+        }
+        gEngine->flushAndWait();
+        frame = 0;
+        ready = true;
+    }
+
+    void TearDown(const benchmark::State& state) override
+    {
+        labels.clear();
+        ready = false;
+        vzm::DeinitEngineLib();
+    }
+};
+
+BENCHMARK_DEFINE_F(TextUpdateFixture, update)(benchmark::State& state)
+{
+    if (!ready)
+    {
+        state.SkipWithError("Unable to initialize the engine or to read " VZ_BENCHMARK_FONT);
+        return;
+    }
+    const uint32_t changed_lines = (uint32_t)state.range(0);
+    size_t uploaded_bytes = 0;
+    for (auto _ : state)
+    {
+        ++frame;
+        for (size_t i = 0; i < LABEL_COUNT; ++i)
+        {
+            vzm::VzTextSpriteActor* label = labels[i];
+            label->SetTextW(makeText(i, frame, changed_lines)).Build();
+
+            // the texture is R8, the rows are uploaded over the whole capacity width
+            const vzm::VzTypesetter& typesetter = gEngineApp->GetActorRes(label->GetVID())->textField.typesetter;
+            uploaded_bytes += (size_t)typesetter.uploadedRows * typesetter.capacityWidth;
+        }
+        gEngine->flushAndWait();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * LABEL_COUNT));
+    state.counters["uploadBytes/frame"] = benchmark::Counter(
+        double(uploaded_bytes), benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK_REGISTER_F(TextUpdateFixture, update)->Arg(1)->Arg(3)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,22 @@
+# Writes OUTPUT, a header defining VZ_BUILD_ID as a hash of the content of INPUT (the filamat library, which
+# includes glslang and spirv-tools), so that the material cache keys change whenever the material compiler changes.
+# The header is only rewritten when the hash differs, so that the sources including it are not recompiled otherwise.
+#
+# usage : cmake -DINPUT=<library> -DOUTPUT=<header> -P VzBuildId.cmake
+
+if (EXISTS "${INPUT}")
+    file(SHA256 "${INPUT}" VZ_BUILD_ID)
+    string(SUBSTRING "${VZ_BUILD_ID}" 0 16 VZ_BUILD_ID)
+    set(CONTENT "#define VZ_BUILD_ID \"${VZ_BUILD_ID}\"\n")
+else()
+    message(WARNING "${INPUT} not found, the material cache is not keyed by build")
+    set(CONTENT "")
+endif()
+
+set(PREVIOUS_CONTENT "")
+if (EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" PREVIOUS_CONTENT)
+endif()
+if (NOT EXISTS "${OUTPUT}" OR NOT CONTENT STREQUAL PREVIOUS_CONTENT)
+    file(WRITE "${OUTPUT}" "${CONTENT}")
+endif()
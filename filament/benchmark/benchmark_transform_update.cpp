@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerformanceCounters.h"
+
+#include <benchmark/benchmark.h>
+
+#include <filament/Engine.h>
+#include <filament/TransformManager.h>
+
+#include <utils/EntityManager.h>
+
+#include <math/mat4.h>
+#include <math/vec3.h>
+
+#include <random>
+#include <vector>
+
+using namespace filament;
+using namespace filament::math;
+using namespace utils;
+
+// Cost of committing a local transform transaction in a large scene (~200k nodes), i.e.
+// computing the world transforms of the nodes whose local transform (or an ancestor's) changed:
+//  - sparse : a few hundred nodes anywhere in the scene are moved each frame
+//  - roots : every object is moved, so all the world transforms are recomputed level by level
+// The argument is the number of JobSystem worker threads, to show the scaling with core count.
+class TransformUpdateFixture : public benchmark::Fixture {
+protected:
+    static constexpr size_t OBJECT_COUNT = 2048;
+    static constexpr size_t NODE_COUNT = 96;        // per object, including its root
+    static constexpr size_t BRANCHING = 3;
+    static constexpr size_t MOVED_COUNT = 256;
+
+    Engine* engine = nullptr;
+    std::vector<Entity> roots;
+    std::vector<Entity> nodes;
+    std::default_random_engine gen; // NOLINT
+
+    static mat4f randomTransform(std::default_random_engine& gen) {
+        std::uniform_real_distribution<float> rand(-1.0f, 1.0f);
+        return mat4f::translation(float3{ rand(gen), rand(gen), rand(gen) }) *
+               mat4f::rotation(rand(gen), float3{ 0, 1, 0 });
+    }
+
+public:
+    void SetUp(const benchmark::State& state) override {
+        Engine::Config config;
+        config.jobSystemThreadCount = uint32_t(state.range(0));
+        engine = Engine::Builder()
+                .backend(Engine::Backend::NOOP)
+                .config(&config)
+                .build();
+
+        TransformManager& tcm = engine->getTransformManager();
+        EntityManager& em = EntityManager::get();
+        roots.resize(OBJECT_COUNT);
+        nodes.resize(OBJECT_COUNT * NODE_COUNT);
+        em.create(nodes.size(), nodes.data());
+        for (size_t o = 0; o < OBJECT_COUNT; o++) {
+            // each object is a tree, node n is a child of node (n - 1) / BRANCHING
+            Entity const* object = nodes.data() + o * NODE_COUNT;
+            roots[o] = object[0];
+            tcm.create(object[0], {}, randomTransform(gen));
+            for (size_t n = 1; n < NODE_COUNT; n++) {
+                tcm.create(object[n], tcm.getInstance(object[(n - 1) / BRANCHING]),
+                        randomTransform(gen));
+            }
+        }
+    }
+
+    void TearDown(const benchmark::State&) override {
+        TransformManager& tcm = engine->getTransformManager();
+        for (Entity node : nodes) {
+            tcm.destroy(node);
+        }
+        EntityManager::get().destroy(nodes.size(), nodes.data());
+        nodes.clear();
+        roots.clear();
+        Engine::destroy(&engine);
+    }
+};
+
+BENCHMARK_DEFINE_F(TransformUpdateFixture, sparse)(benchmark::State& state) {
+    TransformManager& tcm = engine->getTransformManager();
+    std::uniform_int_distribution<size_t> pick(0, nodes.size() - 1);
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            tcm.openLocalTransformTransaction();
+            for (size_t i = 0; i < MOVED_COUNT; i++) {
+                tcm.setTransform(tcm.getInstance(nodes[pick(gen)]), randomTransform(gen));
+            }
+            tcm.commitLocalTransformTransaction();
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * MOVED_COUNT));
+    }
+}
+
+BENCHMARK_DEFINE_F(TransformUpdateFixture, roots)(benchmark::State& state) {
+    TransformManager& tcm = engine->getTransformManager();
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            tcm.openLocalTransformTransaction();
+            for (Entity root : roots) {
+                tcm.setTransform(tcm.getInstance(root), randomTransform(gen));
+            }
+            tcm.commitLocalTransformTransaction();
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * nodes.size()));
+    }
+}
+
+BENCHMARK_REGISTER_F(TransformUpdateFixture, sparse)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+BENCHMARK_REGISTER_F(TransformUpdateFixture, roots)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
@@ -24,6 +24,8 @@
 #include <utils/compiler.h>
 #include <utils/Invocable.h>
 
+#include <math/mathfwd.h>
+
 #include <stddef.h>
 
 namespace utils {
@@ -177,6 +179,21 @@ public:
      */
     void forEach(utils::Invocable<void(utils::Entity entity)>&& functor) const noexcept;
 
+    /**
+     * Overrides the world transform of renderables of the Scene for rendering, without modifying
+     * their Transform component.
+     *
+     * This is meant for transforms that depend on the view, e.g. camera-facing billboards. The
+     * overrides are used by all the following renderings of the Scene, until they are set again.
+     * The View's world origin transform still applies to them.
+     *
+     * @param entities Array of renderable entities, those not in the Scene are ignored.
+     * @param transforms World transforms of the entities.
+     * @param count Size of the arrays, 0 removes all the overrides. The arrays are copied.
+     */
+    void setWorldTransformOverrides(const utils::Entity* UTILS_NULLABLE entities,
+            const math::mat4* UTILS_NULLABLE transforms, size_t count) noexcept;
+
 protected:
     // prevent heap allocation
     ~Scene() = default;
@@ -613,6 +613,37 @@ public:
      */
     SoftShadowOptions getSoftShadowOptions() const noexcept;
 
+    /**
+     * Enables or disables the caching of shadow maps across frames. Disabled by default.
+     *
+     * When enabled, the shadow map texture is kept between frames and each shadow map is
+     * rendered again only when its light, its shadow camera, or the transform, visibility or
+     * primitives of the renderables that may cast a shadow in it changed. This saves most of the
+     * shadow passes in scenes where the lights and most renderables don't move. Skinned, morphed
+     * and instanced renderables are considered changed every frame.
+     *
+     * Changes to the content of a caster's buffers or to its material are not detected, call
+     * invalidateShadowMapCache() after such changes.
+     *
+     * Note that directional shadow cascades follow the camera, they are only reused while the
+     * camera doesn't move.
+     *
+     * @param enabled true enables shadow map caching, false disables it.
+     */
+    void setShadowMapCachingEnabled(bool enabled) noexcept;
+
+    /**
+     * @return whether shadow map caching is enabled
+     */
+    bool isShadowMapCachingEnabled() const noexcept;
+
+    /**
+     * Forces all shadow maps to be rendered again on the next frame.
+     *
+     * @see setShadowMapCachingEnabled
+     */
+    void invalidateShadowMapCache() noexcept;
+
     /**
      * Enables or disables post processing. Enabled by default.
      *
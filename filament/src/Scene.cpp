@@ -75,4 +75,9 @@ void Scene::forEach(Invocable<void(utils::Entity)>&& functor) const noexcept {
     downcast(this)->forEach(std::move(functor));
 }
 
+void Scene::setWorldTransformOverrides(const Entity* entities, const math::mat4* transforms,
+        size_t count) noexcept {
+    downcast(this)->setWorldTransformOverrides(entities, transforms, count);
+}
+
 } // namespace filament
@@ -26,6 +26,8 @@
 
 #include "components/RenderableManager.h"
 
+#include "RenderPrimitive.h"
+
 #include "details/Camera.h"
 #include "details/DebugRegistry.h"
 #include "details/Texture.h"
@@ -40,6 +42,7 @@
 #include <backend/DriverEnums.h>
 
 #include <utils/FixedCapacityVector.h>
+#include <utils/Hash.h>
 #include <utils/Range.h>
 #include <utils/Slice.h>
 #include <utils/compiler.h>
@@ -104,6 +107,145 @@ void ShadowMapManager::terminate(FEngine& engine) {
             std::launder(reinterpret_cast<ShadowMap*>(&entry))->terminate(engine);
         }
     }
+    if (mCache.atlas) {
+        engine.getDriverApi().destroyTexture(mCache.atlas);
+        mCache.atlas.clear();
+    }
+}
+
+void ShadowMapManager::updateCache(FEngine& engine, FView const& view) noexcept {
+    DriverApi& driver = engine.getDriverApi();
+    TextureAtlasRequirements const& requirements = mTextureAtlasRequirements;
+    bool const caching = view.isShadowMapCachingEnabled();
+
+    if (mCache.atlas && (!caching ||
+            mCache.requirements.size != requirements.size ||
+            mCache.requirements.layers != requirements.layers ||
+            mCache.requirements.levels != requirements.levels ||
+            mCache.requirements.format != requirements.format)) {
+        driver.destroyTexture(mCache.atlas);
+        mCache.atlas.clear();
+    }
+
+    mCache.beginFrame(bool(mCache.atlas), view.getShadowMapCacheGeneration());
+
+    if (caching && !mCache.atlas) {
+        mCache.requirements = requirements;
+        mCache.atlas = driver.createTexture(SamplerType::SAMPLER_2D_ARRAY,
+                requirements.levels, requirements.format, 1,
+                requirements.size, requirements.size, requirements.layers,
+                TextureUsage::SAMPLEABLE | (view.hasVSM() ?
+                        TextureUsage::COLOR_ATTACHMENT : TextureUsage::DEPTH_ATTACHMENT));
+    }
+}
+
+void ShadowMapManager::ShadowMapCache::beginFrame(bool atlasValid,
+        uint32_t viewGeneration) noexcept {
+    if (atlasValid && generation == viewGeneration) {
+        previousLayers = layers;
+    } else {
+        previousLayers.fill(0);
+    }
+    // the layers not rendered nor reused this frame become invalid
+    layers.fill(0);
+    generation = viewGeneration;
+}
+
+bool ShadowMapManager::ShadowMapCache::reuse(size_t layer, uint64_t contentHash) noexcept {
+    layers[layer] = contentHash;
+    return contentHash && contentHash == previousLayers[layer];
+}
+
+namespace {
+
+// 64-bits murmur3 of word-aligned data
+template<typename T>
+uint64_t hash64(T const& key, uint64_t seed) noexcept {
+    static_assert(0 == (sizeof(key) & 3u), "Hashing requires a size that is a multiple of 4.");
+    auto const* const words = reinterpret_cast<uint32_t const*>(&key);
+    return uint64_t(utils::hash::murmur3(words, sizeof(key) / 4, uint32_t(seed))) << 32u |
+            utils::hash::murmur3(words, sizeof(key) / 4, uint32_t(seed >> 32u) ^ 0x9e3779b9u);
+}
+
+} // anonymous namespace
+
+uint64_t ShadowMapManager::getCastersHash(
+        FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> range,
+        FScene::VisibleMaskType visibilityMask) noexcept {
+    auto const* const soaInstance = renderableData.data<FScene::RENDERABLE_INSTANCE>();
+    auto const* const soaWorldTransform = renderableData.data<FScene::WORLD_TRANSFORM>();
+    auto const* const soaVisibility = renderableData.data<FScene::VISIBILITY_STATE>();
+    auto const* const soaInstances = renderableData.data<FScene::INSTANCES>();
+    auto const* const soaVisibleMask = renderableData.data<FScene::VISIBLE_MASK>();
+    auto const* const soaPrimitives = renderableData.data<FScene::PRIMITIVES>();
+
+    // Casters which content changes without their transform changing are never cached. The
+    // hashes of the casters are summed, so that their order in the scene doesn't matter.
+    uint64_t hash = range.size();
+    for (uint32_t i : range) {
+        if (!(soaVisibleMask[i] & visibilityMask)) {
+            continue;
+        }
+        auto const visibility = soaVisibility[i];
+        if (visibility.skinning || visibility.morphing || soaInstances[i].buffer) {
+            return 0;
+        }
+        uint64_t h = hash64(soaWorldTransform[i], soaInstance[i].asValue());
+        for (FRenderPrimitive const& primitive : soaPrimitives[i]) {
+            struct {
+                uint32_t primitive;
+                uint32_t vertexBufferInfo;
+                uint32_t indexOffset;
+                uint32_t indexCount;
+                FMaterialInstance const* materialInstance;
+            } const key = {
+                    primitive.getHwHandle().getId(),
+                    primitive.getVertexBufferInfoHandle().getId(),
+                    primitive.getIndexOffset(),
+                    primitive.getIndexCount(),
+                    primitive.getMaterialInstance() };
+            h = hash64(key, h);
+        }
+        hash += h;
+    }
+    return hash ? hash : 1;
+}
+
+uint64_t ShadowMapManager::getContentHash(ShadowMap const& shadowMap,
+        uint64_t castersHash) noexcept {
+    if (!castersHash) {
+        return 0;
+    }
+    FCamera const& camera = shadowMap.getCamera();
+    LightManager::ShadowOptions const& options = *shadowMap.getShadowOptions();
+    struct {
+        mat4 projection;
+        mat4 view;
+        backend::Viewport viewport;
+        backend::Viewport scissor;
+        uint32_t mapSize;
+        float polygonOffsetConstant;
+        float polygonOffsetSlope;
+        float blurWidth;
+        uint32_t shadowType;
+        uint32_t face;
+        uint32_t layer;
+        uint32_t padding;
+    } const key = {
+            camera.getProjectionMatrix(),
+            camera.getViewMatrix(),
+            shadowMap.getViewport(),
+            shadowMap.getScissor(),
+            options.mapSize,
+            options.polygonOffsetConstant,
+            options.polygonOffsetSlope,
+            options.vsm.blurWidth,
+            uint32_t(shadowMap.getShadowType()),
+            shadowMap.getFace(),
+            shadowMap.getLayer(),
+            0 };
+    uint64_t const hash = hash64(key, castersHash);
+    return hash ? hash : 1;
 }
 
 ShadowMapManager::ShadowTechnique ShadowMapManager::update(
@@ -221,6 +363,22 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
     const TextureAtlasRequirements textureRequirements = mTextureAtlasRequirements;
     assert_invariant(textureRequirements.layers <= CONFIG_MAX_SHADOW_LAYERS);
 
+    // with caching, the atlas is ours and the layers whose content didn't change are not rendered
+    updateCache(engine, view);
+    FrameGraphId<FrameGraphTexture> cachedShadows;
+    if (mCache.atlas) {
+        cachedShadows = fg.import("Shadowmap", {
+                        .width = textureRequirements.size, .height = textureRequirements.size,
+                        .depth = textureRequirements.layers,
+                        .levels = textureRequirements.levels,
+                        .type = SamplerType::SAMPLER_2D_ARRAY,
+                        .format = textureRequirements.format },
+                FrameGraphTexture::Usage::SAMPLEABLE | (view.hasVSM() ?
+                        FrameGraphTexture::Usage::COLOR_ATTACHMENT :
+                        FrameGraphTexture::Usage::DEPTH_ATTACHMENT),
+                FrameGraphTexture{ .handle = mCache.atlas });
+    }
+
     // -------------------------------------------------------------------------------------------
     // Prepare Shadow Pass
     // -------------------------------------------------------------------------------------------
@@ -243,13 +401,36 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
     auto& prepareShadowPass = fg.addPass<PrepareShadowPassData>("Prepare Shadow Pass",
             [&](FrameGraph::Builder& builder, auto& data) {
                 data.passList.reserve(CONFIG_MAX_SHADOWMAPS);
-                data.shadows = builder.createTexture("Shadowmap", {
-                        .width = textureRequirements.size, .height = textureRequirements.size,
-                        .depth = textureRequirements.layers,
-                        .levels = textureRequirements.levels,
-                        .type = SamplerType::SAMPLER_2D_ARRAY,
-                        .format = textureRequirements.format
-                });
+                if (cachedShadows) {
+                    data.shadows = cachedShadows;
+                } else {
+                    data.shadows = builder.createTexture("Shadowmap", {
+                            .width = textureRequirements.size, .height = textureRequirements.size,
+                            .depth = textureRequirements.layers,
+                            .levels = textureRequirements.levels,
+                            .type = SamplerType::SAMPLER_2D_ARRAY,
+                            .format = textureRequirements.format
+                    });
+                }
+
+                // a layer is reused if what would be rendered in it hasn't changed
+                auto isCached = [this, caching = bool(cachedShadows)](
+                        ShadowMap const& shadowMap, uint64_t castersHash) {
+                    return caching && mCache.reuse(shadowMap.getLayer(),
+                            getContentHash(shadowMap, castersHash));
+                };
+
+                // the primitives of the casters are part of their hash, they're only set in the
+                // renderable SoA by updatePrimitivesLod(), so this must happen before hashing
+                auto const getCastersHashIfCached = [&](utils::Range<uint32_t> range,
+                        FScene::VisibleMaskType visibilityMask) -> uint64_t {
+                    if (!cachedShadows) {
+                        return 0;
+                    }
+                    view.updatePrimitivesLod(engine,
+                            mainCameraInfo, scene->getRenderableData(), range);
+                    return getCastersHash(scene->getRenderableData(), range, visibilityMask);
+                };
 
                 // these loops create a list of the shadow maps that might need to be rendered
                 auto& passList = data.passList;
@@ -257,9 +438,11 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                 // Directional, cascaded shadow maps
                 auto const directionalShadowCastersRange = view.getVisibleDirectionalShadowCasters();
                 if (!directionalShadowCastersRange.empty()) {
+                    uint64_t const castersHash = getCastersHashIfCached(
+                            directionalShadowCastersRange, VISIBLE_DIR_SHADOW_RENDERABLE);
                     for (auto& shadowMap : getCascadedShadowMap()) {
                         // for the directional light, we already know if it has visible shadows.
-                        if (shadowMap.hasVisibleShadows()) {
+                        if (shadowMap.hasVisibleShadows() && !isCached(shadowMap, castersHash)) {
                             passList.push_back({
                                     {}, &shadowMap, directionalShadowCastersRange,
                                     VISIBLE_DIR_SHADOW_RENDERABLE });
@@ -270,6 +453,10 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                 // Point lights and Spotlight shadow maps
                 auto const spotShadowCastersRange = view.getVisibleSpotShadowCasters();
                 if (!spotShadowCastersRange.empty()) {
+                    // spot casters are only culled per shadow map when rendering, so all the
+                    // potential casters are taken into account
+                    uint64_t const castersHash = getCastersHashIfCached(
+                            spotShadowCastersRange, VISIBLE_DYN_SHADOW_RENDERABLE);
                     for (auto& shadowMap : getSpotShadowMaps()) {
                         assert_invariant(!shadowMap.isDirectionalShadow());
 
@@ -287,7 +474,7 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                                 break;
                         }
 
-                        if (shadowMap.hasVisibleShadows()) {
+                        if (shadowMap.hasVisibleShadows() && !isCached(shadowMap, castersHash)) {
                             passList.push_back({
                                     {}, &shadowMap, spotShadowCastersRange,
                                     VISIBLE_DYN_SHADOW_RENDERABLE });
@@ -476,6 +663,11 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                     // finally, create the shadowmap render target -- one per layer.
                     auto rt = builder.declareRenderPass("Shadow RT", renderTargetDesc);
 
+                    // a cached layer is assumed to be rendered, it can't be culled
+                    if (mCache.atlas) {
+                        builder.sideEffect();
+                    }
+
                     // render either directly into the shadowmap, or to the temporary texture for
                     // blurring.
                     data.rt = blur ? data.rt : rt;
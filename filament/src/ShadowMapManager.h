@@ -56,6 +56,10 @@
 #include <stdint.h>
 #include <stddef.h>
 
+// for gtest
+class FilamentTest_ShadowMapCache_Test;
+class FilamentTest_ShadowMapCacheRendering_Test;
+
 namespace filament {
 
 class FCamera;
@@ -175,6 +179,18 @@ private:
             FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range,
             FScene::LightSoa& lightData) noexcept;
 
+    // (re)creates the cached atlas or releases it, see View::setShadowMapCachingEnabled()
+    void updateCache(FEngine& engine, FView const& view) noexcept;
+
+    // hash of the casters of a shadow map, 0 if some of them change every frame
+    // (their primitives must be up-to-date, see FView::updatePrimitivesLod())
+    static uint64_t getCastersHash(
+            FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> range,
+            FScene::VisibleMaskType visibilityMask) noexcept;
+
+    // hash of what's rendered in the layer of the shadow map, 0 if it must always be rendered
+    static uint64_t getContentHash(ShadowMap const& shadowMap, uint64_t castersHash) noexcept;
+
     static void updateSpotVisibilityMasks(
             uint8_t visibleLayers,
             uint8_t const* UTILS_RESTRICT layers,
@@ -219,6 +235,27 @@ private:
         backend::TextureFormat format = backend::TextureFormat::DEPTH16;
     } mTextureAtlasRequirements;
 
+    // When caching is enabled, the atlas is kept across frames and a layer is rendered again
+    // only when the hash of its content changed.
+    struct ShadowMapCache {
+        backend::Handle<backend::HwTexture> atlas;
+        TextureAtlasRequirements requirements;      // of the atlas
+        uint32_t generation = 0;                    // see FView::invalidateShadowMapCache()
+        std::array<uint64_t, CONFIG_MAX_SHADOW_LAYERS> layers{}; // content hashes, 0 if invalid
+        std::array<uint64_t, CONFIG_MAX_SHADOW_LAYERS> previousLayers{};
+
+        // starts a frame, the layers of the previous frame are kept only if the atlas still
+        // holds them and the cache wasn't invalidated since
+        void beginFrame(bool atlasValid, uint32_t viewGeneration) noexcept;
+
+        // records the content hash of a layer rendered this frame, returns true if the layer
+        // already holds this content so it doesn't need to be rendered
+        bool reuse(size_t layer, uint64_t contentHash) noexcept;
+    } mCache;
+
+    friend class ::FilamentTest_ShadowMapCache_Test;
+    friend class ::FilamentTest_ShadowMapCacheRendering_Test;
+
     SoftShadowOptions mSoftShadowOptions;
 
     mutable TypedUniformBuffer<ShadowUib> mShadowUb;
@@ -209,6 +209,18 @@ SoftShadowOptions View::getSoftShadowOptions() const noexcept {
     return downcast(this)->getSoftShadowOptions();
 }
 
+void View::setShadowMapCachingEnabled(bool enabled) noexcept {
+    downcast(this)->setShadowMapCachingEnabled(enabled);
+}
+
+bool View::isShadowMapCachingEnabled() const noexcept {
+    return downcast(this)->isShadowMapCachingEnabled();
+}
+
+void View::invalidateShadowMapCache() noexcept {
+    downcast(this)->invalidateShadowMapCache();
+}
+
 void View::setAmbientOcclusion(View::AmbientOcclusion ambientOcclusion) noexcept {
     downcast(this)->setAmbientOcclusion(ambientOcclusion);
 }
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_COMPONENTS_INSTANCECHANGELOG_H
+#define TNT_FILAMENT_COMPONENTS_INSTANCECHANGELOG_H
+
+#include <utils/compiler.h>
+#include <utils/Entity.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+
+/*
+ * Records the entities whose instance changed in a component manager, i.e. whose component was
+ * created, destroyed or moved within the manager's arrays.
+ * A cache of instances (e.g. FScene's) remembers the sequence number it's up-to-date with and
+ * replays the changes since then. The log is bounded, a cache that fell too far behind must
+ * gather all its instances again.
+ */
+class InstanceChangeLog {
+public:
+    static constexpr size_t CAPACITY = 4096;
+
+    void record(utils::Entity e) noexcept {
+        if (UTILS_UNLIKELY(mEntities.size() == CAPACITY)) {
+            mFirst += mEntities.size();
+            mEntities.clear();
+        }
+        mEntities.push_back(e);
+    }
+
+    // sequence number of the next change
+    uint64_t getSequence() const noexcept {
+        return mFirst + mEntities.size();
+    }
+
+    // calls functor(entity) for each change since sequence, returns false if they're lost
+    template<typename F>
+    bool forEachSince(uint64_t sequence, F&& functor) const noexcept {
+        if (sequence < mFirst) {
+            return false;
+        }
+        for (size_t i = size_t(sequence - mFirst), c = mEntities.size(); i < c; i++) {
+            functor(mEntities[i]);
+        }
+        return true;
+    }
+
+private:
+    std::vector<utils::Entity> mEntities;
+    uint64_t mFirst = 0;    // sequence number of mEntities[0]
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_COMPONENTS_INSTANCECHANGELOG_H
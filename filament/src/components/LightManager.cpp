@@ -175,6 +175,7 @@ void FLightManager::create(const FLightManager::Builder& builder, utils::Entity
     }
     Instance const i = manager.addComponent(entity);
     assert_invariant(i);
+    mInstanceChanges.record(entity);
 
     if (i) {
         // This needs to happen before we call the set() methods below
@@ -210,7 +211,11 @@ void FLightManager::destroy(utils::Entity e) noexcept {
     Instance const i = getInstance(e);
     if (i) {
         auto& manager = mManager;
-        manager.removeComponent(e);
+        Instance const moved = manager.removeComponent(e);
+        mInstanceChanges.record(e);
+        if (moved != i) {
+            mInstanceChanges.record(manager.getEntity(i));
+        }
     }
 }
 
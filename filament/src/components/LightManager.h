@@ -19,6 +19,8 @@
 
 #include "downcast.h"
 
+#include "components/InstanceChangeLog.h"
+
 #include "backend/DriverApiForward.h"
 
 #include <filament/LightManager.h>
@@ -70,6 +72,11 @@ public:
         return mManager.getEntity(i);
     }
 
+    // entities whose instance changed, see FScene::prepare()
+    InstanceChangeLog const& getInstanceChanges() const noexcept {
+        return mInstanceChanges;
+    }
+
     utils::Entity const* getEntities() const noexcept {
         return mManager.getEntities();
     }
@@ -310,6 +317,7 @@ private:
 
     Sim mManager;
     FEngine& mEngine;
+    InstanceChangeLog mInstanceChanges;
 };
 
 FILAMENT_DOWNCAST(LightManager)
@@ -550,6 +550,7 @@ void FRenderableManager::create(
     }
     Instance const ci = manager.addComponent(entity);
     assert_invariant(ci);
+    mInstanceChanges.record(entity);
 
     if (ci) {
         // create and initialize all needed RenderPrimitives
@@ -713,7 +714,11 @@ void FRenderableManager::destroy(utils::Entity e) noexcept {
     Instance const ci = getInstance(e);
     if (ci) {
         destroyComponent(ci);
-        mManager.removeComponent(e);
+        Instance const moved = mManager.removeComponent(e);
+        mInstanceChanges.record(e);
+        if (moved != ci) {
+            mInstanceChanges.record(mManager.getEntity(ci));
+        }
     }
 }
 
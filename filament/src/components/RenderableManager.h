@@ -21,6 +21,8 @@
 
 #include "HwRenderPrimitiveFactory.h"
 
+#include "components/InstanceChangeLog.h"
+
 #include <details/InstanceBuffer.h>
 
 #include <filament/Box.h>
@@ -112,6 +114,11 @@ public:
         return mManager.getEntity(i);
     }
 
+    // entities whose instance changed, see FScene::prepare()
+    InstanceChangeLog const& getInstanceChanges() const noexcept {
+        return mInstanceChanges;
+    }
+
     utils::Entity const* getEntities() const noexcept {
         return mManager.getEntities();
     }
@@ -292,6 +299,7 @@ private:
     Sim mManager;
     FEngine& mEngine;
     HwRenderPrimitiveFactory mHwRenderPrimitiveFactory;
+    InstanceChangeLog mInstanceChanges;
 };
 
 FILAMENT_DOWNCAST(RenderableManager)
@@ -19,8 +19,12 @@
 #include <math/mat4.h>
 
 #include <utils/debug.h>
+#include <utils/JobSystem.h>
 #include <filament/TransformManager.h>
 
+#include <algorithm>
+#include <functional>
+
 
 using namespace utils;
 using namespace filament::math;
@@ -38,8 +42,12 @@ void FTransformManager::setAccurateTranslationsEnabled(bool enable) noexcept {
     if (enable != mAccurateTranslations) {
         mAccurateTranslations = enable;
         // when enabling accurate translations, we have to recompute all world transforms
-        if (enable && !mLocalTransformTransactionOpen) {
-            computeAllWorldTransforms();
+        if (enable) {
+            if (!mLocalTransformTransactionOpen) {
+                computeAllWorldTransforms();
+            } else {
+                mAllDirty = true;
+            }
         }
     }
 }
@@ -59,12 +67,14 @@ void FTransformManager::create(Entity entity, Instance parent, const mat4f& loca
     Instance const i = manager.addComponent(entity);
     assert_invariant(i);
     assert_invariant(i != parent);
+    mInstanceChanges.record(entity);
 
     if (i && i != parent) {
         manager[i].parent = 0;
         manager[i].next = 0;
         manager[i].prev = 0;
         manager[i].firstChild = 0;
+        manager[i].dirty = false;
         insertNode(i, parent);
         setTransform(i, localTransform);
     }
@@ -81,12 +91,14 @@ void FTransformManager::create(Entity entity, Instance parent, const mat4& local
     Instance const i = manager.addComponent(entity);
     assert_invariant(i);
     assert_invariant(i != parent);
+    mInstanceChanges.record(entity);
 
     if (i && i != parent) {
         manager[i].parent = 0;
         manager[i].next = 0;
         manager[i].prev = 0;
         manager[i].firstChild = 0;
+        manager[i].dirty = false;
         insertNode(i, parent);
         setTransform(i, localTransform);
     }
@@ -101,6 +113,8 @@ void FTransformManager::setParent(Instance i, Instance parent) noexcept {
             // TODO: on debug builds, ensure that the new parent isn't one of our descendant
             removeNode(i);
             insertNode(i, parent);
+            // the next commit puts the child back after its parent
+            mNeedsReorder = mNeedsReorder || parent > i;
             updateNodeTransform(i);
             // Note: setParent() doesn't reorder the child after the parent in the array,
             // but that's not a problem because TransformManager doesn't rely on that.
@@ -154,15 +168,27 @@ void FTransformManager::destroy(Entity e) noexcept {
         Instance child = manager[i].firstChild;
         while (child) {
             manager[child].parent = 0;
+            if (UTILS_UNLIKELY(mLocalTransformTransactionOpen)) {
+                markDirty(child);
+            }
             child = manager[child].next;
         }
 
         // 2) remove the component
         Instance const moved = manager.removeComponent(e);
+        mInstanceChanges.record(e);
 
         // 3) update the references to the entry now with Instance i
         if (moved != i) {
+            mInstanceChanges.record(manager.getEntity(i));
             updateNode(i);
+            // the last node took our place, which can be before its parent or after a child
+            Instance const parent = manager[i].parent;
+            bool misplaced = parent > i;
+            for (Instance c = manager[i].firstChild; c && !misplaced; c = manager[c].next) {
+                misplaced = c < i;
+            }
+            mNeedsReorder = mNeedsReorder || misplaced;
         }
     }
 }
@@ -191,6 +217,7 @@ void FTransformManager::setTransform(Instance ci, const mat4& model) noexcept {
 
 void FTransformManager::updateNodeTransform(Instance i) noexcept {
     if (UTILS_UNLIKELY(mLocalTransformTransactionOpen)) {
+        markDirty(i);
         return;
     }
 
@@ -215,13 +242,43 @@ void FTransformManager::updateNodeTransform(Instance i) noexcept {
 }
 
 void FTransformManager::openLocalTransformTransaction() noexcept {
-    mLocalTransformTransactionOpen = true;
+    if (!mLocalTransformTransactionOpen) {
+        mLocalTransformTransactionOpen = true;
+        // markDirty() can't grow the list (it's called concurrently), so make room for every
+        // existing node, plus some for the nodes created during the transaction.
+        size_t const count = mManager.getComponentCount();
+        if (mDirtyEntities.size() < count + 1) {
+            mDirtyEntities.resize(count + count / 4 + 64);
+        }
+        mDirtyCount.store(0, std::memory_order_relaxed);
+    }
 }
 
 void FTransformManager::commitLocalTransformTransaction() noexcept {
     if (mLocalTransformTransactionOpen) {
         mLocalTransformTransactionOpen = false;
-        computeAllWorldTransforms();
+        if (mAllDirty || mNeedsReorder ||
+                mDirtyCount.load(std::memory_order_relaxed) > mDirtyEntities.size()) {
+            computeAllWorldTransforms();
+        } else {
+            computeDirtyWorldTransforms();
+        }
+        mDirtyCount.store(0, std::memory_order_relaxed);
+        mAllDirty = false;
+        mNeedsReorder = false;
+    }
+}
+
+void FTransformManager::markDirty(Instance i) noexcept {
+    // this is called concurrently for *different* instances, each node is appended only once
+    auto& manager = mManager;
+    if (!manager[i].dirty) {
+        manager[i].dirty = true;
+        uint32_t const index = mDirtyCount.fetch_add(1, std::memory_order_relaxed);
+        // if the list overflows, the commit recomputes all world transforms
+        if (UTILS_LIKELY(index < mDirtyEntities.size())) {
+            mDirtyEntities[index] = manager.getEntity(i);
+        }
     }
 }
 
@@ -246,6 +303,80 @@ void FTransformManager::computeAllWorldTransforms() noexcept {
                 manager[parent].world, manager[i].local,
                 manager[parent].worldTranslationLo, manager[i].localTranslationLo,
                 accurate);
+        manager[i].dirty = false;
+    }
+}
+
+void FTransformManager::computeDirtyWorldTransforms() noexcept {
+    auto& manager = mManager;
+    uint32_t const count = mDirtyCount.load(std::memory_order_relaxed);
+    if (!count) {
+        return;
+    }
+
+    // 1) resolve the marked entities, skipping the destroyed ones. An entity destroyed and
+    //    created again can be listed twice, the flag is set to 2 once the node is collected.
+    auto& dirty = mDirtyInstances;
+    dirty.clear();
+    for (uint32_t k = 0; k < count; k++) {
+        Instance const i = manager.getInstance(mDirtyEntities[k]);
+        if (i && manager[i].dirty == 1) {
+            manager[i].dirty = 2;
+            dirty.push_back(i);
+        }
+    }
+
+    // 2) the roots of the update are the nodes without a dirty ancestor, their subtrees
+    //    contain every other dirty node
+    auto& level = mLevel;
+    level.clear();
+    for (Instance const i : dirty) {
+        Instance parent = manager[i].parent;
+        while (parent && !manager[parent].dirty) {
+            parent = manager[parent].parent;
+        }
+        if (!parent) {
+            level.push_back(i);
+        }
+    }
+    for (Instance const i : dirty) {
+        manager[i].dirty = false;
+    }
+
+    // 3) update one level of the subtrees at a time, a level only depends on the previous one
+    //    so each is split across the JobSystem when it's large enough
+    const bool accurate = mAccurateTranslations;
+    auto update = [&manager, accurate](Instance const* instances, uint32_t n) {
+        for (uint32_t k = 0; k < n; k++) {
+            Instance const i = instances[k];
+            Instance const parent = manager[i].parent;
+            FTransformManager::computeWorldTransform(
+                    manager[i].world, manager[i].worldTranslationLo,
+                    manager[parent].world, manager[i].local,
+                    manager[parent].worldTranslationLo, manager[i].localTranslationLo,
+                    accurate);
+        }
+    };
+
+    auto& next = mNextLevel;
+    while (!level.empty()) {
+        uint32_t const n = uint32_t(level.size());
+        if (mJobSystem && n >= 1024) {
+            JobSystem& js = *mJobSystem;
+            auto* job = jobs::parallel_for(js, nullptr, level.data(), n,
+                    std::cref(update), jobs::CountSplitter<256>());
+            js.runAndWait(job);
+        } else {
+            update(level.data(), n);
+        }
+
+        next.clear();
+        for (Instance const i : level) {
+            for (Instance c = manager[i].firstChild; c; c = manager[c].next) {
+                next.push_back(c);
+            }
+        }
+        std::swap(level, next);
     }
 }
 
@@ -285,7 +416,10 @@ void FTransformManager::swapNode(Instance i, Instance j) noexcept {
     std::swap(manager.elementAt<LOCAL_LO>(i), manager.elementAt<LOCAL_LO>(j));
     std::swap(manager.elementAt<WORLD>(i),    manager.elementAt<WORLD>(j));
     std::swap(manager.elementAt<WORLD_LO>(i), manager.elementAt<WORLD_LO>(j));
+    std::swap(manager.elementAt<DIRTY>(i),    manager.elementAt<DIRTY>(j));
     manager.swap(i, j); // this swaps the data relative to SingleInstanceComponentManager
+    mInstanceChanges.record(manager.getEntity(i));
+    mInstanceChanges.record(manager.getEntity(j));
 
     // now swap the linked-list references, to do that correctly we must use a temporary
     // node to fix-up the linked-list pointers
@@ -19,15 +19,23 @@
 
 #include "downcast.h"
 
+#include "components/InstanceChangeLog.h"
+
 #include <filament/TransformManager.h>
 
 #include <utils/compiler.h>
 #include <utils/SingleInstanceComponentManager.h>
 #include <utils/Entity.h>
+#include <utils/JobSystem.h>
 #include <utils/Slice.h>
 
 #include <math/mat4.h>
 
+#include <atomic>
+#include <vector>
+
+#include <stdint.h>
+
 namespace filament {
 
 class UTILS_PRIVATE FTransformManager : public TransformManager {
@@ -40,6 +48,11 @@ public:
     // free-up all resources
     void terminate() noexcept;
 
+    // large hierarchies are updated in parallel on this JobSystem when a transaction is committed
+    void setJobSystem(utils::JobSystem* js) noexcept {
+        mJobSystem = js;
+    }
+
 
     /*
     * Component Manager APIs
@@ -65,6 +78,11 @@ public:
         return mManager.getEntity(i);
     }
 
+    // entities whose instance changed, see FScene::prepare()
+    InstanceChangeLog const& getInstanceChanges() const noexcept {
+        return mInstanceChanges;
+    }
+
     utils::Entity const* getEntities() const noexcept {
         return mManager.getEntities();
     }
@@ -144,7 +162,9 @@ private:
     void swapNode(Instance i, Instance j) noexcept;
     void transformChildren(Sim& manager, Instance firstChild) noexcept;
 
+    void markDirty(Instance i) noexcept;
     void computeAllWorldTransforms() noexcept;
+    void computeDirtyWorldTransforms() noexcept;
 
     static void computeWorldTransform(math::mat4f& outWorld, math::float3& inoutWorldTranslationLo,
             math::mat4f const& pt, math::mat4f const& local,
@@ -162,6 +182,7 @@ private:
         FIRST_CHILD,    // instance to our first child
         NEXT,           // instance to our next sibling
         PREV,           // instance to our previous sibling
+        DIRTY,          // local transform changed during the current transaction
     };
 
     using Base = utils::SingleInstanceComponentManager<
@@ -172,7 +193,8 @@ private:
             Instance,       // parent
             Instance,       // firstChild
             Instance,       // next
-            Instance        // prev
+            Instance,       // prev
+            uint8_t         // dirty
     >;
 
     struct Sim : public Base {
@@ -197,6 +219,7 @@ private:
                 Field<FIRST_CHILD>  firstChild;
                 Field<NEXT>         next;
                 Field<PREV>         prev;
+                Field<DIRTY>        dirty;
             };
         };
 
@@ -211,6 +234,20 @@ private:
     Sim mManager;
     bool mLocalTransformTransactionOpen = false;
     bool mAccurateTranslations = false;
+
+    // nodes marked during the open transaction, setTransform() can be called concurrently
+    // for different instances so entries are appended with an atomic counter
+    std::vector<utils::Entity> mDirtyEntities;
+    std::atomic<uint32_t> mDirtyCount{ 0 };
+    bool mAllDirty = false;         // the commit must recompute every world transform
+    bool mNeedsReorder = false;     // a child may be stored before its parent
+    utils::JobSystem* mJobSystem = nullptr;
+    InstanceChangeLog mInstanceChanges;
+
+    // scratch storage of commitLocalTransformTransaction()
+    std::vector<Instance> mDirtyInstances;
+    std::vector<Instance> mLevel;
+    std::vector<Instance> mNextLevel;
 };
 
 FILAMENT_DOWNCAST(TransformManager)
@@ -224,6 +224,7 @@ FEngine::FEngine(Engine::Builder const& builder) :
     // we're assuming we're on the main thread here.
     // (it may not be the case)
     mJobSystem.adopt();
+    mTransformManager.setJobSystem(&mJobSystem);
 
     slog.i << "FEngine (" << sizeof(void*) * 8 << " bits) created at " << this << " "
            << "(threading is " << (UTILS_HAS_THREADING ? "enabled)" : "disabled)") << io::endl;
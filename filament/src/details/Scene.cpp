@@ -47,80 +47,160 @@ namespace filament {
 
 FScene::FScene(FEngine& engine) :
         mEngine(engine), mSharedState(std::make_shared<SharedState>()) {
+    engine.getEntityManager().registerListener(&mDestroyedEntities);
 }
 
 FScene::~FScene() noexcept = default;
 
+FScene::DestroyedEntities::~DestroyedEntities() noexcept = default;
+
+void FScene::DestroyedEntities::onEntitiesDestroyed(size_t n, Entity const* entities) noexcept {
+    std::lock_guard<Mutex> const lock(mLock);
+    if (mOverflow || mEntities.size() + n > CAPACITY) {
+        // the scene will gather all its instances again
+        mOverflow = true;
+        mEntities.clear();
+        return;
+    }
+    mEntities.insert(mEntities.end(), entities, entities + n);
+}
+
+bool FScene::DestroyedEntities::consume(std::vector<Entity>& entities) noexcept {
+    entities.clear();
+    std::lock_guard<Mutex> const lock(mLock);
+    std::swap(entities, mEntities);
+    bool const overflow = mOverflow;
+    mOverflow = false;
+    return !overflow;
+}
+
+void FScene::updateRows() noexcept {
+    FEngine& engine = mEngine;
+    InstanceChangeLog const& renderableChanges = engine.getRenderableManager().getInstanceChanges();
+    InstanceChangeLog const& lightChanges = engine.getLightManager().getInstanceChanges();
+    InstanceChangeLog const& transformChanges = engine.getTransformManager().getInstanceChanges();
+
+    bool valid = mDestroyedEntities.consume(mDestroyedScratch) && mRowsValid;
+    if (valid) {
+        // gather again the entities of the scene that changed in any of the managers
+        auto const update = [this](Entity e) {
+            if (mEntities.find(e) != mEntities.end()) {
+                removeRows(e);
+                addRows(e);
+            }
+        };
+        valid = renderableChanges.forEachSince(mRenderableSequence, update) &&
+                lightChanges.forEachSince(mLightSequence, update) &&
+                transformChanges.forEachSince(mTransformSequence, update);
+    }
+    if (valid) {
+        for (Entity const e : mDestroyedScratch) {
+            removeRows(e);
+        }
+    } else {
+        mRenderableRows.clear();
+        mLightRows.clear();
+        mDirectionalLightRows.clear();
+        mEntityRows.clear();
+        for (Entity const e : mEntities) {
+            addRows(e);
+        }
+    }
+
+    mRenderableSequence = renderableChanges.getSequence();
+    mLightSequence = lightChanges.getSequence();
+    mTransformSequence = transformChanges.getSequence();
+    mRowsValid = true;
+}
+
+void FScene::addRows(Entity e) noexcept {
+    FEngine& engine = mEngine;
+    if (UTILS_UNLIKELY(!engine.getEntityManager().isAlive(e))) {
+        return;
+    }
+    FLightManager const& lcm = engine.getLightManager();
+    auto const ti = engine.getTransformManager().getInstance(e);
+    auto const li = lcm.getInstance(e);
+    auto const ri = engine.getRenderableManager().getInstance(e);
+    if (!li && !ri) {
+        return;
+    }
+    EntityRows rows;
+    if (ri) {
+        rows.renderable = uint32_t(mRenderableRows.size());
+        mRenderableRows.push_back({ ri, ti, e });
+    }
+    if (li) {
+        // we handle the directional lights separately because only the brightest one is used
+        rows.directional = lcm.isDirectionalLight(li);
+        auto& lightRows = rows.directional ? mDirectionalLightRows : mLightRows;
+        rows.light = uint32_t(lightRows.size());
+        lightRows.push_back({ li, ti, e });
+    }
+    mEntityRows[e] = rows;
+}
+
+void FScene::removeRows(Entity e) noexcept {
+    auto const pos = mEntityRows.find(e);
+    if (pos == mEntityRows.end()) {
+        return;
+    }
+    EntityRows const rows = pos->second;
+    mEntityRows.erase(pos);
+    if (rows.renderable != EntityRows::NONE) {
+        eraseRow(mRenderableRows, rows.renderable, &EntityRows::renderable);
+    }
+    if (rows.light != EntityRows::NONE) {
+        eraseRow(rows.directional ? mDirectionalLightRows : mLightRows,
+                rows.light, &EntityRows::light);
+    }
+}
+
+template<typename Row>
+void FScene::eraseRow(std::vector<Row>& rows, uint32_t index, uint32_t EntityRows::* field) noexcept {
+    // the last row takes the place of the erased one
+    if (index + 1 != rows.size()) {
+        rows[index] = rows.back();
+        mEntityRows[rows[index].entity].*field = index;
+    }
+    rows.pop_back();
+}
+
 
 void FScene::prepare(utils::JobSystem& js,
-        RootArenaScope& rootArenaScope,
+        RootArenaScope&,
         mat4 const& worldTransform,
         bool shadowReceiversAreCasters) noexcept {
-    // TODO: can we skip this in most cases? Since we rely on indices staying the same,
-    //       we could only skip, if nothing changed in the RCM.
-
     SYSTRACE_CALL();
 
     SYSTRACE_CONTEXT();
 
-    // This will reset the allocator upon exiting
-    ArenaScope<RootArenaScope::Arena> localArenaScope(rootArenaScope.getArena());
-
     FEngine& engine = mEngine;
-    EntityManager const& em = engine.getEntityManager();
     FRenderableManager const& rcm = engine.getRenderableManager();
     FTransformManager const& tcm = engine.getTransformManager();
     FLightManager const& lcm = engine.getLightManager();
-    // go through the list of entities, and gather the data of those that are renderables
     auto& sceneData = mRenderableData;
     auto& lightData = mLightData;
     auto const& entities = mEntities;
 
-    using RenderableContainerData = std::pair<RenderableManager::Instance, TransformManager::Instance>;
-    using RenderableInstanceContainer = FixedCapacityVector<RenderableContainerData,
-            utils::STLAllocator< RenderableContainerData, LinearAllocatorArena >, false>;
-
-    using LightContainerData = std::pair<LightManager::Instance, TransformManager::Instance>;
-    using LightInstanceContainer = FixedCapacityVector<LightContainerData,
-            utils::STLAllocator< LightContainerData, LinearAllocatorArena >, false>;
-
-    RenderableInstanceContainer renderableInstances{
-            RenderableInstanceContainer::with_capacity(entities.size(), localArenaScope.getArena()) };
-
-    LightInstanceContainer lightInstances{
-            LightInstanceContainer::with_capacity(entities.size(), localArenaScope.getArena()) };
-
     SYSTRACE_NAME_BEGIN("InstanceLoop");
 
-    // find the max intensity directional light index in our local array
-    float maxIntensity = 0.0f;
-    std::pair<LightManager::Instance, TransformManager::Instance> directionalLightInstances{};
-
     /*
-     * First compute the exact number of renderables and lights in the scene.
-     * Also find the main directional light.
+     * Bring the instances of our renderables and lights up-to-date, only the entities that
+     * changed since the last frame are looked up again.
      */
 
-    for (Entity const e: entities) {
-        if (UTILS_LIKELY(em.isAlive(e))) {
-            auto ti = tcm.getInstance(e);
-            auto li = lcm.getInstance(e);
-            auto ri = rcm.getInstance(e);
-            if (li) {
-                // we handle the directional light here because it'd prevent multithreading below
-                if (UTILS_UNLIKELY(lcm.isDirectionalLight(li))) {
-                    // we don't store the directional lights, because we only have a single one
-                    if (lcm.getIntensity(li) >= maxIntensity) {
-                        maxIntensity = lcm.getIntensity(li);
-                        directionalLightInstances = { li, ti };
-                    }
-                } else {
-                    lightInstances.emplace_back(li, ti);
-                }
-            }
-            if (ri) {
-                renderableInstances.emplace_back(ri, ti);
-            }
+    updateRows();
+    auto& renderableInstances = mRenderableRows;
+    auto& lightInstances = mLightRows;
+
+    // find the max intensity directional light
+    float maxIntensity = 0.0f;
+    std::pair<LightManager::Instance, TransformManager::Instance> directionalLightInstances{};
+    for (LightRow const& row : mDirectionalLightRows) {
+        if (lcm.getIntensity(row.light) >= maxIntensity) {
+            maxIntensity = lcm.getIntensity(row.light);
+            directionalLightInstances = { row.light, row.transform };
         }
     }
 
@@ -175,7 +255,8 @@ void FScene::prepare(utils::JobSystem& js,
         SYSTRACE_NAME("renderableWork");
 
         for (size_t i = 0; i < c; i++) {
-            auto [ri, ti] = p[i];
+            auto const ri = p[i].renderable;
+            auto const ti = p[i].transform;
 
             // this is where we go from double to float for our transforms
             const mat4f shaderWorldTransform{
@@ -222,7 +303,8 @@ void FScene::prepare(utils::JobSystem& js,
             &lightData](auto* p, auto c) {
         SYSTRACE_NAME("lightWork");
         for (size_t i = 0; i < c; i++) {
-            auto [li, ti] = p[i];
+            auto const li = p[i].light;
+            auto const ti = p[i].transform;
             // this is where we go from double to float for our transforms
             mat4f const shaderWorldTransform{
                     worldTransform * tcm.getWorldTransformAccurate(ti) };
@@ -323,6 +405,27 @@ void FScene::prepare(utils::JobSystem& js,
 
     js.runAndWait(rootJob);
 
+    /*
+     * Apply the overridden world transforms
+     */
+
+    for (size_t i = 0, c = mOverriddenEntities.size(); i < c; i++) {
+        auto const pos = mEntityRows.find(mOverriddenEntities[i]);
+        if (pos == mEntityRows.end() || pos->second.renderable == EntityRows::NONE) {
+            continue;
+        }
+        size_t const index = pos->second.renderable;
+        assert_invariant(index < sceneData.size());
+        const mat4f shaderWorldTransform{ worldTransform * mOverriddenTransforms[i] };
+        const Box worldAABB = rigidTransform(
+                rcm.getAABB(renderableInstances[index].renderable), shaderWorldTransform);
+        sceneData.elementAt<WORLD_TRANSFORM>(index) = shaderWorldTransform;
+        sceneData.elementAt<VISIBILITY_STATE>(index).reversedWindingOrder =
+                det(shaderWorldTransform.upperLeft()) < 0;
+        sceneData.elementAt<WORLD_AABB_CENTER>(index) = worldAABB.center;
+        sceneData.elementAt<WORLD_AABB_EXTENT>(index) = worldAABB.halfExtent;
+    }
+
     SYSTRACE_NAME_END();
 }
 
@@ -441,7 +544,8 @@ void FScene::updateUBOs(
     }, 0);
 }
 
-void FScene::terminate(FEngine&) {
+void FScene::terminate(FEngine& engine) {
+    engine.getEntityManager().unregisterListener(&mDestroyedEntities);
 }
 
 void FScene::prepareDynamicLights(const CameraInfo& camera,
@@ -526,17 +630,23 @@ inline void FScene::computeLightRanges(
 
 UTILS_NOINLINE
 void FScene::addEntity(Entity entity) {
-    mEntities.insert(entity);
+    if (mEntities.insert(entity).second && mRowsValid) {
+        addRows(entity);
+    }
 }
 
 UTILS_NOINLINE
 void FScene::addEntities(const Entity* entities, size_t count) {
-    mEntities.insert(entities, entities + count);
+    for (size_t i = 0; i < count; ++i, ++entities) {
+        addEntity(*entities);
+    }
 }
 
 UTILS_NOINLINE
 void FScene::remove(Entity entity) {
-    mEntities.erase(entity);
+    if (mEntities.erase(entity)) {
+        removeRows(entity);
+    }
 }
 
 UTILS_NOINLINE
@@ -617,4 +727,10 @@ void FScene::forEach(Invocable<void(Entity)>&& functor) const noexcept {
     std::for_each(mEntities.begin(), mEntities.end(), std::move(functor));
 }
 
+void FScene::setWorldTransformOverrides(const Entity* entities, const mat4* transforms,
+        size_t count) noexcept {
+    mOverriddenEntities.assign(entities, entities + count);
+    mOverriddenTransforms.assign(transforms, transforms + count);
+}
+
 } // namespace filament
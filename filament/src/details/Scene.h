@@ -31,10 +31,13 @@
 #include <filament/Box.h>
 #include <filament/Scene.h>
 
+#include <math/mat4.h>
 #include <math/mathfwd.h>
 
 #include <utils/compiler.h>
 #include <utils/Entity.h>
+#include <utils/EntityManager.h>
+#include <utils/Mutex.h>
 #include <utils/Slice.h>
 #include <utils/StructureOfArrays.h>
 #include <utils/Range.h>
@@ -42,9 +45,13 @@
 
 #include <stddef.h>
 
+#include <tsl/robin_map.h>
 #include <tsl/robin_set.h>
 
 #include <memory>
+#include <vector>
+
+class SceneTest_IncrementalGather_Test;
 
 namespace filament {
 
@@ -189,6 +196,7 @@ public:
 
 private:
     friend class Scene;
+    friend class ::SceneTest_IncrementalGather_Test;
     void setSkybox(FSkybox* skybox) noexcept;
     void setIndirectLight(FIndirectLight* ibl) noexcept { mIndirectLight = ibl; }
     void addEntity(utils::Entity entity);
@@ -200,10 +208,50 @@ private:
     size_t getLightCount() const noexcept;
     bool hasEntity(utils::Entity entity) const noexcept;
     void forEach(utils::Invocable<void(utils::Entity)>&& functor) const noexcept;
+    void setWorldTransformOverrides(const utils::Entity* entities, const math::mat4* transforms,
+            size_t count) noexcept;
 
     static inline void computeLightRanges(math::float2* zrange,
             CameraInfo const& camera, const math::float4* spheres, size_t count) noexcept;
 
+    // rows of the instances gathered from the component managers, for each entity of the scene
+    struct RenderableRow {
+        RenderableManager::Instance renderable;
+        TransformManager::Instance transform;
+        utils::Entity entity;
+    };
+    struct LightRow {
+        LightManager::Instance light;
+        TransformManager::Instance transform;
+        utils::Entity entity;
+    };
+    struct EntityRows {
+        static constexpr uint32_t NONE = ~0u;
+        uint32_t renderable = NONE;     // index in mRenderableRows
+        uint32_t light = NONE;          // index in mLightRows or mDirectionalLightRows
+        bool directional = false;
+    };
+
+    // entities destroyed by the EntityManager (from any thread) since the last prepare()
+    class DestroyedEntities : public utils::EntityManager::Listener {
+    public:
+        static constexpr size_t CAPACITY = 65536;
+        ~DestroyedEntities() noexcept override;
+        void onEntitiesDestroyed(size_t n, utils::Entity const* entities) noexcept override;
+        // returns false if too many were destroyed to keep track of them
+        bool consume(std::vector<utils::Entity>& entities) noexcept;
+    private:
+        utils::Mutex mLock;
+        std::vector<utils::Entity> mEntities;
+        bool mOverflow = false;
+    };
+
+    void updateRows() noexcept;
+    void addRows(utils::Entity entity) noexcept;
+    void removeRows(utils::Entity entity) noexcept;
+    template<typename Row>
+    void eraseRow(std::vector<Row>& rows, uint32_t index, uint32_t EntityRows::* field) noexcept;
+
     FEngine& mEngine;
     FSkybox* mSkybox = nullptr;
     FIndirectLight* mIndirectLight = nullptr;
@@ -215,6 +263,26 @@ private:
      */
     tsl::robin_set<utils::Entity, utils::Entity::Hasher> mEntities;
 
+    /*
+     * The renderable and light instances of mEntities, kept up-to-date with the change logs of
+     * the component managers (see updateRows()), so that prepare() doesn't have to look up
+     * every entity of the scene each frame.
+     */
+    std::vector<RenderableRow> mRenderableRows;
+    std::vector<LightRow> mLightRows;
+    std::vector<LightRow> mDirectionalLightRows;
+    tsl::robin_map<utils::Entity, EntityRows, utils::Entity::Hasher> mEntityRows;
+    uint64_t mRenderableSequence = 0;
+    uint64_t mLightSequence = 0;
+    uint64_t mTransformSequence = 0;
+    bool mRowsValid = false;
+    DestroyedEntities mDestroyedEntities;
+    std::vector<utils::Entity> mDestroyedScratch;
+
+    // world transforms used instead of the TransformManager's (see setWorldTransformOverrides())
+    std::vector<utils::Entity> mOverriddenEntities;
+    std::vector<math::mat4> mOverriddenTransforms;
+
 
     /*
      * The data below is valid only during a view pass. i.e. if a scene is used in multiple
@@ -206,6 +206,11 @@ public:
         return mShadowMapManager->getDirectionalShadowCamera();
     }
 
+    // for testing only
+    ShadowMapManager const* getShadowMapManager() const noexcept {
+        return mShadowMapManager.get();
+    }
+
     void setRenderTarget(FRenderTarget* renderTarget) noexcept {
         assert_invariant(!renderTarget || !mMultiSampleAntiAliasingOptions.enabled ||
                 !renderTarget->hasSampleableDepth());
@@ -337,6 +342,23 @@ public:
         return mSoftShadowOptions;
     }
 
+    void setShadowMapCachingEnabled(bool enabled) noexcept {
+        mShadowMapCaching = enabled;
+    }
+
+    bool isShadowMapCachingEnabled() const noexcept {
+        return mShadowMapCaching;
+    }
+
+    // incremented by invalidateShadowMapCache(), see ShadowMapManager::render()
+    void invalidateShadowMapCache() noexcept {
+        mShadowMapCacheGeneration++;
+    }
+
+    uint32_t getShadowMapCacheGeneration() const noexcept {
+        return mShadowMapCacheGeneration;
+    }
+
     AmbientOcclusionOptions const& getAmbientOcclusionOptions() const noexcept {
         return mAmbientOcclusionOptions;
     }
@@ -526,6 +548,8 @@ private:
     ShadowType mShadowType = ShadowType::PCF;
     VsmShadowOptions mVsmShadowOptions; // FIXME: this should probably be per-light
     SoftShadowOptions mSoftShadowOptions;
+    bool mShadowMapCaching = false;
+    uint32_t mShadowMapCacheGeneration = 0;
     BloomOptions mBloomOptions;
     FogOptions mFogOptions;
     DepthOfFieldOptions mDepthOfFieldOptions;
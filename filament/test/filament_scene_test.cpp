@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <filament/Box.h>
+#include <filament/Engine.h>
+#include <filament/LightManager.h>
+#include <filament/RenderableManager.h>
+#include <filament/Scene.h>
+#include <filament/TransformManager.h>
+
+#include "Allocators.h"
+#include "details/Engine.h"
+#include "details/Scene.h"
+#include "components/InstanceChangeLog.h"
+#include "components/LightManager.h"
+#include "components/RenderableManager.h"
+#include "components/TransformManager.h"
+
+#include <utils/Entity.h>
+#include <utils/EntityManager.h>
+
+#include <math/mat4.h>
+#include <math/vec3.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+using namespace filament;
+using namespace filament::math;
+using namespace utils;
+
+static ::testing::AssertionResult MatricesEqual(mat4f const& expected, mat4f const& actual) {
+    for (size_t i = 0; i < 4; i++) {
+        if (expected[i] != actual[i]) {
+            return ::testing::AssertionFailure() << "column " << i << " differs";
+        }
+    }
+    return ::testing::AssertionSuccess();
+}
+
+class SceneTest : public testing::Test {
+protected:
+    FEngine* engine = nullptr;
+    Scene* scene = nullptr;     // public API
+    FScene* fscene = nullptr;
+    LinearAllocatorArena arena{ "SceneTest", 1024 * 1024 };
+    std::vector<Entity> entities;
+
+    void SetUp() override {
+        engine = downcast(Engine::create(Engine::Backend::NOOP));
+        scene = engine->createScene();
+        fscene = downcast(scene);
+    }
+
+    void TearDown() override {
+        for (Entity e : entities) {
+            engine->destroy(e);
+        }
+        engine->getEntityManager().destroy(entities.size(), entities.data());
+        engine->destroy(scene);
+        Engine::destroy((Engine**)&engine);
+    }
+
+    Entity createRenderable(float3 position, Entity parent = {}) {
+        Entity const e = engine->getEntityManager().create();
+        auto& tcm = engine->getTransformManager();
+        tcm.create(e, parent.isNull() ? TransformManager::Instance{} : tcm.getInstance(parent),
+                mat4f::translation(position));
+        RenderableManager::Builder(1)
+                .boundingBox({{ 0, 0, 0 }, { 1, 1, 1 }})
+                .build(*engine, e);
+        entities.push_back(e);
+        return e;
+    }
+
+    Entity createPointLight(float3 position) {
+        Entity const e = engine->getEntityManager().create();
+        engine->getTransformManager().create(e, {}, mat4f::translation(position));
+        LightManager::Builder(LightManager::Type::POINT).build(*engine, e);
+        entities.push_back(e);
+        return e;
+    }
+
+    void prepare() {
+        RootArenaScope scope(arena);
+        fscene->prepare(engine->getJobSystem(), scope, mat4{}, false);
+    }
+
+    // compares the SoAs filled by prepare() with the instances gathered from all the entities
+    // of the scene, the rows can be in any order
+    ::testing::AssertionResult matchesFullGather() const {
+        auto const& rcm = engine->getRenderableManager();
+        auto const& lcm = engine->getLightManager();
+        auto const& tcm = engine->getTransformManager();
+        std::unordered_map<uint32_t, mat4f> renderables;
+        std::unordered_map<uint32_t, float3> lights;
+        scene->forEach([&](Entity e) {
+            if (!engine->getEntityManager().isAlive(e)) {
+                return;
+            }
+            auto const ti = tcm.getInstance(e);
+            mat4f const world{ tcm.getWorldTransformAccurate(ti) };
+            if (auto const ri = rcm.getInstance(e)) {
+                renderables[ri.asValue()] = world;
+            }
+            auto const li = lcm.getInstance(e);
+            if (li && !lcm.isDirectionalLight(li)) {
+                lights[li.asValue()] = (world * float4{ lcm.getLocalPosition(li), 1 }).xyz;
+            }
+        });
+
+        auto const& soa = fscene->getRenderableData();
+        if (soa.size() != renderables.size()) {
+            return ::testing::AssertionFailure() << soa.size() << " renderable rows, "
+                    << renderables.size() << " expected";
+        }
+        for (size_t i = 0, c = soa.size(); i < c; i++) {
+            auto const pos = renderables.find(soa.elementAt<FScene::RENDERABLE_INSTANCE>(i).asValue());
+            if (pos == renderables.end()) {
+                return ::testing::AssertionFailure() << "unexpected renderable row " << i;
+            }
+            if (!MatricesEqual(pos->second, soa.elementAt<FScene::WORLD_TRANSFORM>(i))) {
+                return ::testing::AssertionFailure() << "stale transform in renderable row " << i;
+            }
+            renderables.erase(pos);
+        }
+
+        auto const& lightData = fscene->getLightData();
+        if (lightData.size() != lights.size() + FScene::DIRECTIONAL_LIGHTS_COUNT) {
+            return ::testing::AssertionFailure() << lightData.size() << " light rows, "
+                    << lights.size() + FScene::DIRECTIONAL_LIGHTS_COUNT << " expected";
+        }
+        for (size_t i = FScene::DIRECTIONAL_LIGHTS_COUNT, c = lightData.size(); i < c; i++) {
+            auto const pos = lights.find(lightData.elementAt<FScene::LIGHT_INSTANCE>(i).asValue());
+            if (pos == lights.end()) {
+                return ::testing::AssertionFailure() << "unexpected light row " << i;
+            }
+            if (lightData.elementAt<FScene::POSITION_RADIUS>(i).xyz != pos->second) {
+                return ::testing::AssertionFailure() << "stale position in light row " << i;
+            }
+            lights.erase(pos);
+        }
+        return ::testing::AssertionSuccess();
+    }
+
+    // the world transform of the entity's row in the renderable SoA
+    mat4f getSceneWorldTransform(Entity e) const {
+        auto const& soa = fscene->getRenderableData();
+        auto const ri = engine->getRenderableManager().getInstance(e);
+        for (size_t i = 0, c = soa.size(); i < c; i++) {
+            if (soa.elementAt<FScene::RENDERABLE_INSTANCE>(i) == ri) {
+                return soa.elementAt<FScene::WORLD_TRANSFORM>(i);
+            }
+        }
+        ADD_FAILURE() << "entity " << e.getId() << " has no row";
+        return {};
+    }
+};
+
+TEST_F(SceneTest, WorldTransformOverrides) {
+    auto& tcm = engine->getTransformManager();
+    Entity const a = createRenderable({ 1, 0, 0 });
+    Entity const b = createRenderable({ 0, 2, 0 });
+    Entity const notInScene = createRenderable({ 0, 0, 3 });
+    scene->addEntity(a);
+    scene->addEntity(b);
+
+    mat4 const overrides[] = { mat4::translation(double3{ 5, 0, 0 }), mat4::scaling(2.0) };
+    Entity const overridden[] = { a, notInScene };
+    scene->setWorldTransformOverrides(overridden, overrides, 2);
+    prepare();
+
+    // the override is used for rendering, the Transform component is not modified
+    EXPECT_TRUE(MatricesEqual(mat4f::translation(float3{ 5, 0, 0 }), getSceneWorldTransform(a)));
+    EXPECT_TRUE(MatricesEqual(mat4f::translation(float3{ 0, 2, 0 }), getSceneWorldTransform(b)));
+    EXPECT_TRUE(MatricesEqual(mat4f::translation(float3{ 1, 0, 0 }),
+            tcm.getWorldTransform(tcm.getInstance(a))));
+
+    // the world AABB follows the override
+    auto const& soa = fscene->getRenderableData();
+    for (size_t i = 0, c = soa.size(); i < c; i++) {
+        if (soa.elementAt<FScene::RENDERABLE_INSTANCE>(i) ==
+                engine->getRenderableManager().getInstance(a)) {
+            EXPECT_EQ(soa.elementAt<FScene::WORLD_AABB_CENTER>(i), float3(5, 0, 0));
+        }
+    }
+
+    // the overrides apply until they are removed
+    prepare();
+    EXPECT_TRUE(MatricesEqual(mat4f::translation(float3{ 5, 0, 0 }), getSceneWorldTransform(a)));
+    scene->setWorldTransformOverrides(nullptr, nullptr, 0);
+    prepare();
+    EXPECT_TRUE(MatricesEqual(mat4f::translation(float3{ 1, 0, 0 }), getSceneWorldTransform(a)));
+}
+
+TEST_F(SceneTest, IncrementalGather) {
+    auto& tcm = engine->getTransformManager();
+    auto& rcm = engine->getRenderableManager();
+    EntityManager& em = engine->getEntityManager();
+
+    std::vector<Entity> objects;
+    for (size_t i = 0; i < 16; i++) {
+        objects.push_back(createRenderable({ float(i), 0, 0 }));
+        scene->addEntity(objects.back());
+    }
+    Entity const light = createPointLight({ 0, 1, 0 });
+    scene->addEntity(light);
+    prepare();
+    EXPECT_TRUE(matchesFullGather());
+
+    // add and remove
+    scene->remove(objects[3]);
+    scene->remove(light);
+    Entity const added = createRenderable({ 0, 0, 5 });
+    scene->addEntity(added);
+    prepare();
+    EXPECT_TRUE(matchesFullGather());
+    scene->addEntity(light);
+    prepare();
+    EXPECT_TRUE(matchesFullGather());
+
+    // components created after the entity was added, or destroyed while it's in the scene
+    // (the last renderable instance moves into the destroyed one's slot)
+    Entity const late = em.create();
+    entities.push_back(late);
+    scene->addEntity(late);
+    prepare();
+    EXPECT_TRUE(matchesFullGather());
+    tcm.create(late, {}, mat4f::translation(float3{ 0, 7, 0 }));
+    RenderableManager::Builder(1)
+            .boundingBox({{ 0, 0, 0 }, { 1, 1, 1 }})
+            .build(*engine, late);
+    rcm.destroy(objects[0]);
+    prepare();
+    EXPECT_TRUE(matchesFullGather());
+
+    // transform changes, including a reparenting that reorders the transform instances
+    tcm.setTransform(tcm.getInstance(objects[1]), mat4f::translation(float3{ 0, 0, -1 }));
+    Entity const parent = createRenderable({ 0, 3, 0 });
+    scene->addEntity(parent);
+    tcm.setParent(tcm.getInstance(objects[2]), tcm.getInstance(parent));
+    prepare();
+    EXPECT_TRUE(matchesFullGather());
+
+    // an entity of the scene destroyed by the EntityManager
+    engine->destroy(objects[4]);
+    em.destroy(objects[4]);
+    entities.erase(std::find(entities.begin(), entities.end(), objects[4]));
+    prepare();
+    EXPECT_TRUE(matchesFullGather());
+
+    // the change log overflows: a renderable of the scene moves, then more changes than the log
+    // can hold are made outside of the scene
+    rcm.destroy(objects[5]);
+    for (size_t i = 0; i < InstanceChangeLog::CAPACITY; i++) {
+        Entity const e = em.create();
+        RenderableManager::Builder(1)
+                .boundingBox({{ 0, 0, 0 }, { 1, 1, 1 }})
+                .build(*engine, e);
+        rcm.destroy(e);
+        em.destroy(e);
+    }
+    prepare();
+    EXPECT_TRUE(matchesFullGather());
+
+    // more entities are destroyed at once than the scene can keep track of, among them an entity
+    // of the scene whose components outlive it, so only a full gather drops its rows
+    std::vector<Entity> destroyed(FScene::DestroyedEntities::CAPACITY);
+    em.create(destroyed.size(), destroyed.data());
+    destroyed.push_back(objects[6]);
+    em.destroy(destroyed.size(), destroyed.data());
+    prepare();
+    EXPECT_TRUE(matchesFullGather());
+    engine->destroy(objects[6]);
+    entities.erase(std::find(entities.begin(), entities.end(), objects[6]));
+    prepare();
+    EXPECT_TRUE(matchesFullGather());
+}
@@ -29,8 +29,17 @@
 #include <filament/Camera.h>
 #include <filament/Color.h>
 #include <filament/Frustum.h>
+#include <filament/IndexBuffer.h>
+#include <filament/LightManager.h>
 #include <filament/Material.h>
 #include <filament/Engine.h>
+#include <filament/RenderableManager.h>
+#include <filament/Renderer.h>
+#include <filament/Scene.h>
+#include <filament/TransformManager.h>
+#include <filament/VertexBuffer.h>
+#include <filament/View.h>
+#include <filament/Viewport.h>
 
 #include <private/filament/BufferInterfaceBlock.h>
 #include <private/filament/UibStructs.h>
@@ -41,10 +50,16 @@
 #include "details/Camera.h"
 #include "Froxelizer.h"
 #include "details/Engine.h"
+#include "details/View.h"
 #include "components/RenderableManager.h"
 #include "components/TransformManager.h"
+#include "ShadowMap.h"
+#include "ShadowMapManager.h"
 #include "UniformBuffer.h"
 
+#include <utils/EntityManager.h>
+#include <utils/JobSystem.h>
+
 using namespace filament;
 using namespace filament::math;
 using namespace utils;
@@ -300,6 +315,310 @@ TEST(FilamentTest, TransformManager) {
     EXPECT_EQ(c, tcm.getChildCount(newParent));
 }
 
+TEST(FilamentTest, TransformManagerTransactionSubtrees) {
+    filament::FTransformManager tcm;
+    EntityManager& em = EntityManager::get();
+    // two chains: a <- b <- c and d <- e
+    std::array<Entity, 5> entities;
+    em.create(entities.size(), entities.data());
+    tcm.create(entities[0]);
+    tcm.create(entities[1], tcm.getInstance(entities[0]), mat4f{});
+    tcm.create(entities[2], tcm.getInstance(entities[1]), mat4f{});
+    tcm.create(entities[3]);
+    tcm.create(entities[4], tcm.getInstance(entities[3]), mat4f{});
+
+    auto const a = tcm.getInstance(entities[0]);
+    auto const b = tcm.getInstance(entities[1]);
+    auto const c = tcm.getInstance(entities[2]);
+    auto const d = tcm.getInstance(entities[3]);
+    auto const e = tcm.getInstance(entities[4]);
+
+    // a node and its ancestor are both changed, only the second chain's leaf is changed
+    tcm.openLocalTransformTransaction();
+    tcm.setTransform(b, mat4f::translation(float3{ 0, 1, 0 }));
+    tcm.setTransform(a, mat4f::translation(float3{ 1, 0, 0 }));
+    tcm.setTransform(e, mat4f::translation(float3{ 0, 0, 1 }));
+    tcm.setTransform(b, mat4f::translation(float3{ 0, 2, 0 }));
+    EXPECT_EQ(tcm.getWorldTransform(c), mat4f{});
+    tcm.commitLocalTransformTransaction();
+
+    EXPECT_EQ(tcm.getWorldTransform(a), mat4f::translation(float3{ 1, 0, 0 }));
+    EXPECT_EQ(tcm.getWorldTransform(b), mat4f::translation(float3{ 1, 2, 0 }));
+    EXPECT_EQ(tcm.getWorldTransform(c), mat4f::translation(float3{ 1, 2, 0 }));
+    EXPECT_EQ(tcm.getWorldTransform(d), mat4f{});
+    EXPECT_EQ(tcm.getWorldTransform(e), mat4f::translation(float3{ 0, 0, 1 }));
+
+    // destroying a node during a transaction orphans its children
+    tcm.openLocalTransformTransaction();
+    tcm.destroy(entities[1]);
+    tcm.commitLocalTransformTransaction();
+    EXPECT_EQ(tcm.getWorldTransform(tcm.getInstance(entities[2])), mat4f{});
+
+    // an empty transaction leaves the world transforms alone
+    tcm.openLocalTransformTransaction();
+    tcm.commitLocalTransformTransaction();
+    EXPECT_EQ(tcm.getWorldTransform(tcm.getInstance(entities[0])),
+            mat4f::translation(float3{ 1, 0, 0 }));
+}
+
+TEST(FilamentTest, TransformManagerTransactionJobs) {
+    // levels of 2048 and 4096 nodes are updated on the JobSystem, the world transforms must be
+    // the ones computed serially
+    constexpr size_t ROOT_COUNT = 2048;
+    constexpr size_t CHILD_COUNT = 2;       // per node above the leaves
+    constexpr size_t DEPTH = 3;
+
+    JobSystem js(2);
+    js.adopt();
+    filament::FTransformManager serial;
+    filament::FTransformManager parallel;
+    parallel.setJobSystem(&js);
+
+    EntityManager& em = EntityManager::get();
+    std::vector<Entity> entities;
+    std::vector<Entity> level(ROOT_COUNT);
+    em.create(level.size(), level.data());
+    for (Entity const e : level) {
+        serial.create(e);
+        parallel.create(e);
+    }
+    entities.insert(entities.end(), level.begin(), level.end());
+    for (size_t d = 1; d < DEPTH; d++) {
+        std::vector<Entity> children(level.size() * CHILD_COUNT);
+        em.create(children.size(), children.data());
+        for (size_t k = 0; k < children.size(); k++) {
+            Entity const parent = level[k / CHILD_COUNT];
+            serial.create(children[k], serial.getInstance(parent), mat4f{});
+            parallel.create(children[k], parallel.getInstance(parent), mat4f{});
+        }
+        entities.insert(entities.end(), children.begin(), children.end());
+        level = std::move(children);
+    }
+
+    std::default_random_engine gen; // NOLINT
+    std::uniform_real_distribution<float> rand(-1.0f, 1.0f);
+    auto randomTransform = [&]() {
+        return mat4f::translation(float3{ rand(gen), rand(gen), rand(gen) }) *
+                mat4f::rotation(rand(gen), normalize(float3{ rand(gen), rand(gen), 1.0f }));
+    };
+
+    // every root and one node in three are changed, so the subtrees overlap
+    serial.openLocalTransformTransaction();
+    parallel.openLocalTransformTransaction();
+    for (size_t k = 0; k < entities.size(); k++) {
+        if (k < ROOT_COUNT || k % 3 == 0) {
+            mat4f const local = randomTransform();
+            serial.setTransform(serial.getInstance(entities[k]), local);
+            parallel.setTransform(parallel.getInstance(entities[k]), local);
+        }
+    }
+    serial.commitLocalTransformTransaction();
+    parallel.commitLocalTransformTransaction();
+
+    for (Entity const e : entities) {
+        ASSERT_EQ(serial.getWorldTransform(serial.getInstance(e)),
+                parallel.getWorldTransform(parallel.getInstance(e)));
+    }
+
+    em.destroy(entities.size(), entities.data());
+    js.emancipate();
+}
+
+TEST(FilamentTest, ShadowMapCache) {
+    // two shadow casters, as the culler leaves them in the renderable SoA
+    FScene::RenderableSoa soa;
+    soa.setCapacity(16);
+    soa.resize(2);
+    for (size_t i = 0; i < soa.size(); i++) {
+        FRenderableManager::Visibility visibility{};
+        visibility.castShadows = true;
+        soa.elementAt<FScene::RENDERABLE_INSTANCE>(i) = FRenderableManager::Instance(i + 1);
+        soa.elementAt<FScene::WORLD_TRANSFORM>(i) = mat4f::translation(float3{ float(i), 0, 0 });
+        soa.elementAt<FScene::VISIBILITY_STATE>(i) = visibility;
+        soa.elementAt<FScene::INSTANCES>(i) = {};
+        soa.elementAt<FScene::VISIBLE_MASK>(i) = VISIBLE_DIR_SHADOW_RENDERABLE;
+    }
+    Range<uint32_t> const casters{ 0, uint32_t(soa.size()) };
+
+    // a frame of a view with two shadow map layers, returns the number of layers rendered
+    ShadowMapManager::ShadowMapCache cache;
+    uint32_t generation = 0;
+    bool atlasValid = false;
+    auto renderFrame = [&]() {
+        uint64_t const castersHash = ShadowMapManager::getCastersHash(
+                soa, casters, VISIBLE_DIR_SHADOW_RENDERABLE);
+        cache.beginFrame(atlasValid, generation);
+        atlasValid = true;
+        size_t rendered = 0;
+        for (size_t layer = 0; layer < 2; layer++) {
+            // stands for the content hash, which adds the light camera of each layer
+            uint64_t const contentHash = castersHash ? castersHash + layer : 0;
+            rendered += cache.reuse(layer, contentHash) ? 0 : 1;
+        }
+        return rendered;
+    };
+
+    // a static scene renders each layer once
+    EXPECT_EQ(renderFrame(), 2);
+    EXPECT_EQ(renderFrame(), 0);
+    EXPECT_EQ(renderFrame(), 0);
+
+    // moving a caster renders the layers again
+    soa.elementAt<FScene::WORLD_TRANSFORM>(1) = mat4f::translation(float3{ 1, 1, 0 });
+    EXPECT_EQ(renderFrame(), 2);
+    EXPECT_EQ(renderFrame(), 0);
+
+    // so does View::invalidateShadowMapCache(), or a new atlas
+    generation++;
+    EXPECT_EQ(renderFrame(), 2);
+    EXPECT_EQ(renderFrame(), 0);
+    atlasValid = false;
+    EXPECT_EQ(renderFrame(), 2);
+
+    // a skinned caster is rendered every frame
+    soa.elementAt<FScene::VISIBILITY_STATE>(0).skinning = true;
+    EXPECT_EQ(ShadowMapManager::getCastersHash(soa, casters, VISIBLE_DIR_SHADOW_RENDERABLE), 0);
+    EXPECT_EQ(renderFrame(), 2);
+    EXPECT_EQ(renderFrame(), 2);
+
+    // unless it's not a potential caster of the shadow map
+    soa.elementAt<FScene::VISIBLE_MASK>(0) = 0;
+    EXPECT_EQ(renderFrame(), 2);
+    EXPECT_EQ(renderFrame(), 0);
+}
+
+TEST(FilamentTest, ShadowMapCacheRendering) {
+    Engine* engine = Engine::create(Engine::Backend::NOOP);
+    SwapChain* swapChain = engine->createSwapChain(64, 64);
+    Renderer* renderer = engine->createRenderer();
+    Scene* scene = engine->createScene();
+    View* view = engine->createView();
+    EntityManager& em = engine->getEntityManager();
+    TransformManager& tcm = engine->getTransformManager();
+    LightManager& lcm = engine->getLightManager();
+
+    Entity const cameraEntity = em.create();
+    Camera* camera = engine->createCamera(cameraEntity);
+    camera->setProjection(45.0, 1.0, 0.1, 100.0);
+    camera->lookAt({ 0, 4, 8 }, { 0, 0, 0 });
+
+    view->setViewport({ 0, 0, 64, 64 });
+    view->setScene(scene);
+    view->setCamera(camera);
+    view->setPostProcessingEnabled(false);
+    view->setShadowMapCachingEnabled(true);
+
+    // a unit cube
+    static float3 const vertices[] = {
+            { -1, -1, -1 }, {  1, -1, -1 }, {  1,  1, -1 }, { -1,  1, -1 },
+            { -1, -1,  1 }, {  1, -1,  1 }, {  1,  1,  1 }, { -1,  1,  1 } };
+    static uint16_t const indices[] = {
+            0, 2, 1,  0, 3, 2,  4, 5, 6,  4, 6, 7,  0, 1, 5,  0, 5, 4,
+            3, 6, 2,  3, 7, 6,  0, 4, 7,  0, 7, 3,  1, 2, 6,  1, 6, 5 };
+    VertexBuffer* vb = VertexBuffer::Builder()
+            .vertexCount(8)
+            .bufferCount(1)
+            .attribute(VertexAttribute::POSITION, 0, VertexBuffer::AttributeType::FLOAT3)
+            .build(*engine);
+    vb->setBufferAt(*engine, 0, { vertices, sizeof(vertices) });
+    IndexBuffer* ib = IndexBuffer::Builder()
+            .indexCount(36)
+            .bufferType(IndexBuffer::IndexType::USHORT)
+            .build(*engine);
+    ib->setBuffer(*engine, { indices, sizeof(indices) });
+
+    auto createBox = [&](mat4f const& transform) {
+        Entity const e = em.create();
+        tcm.create(e, {}, transform);
+        RenderableManager::Builder(1)
+                .boundingBox({{ 0, 0, 0 }, { 1, 1, 1 }})
+                .geometry(0, RenderableManager::PrimitiveType::TRIANGLES, vb, ib)
+                .material(0, engine->getDefaultMaterial()->getDefaultInstance())
+                .castShadows(true)
+                .receiveShadows(true)
+                .build(*engine, e);
+        scene->addEntity(e);
+        return e;
+    };
+
+    // a cube casting a shadow on the ground, lit by the sun
+    Entity const ground = createBox(mat4f::scaling(float3{ 4, 0.1f, 4 }));
+    Entity const caster = createBox(mat4f::translation(float3{ 0, 1, 0 }) * mat4f::scaling(0.5f));
+    Entity const sun = em.create();
+    LightManager::Builder(LightManager::Type::SUN)
+            .direction({ 0.2f, -1, 0 })
+            .castShadows(true)
+            .build(*engine, sun);
+    scene->addEntity(sun);
+
+    // renders a frame, returns the number of shadow map layers rendered in it, that is the
+    // layers whose content isn't already in the cached atlas
+    auto renderFrame = [&]() {
+        EXPECT_TRUE(renderer->beginFrame(swapChain));
+        renderer->render(view);
+        renderer->endFrame();
+        engine->flushAndWait();
+
+        ShadowMapManager const* const shadowMapManager = downcast(view)->getShadowMapManager();
+        EXPECT_NE(shadowMapManager, nullptr);
+        if (!shadowMapManager) {
+            return size_t(0);
+        }
+        auto const& cache = shadowMapManager->mCache;
+        EXPECT_TRUE(bool(cache.atlas));
+        size_t rendered = 0;
+        for (size_t layer = 0; layer < cache.layers.size(); layer++) {
+            rendered += cache.layers[layer] && cache.layers[layer] != cache.previousLayers[layer];
+        }
+        return rendered;
+    };
+
+    // a static scene renders the shadow map once
+    EXPECT_EQ(renderFrame(), 1);
+    EXPECT_EQ(renderFrame(), 0);
+    EXPECT_EQ(renderFrame(), 0);
+
+    // moving the caster renders it again
+    tcm.setTransform(tcm.getInstance(caster),
+            mat4f::translation(float3{ 0.5f, 1, 0 }) * mat4f::scaling(0.5f));
+    EXPECT_EQ(renderFrame(), 1);
+    EXPECT_EQ(renderFrame(), 0);
+
+    // so does changing the light
+    lcm.setDirection(lcm.getInstance(sun), { 0, -1, 0.2f });
+    EXPECT_EQ(renderFrame(), 1);
+    EXPECT_EQ(renderFrame(), 0);
+
+    // or invalidating the cache
+    view->invalidateShadowMapCache();
+    EXPECT_EQ(renderFrame(), 1);
+    EXPECT_EQ(renderFrame(), 0);
+
+    // without caching, the atlas is released
+    view->setShadowMapCachingEnabled(false);
+    EXPECT_TRUE(renderer->beginFrame(swapChain));
+    renderer->render(view);
+    renderer->endFrame();
+    engine->flushAndWait();
+    EXPECT_FALSE(bool(downcast(view)->getShadowMapManager()->mCache.atlas));
+
+    for (Entity const e : { ground, caster, sun }) {
+        engine->destroy(e);
+    }
+    em.destroy(ground);
+    em.destroy(caster);
+    em.destroy(sun);
+    engine->destroy(vb);
+    engine->destroy(ib);
+    engine->destroyCameraComponent(cameraEntity);
+    em.destroy(cameraEntity);
+    engine->destroy(view);
+    engine->destroy(scene);
+    engine->destroy(renderer);
+    engine->destroy(swapChain);
+    Engine::destroy(&engine);
+}
+
 TEST(FilamentTest, UniformInterfaceBlock) {
 
     BufferInterfaceBlock::Builder b;
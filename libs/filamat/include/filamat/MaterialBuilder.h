@@ -125,6 +125,21 @@ public:
      */
     static void shutdown();
 
+    /**
+     * Set the capacity, in bytes, of the cache of compiled shaders shared by all the builders of
+     * the process. 32 MiB by default, 0 disables the cache.
+     *
+     * A shader whose generated GLSL and compilation settings match one of a previous build is not
+     * compiled again, e.g. the vertex shaders of a material whose fragment code changed, or the
+     * existing targets of a material built again for an additional target. The cache is released
+     * by the last call to shutdown.
+     *
+     * The cache lives in memory only: it benefits the builds made by a single process (an editor,
+     * a tool building several materials, or materials generated at runtime). A process that builds
+     * a single material and exits, such as matc, never hits it.
+     */
+    static void setShaderCacheCapacity(size_t bytes) noexcept;
+
 protected:
     // Looks at platform and target API, then decides on shader models and output formats.
     void prepare(bool vulkanSemantics, filament::backend::FeatureLevel featureLevel);
@@ -25,6 +25,7 @@
 #include "shaders/UibGenerator.h"
 
 #include "GLSLPostProcessor.h"
+#include "ShaderCache.h"
 #include "sca/GLSLTools.h"
 
 #include "shaders/MaterialInfo.h"
@@ -186,10 +187,16 @@ void MaterialBuilderBase::init() {
 }
 
 void MaterialBuilderBase::shutdown() {
-    materialBuilderClients--;
+    if (--materialBuilderClients == 0) {
+        ShaderCache::get().clear();
+    }
     GLSLTools::shutdown();
 }
 
+void MaterialBuilderBase::setShaderCacheCapacity(size_t bytes) noexcept {
+    ShaderCache::get().setCapacity(bytes);
+}
+
 MaterialBuilder& MaterialBuilder::name(const char* name) noexcept {
     mMaterialName = CString(name);
     return *this;
@@ -830,6 +837,44 @@ static void showErrorMessage(const char* materialName, filament::Variant variant
             << shaderCode;
 }
 
+// Key of a compiled shader in the ShaderCache: every setting that affects the compilation followed by
+// the generated GLSL.
+static std::string getShaderCacheKey(std::string const& shader,
+        GLSLPostProcessor::Config const& config, MaterialBuilder::Optimization optimization,
+        bool generateDebugInfo) {
+    std::string key;
+    key.reserve(shader.size() + 64);
+    auto append = [&key](auto value) {
+        key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    append(config.variant.key);
+    append(config.targetApi);
+    append(config.targetLanguage);
+    append(config.shaderType);
+    append(config.shaderModel);
+    append(config.featureLevel);
+    append(config.domain);
+    append(optimization);
+    append(generateDebugInfo);
+    append(config.hasFramebufferFetch);
+    append(config.usesClipDistance);
+    append(config.materialInfo->stereoscopicType);
+    append(config.materialInfo->stereoscopicEyeCount);
+    // the MSL cross-compilation also depends on the samplers of the material
+    if (config.targetApi == MaterialBuilder::TargetApi::METAL) {
+        for (auto const& sampler : config.materialInfo->sib.getSamplerInfoList()) {
+            key.append(sampler.uniformName.c_str_safe(), sampler.uniformName.size() + 1);
+            append(sampler.offset);
+            append(sampler.type);
+            append(sampler.format);
+            append(sampler.precision);
+            append(sampler.multisample);
+        }
+    }
+    key.append(shader);
+    return key;
+}
+
 bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Variant>& variants,
         ChunkContainer& container, const MaterialInfo& info) const noexcept {
     // Create a postprocessor to optimize / compile to Spir-V if necessary.
@@ -859,33 +904,36 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
     std::atomic_bool cancelJobs(false);
     bool firstJob = true;
 
-    for (const auto& params : mCodeGenPermutations) {
-        if (cancelJobs.load()) {
-            return false;
-        }
-
-        const ShaderModel shaderModel = ShaderModel(params.shaderModel);
-        const TargetApi targetApi = params.targetApi;
-        const TargetLanguage targetLanguage = params.targetLanguage;
-        const FeatureLevel featureLevel = params.featureLevel;
+    // Shaders compiled by previous builds are reused. The cache is bypassed when printing the
+    // shaders, which is done by the compilation.
+    ShaderCache& shaderCache = ShaderCache::get();
+    const bool useShaderCache = !mPrintShaders && shaderCache.isEnabled();
 
-        assertSingleTargetApi(targetApi);
+    // The shaders of all the permutations are compiled as a single job graph.
+    JobSystem::Job* parent = jobSystem.createJob();
 
-        // Metal Shading Language is cross-compiled from Vulkan.
-        const bool targetApiNeedsSpirv =
-                (targetApi == TargetApi::VULKAN || targetApi == TargetApi::METAL);
-        const bool targetApiNeedsMsl = targetApi == TargetApi::METAL;
-        const bool targetApiNeedsGlsl = targetApi == TargetApi::OPENGL;
-
-        // Set when a job fails
-        JobSystem::Job* parent = jobSystem.createJob();
+    for (const auto& params : mCodeGenPermutations) {
+        assertSingleTargetApi(params.targetApi);
 
         for (const auto& v : variants) {
+            // params and v refer to elements of mCodeGenPermutations and variants, which outlive
+            // the job.
             JobSystem::Job* job = jobs::createJob(jobSystem, parent, [&]() {
                 if (cancelJobs.load()) {
                     return;
                 }
 
+                const ShaderModel shaderModel = ShaderModel(params.shaderModel);
+                const TargetApi targetApi = params.targetApi;
+                const TargetLanguage targetLanguage = params.targetLanguage;
+                const FeatureLevel featureLevel = params.featureLevel;
+
+                // Metal Shading Language is cross-compiled from Vulkan.
+                const bool targetApiNeedsSpirv =
+                        (targetApi == TargetApi::VULKAN || targetApi == TargetApi::METAL);
+                const bool targetApiNeedsMsl = targetApi == TargetApi::METAL;
+                const bool targetApiNeedsGlsl = targetApi == TargetApi::OPENGL;
+
                 // TODO: avoid allocations when not required
                 std::vector<uint32_t> spirv;
                 std::string msl;
@@ -970,15 +1018,32 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
                     config.glsl.subpassInputToColorLocation.emplace_back(0, 0);
                 }
 
-                bool const ok = postProcessor.process(shader, config, pGlsl, pSpirv, pMsl);
-                if (!ok) {
-                    showErrorMessage(mMaterialName.c_str_safe(), v.variant, targetApi, v.stage,
-                                     featureLevel, shader);
-                    cancelJobs = true;
-                    if (mPrintShaders) {
-                        slog.e << shader << io::endl;
+                std::string cacheKey;
+                ShaderCache::Output cached;
+                if (useShaderCache) {
+                    cacheKey = getShaderCacheKey(shader, config, mOptimization, mGenerateDebugInfo);
+                }
+                if (useShaderCache && shaderCache.find(cacheKey, &cached)) {
+                    if (pGlsl) {
+                        shader = std::move(cached.glsl);
+                    }
+                    spirv = std::move(cached.spirv);
+                    msl = std::move(cached.msl);
+                } else {
+                    bool const ok = postProcessor.process(shader, config, pGlsl, pSpirv, pMsl);
+                    if (!ok) {
+                        showErrorMessage(mMaterialName.c_str_safe(), v.variant, targetApi, v.stage,
+                                featureLevel, shader);
+                        cancelJobs = true;
+                        if (mPrintShaders) {
+                            slog.e << shader << io::endl;
+                        }
+                        return;
+                    }
+                    if (useShaderCache) {
+                        shaderCache.insert(std::move(cacheKey),
+                                { pGlsl ? shader : std::string{}, spirv, msl });
                     }
-                    return;
                 }
 
                 if (targetApi == TargetApi::OPENGL) {
@@ -1038,10 +1103,10 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
                 jobSystem.run(job);
             }
         }
-
-        jobSystem.runAndWait(parent);
     }
 
+    jobSystem.runAndWait(parent);
+
     if (cancelJobs.load()) {
         return false;
     }
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ShaderCache.h"
+
+#include <mutex>
+#include <utility>
+
+namespace filamat {
+
+ShaderCache& ShaderCache::get() noexcept {
+    static ShaderCache sCache;
+    return sCache;
+}
+
+void ShaderCache::setCapacity(size_t bytes) noexcept {
+    std::lock_guard<utils::Mutex> const lock(mLock);
+    mCapacity = bytes;
+    evict(mCapacity);
+}
+
+size_t ShaderCache::getCapacity() const noexcept {
+    std::lock_guard<utils::Mutex> const lock(mLock);
+    return mCapacity;
+}
+
+bool ShaderCache::find(std::string const& key, Output* output) noexcept {
+    std::lock_guard<utils::Mutex> const lock(mLock);
+    auto pos = mIndex.find(key);
+    if (pos == mIndex.end()) {
+        return false;
+    }
+    mEntries.splice(mEntries.begin(), mEntries, pos->second);
+    *output = pos->second->output;
+    mHitCount++;
+    return true;
+}
+
+void ShaderCache::insert(std::string key, Output output) noexcept {
+    const size_t size = key.size() + output.glsl.size() + output.msl.size() +
+            output.spirv.size() * sizeof(uint32_t);
+    std::lock_guard<utils::Mutex> const lock(mLock);
+    if (size > mCapacity || mIndex.find(key) != mIndex.end()) {
+        return;
+    }
+    evict(mCapacity - size);
+    mEntries.push_front({ std::move(key), std::move(output), size });
+    mIndex.emplace(mEntries.front().key, mEntries.begin());
+    mSize += size;
+}
+
+void ShaderCache::clear() noexcept {
+    std::lock_guard<utils::Mutex> const lock(mLock);
+    evict(0);
+    mHitCount = 0;
+}
+
+size_t ShaderCache::getSize() const noexcept {
+    std::lock_guard<utils::Mutex> const lock(mLock);
+    return mSize;
+}
+
+size_t ShaderCache::getHitCount() const noexcept {
+    std::lock_guard<utils::Mutex> const lock(mLock);
+    return mHitCount;
+}
+
+void ShaderCache::evict(size_t capacity) noexcept {
+    while (mSize > capacity) {
+        Entry const& entry = mEntries.back();
+        mSize -= entry.size;
+        mIndex.erase(entry.key);
+        mEntries.pop_back();
+    }
+}
+
+} // namespace filamat
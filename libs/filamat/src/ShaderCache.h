@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMAT_SHADERCACHE_H
+#define TNT_FILAMAT_SHADERCACHE_H
+
+#include <utils/Mutex.h>
+
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filamat {
+
+/**
+ * Process-wide cache of the shaders compiled by GLSLPostProcessor, shared by all MaterialBuilders.
+ *
+ * An entry is keyed by the GLSL generated for a variant and by every setting that affects its
+ * compilation (see MaterialBuilder::generateShaders), so rebuilding a material that differs only
+ * in some of its variants or targets compiles those alone. The least recently used entries are
+ * evicted beyond the capacity. All methods are thread-safe.
+ */
+class ShaderCache {
+public:
+    struct Output {
+        std::string glsl;
+        std::vector<uint32_t> spirv;
+        std::string msl;
+    };
+
+    static ShaderCache& get() noexcept;
+
+    // 0 disables the cache (and releases its entries)
+    void setCapacity(size_t bytes) noexcept;
+    size_t getCapacity() const noexcept;
+
+    bool isEnabled() const noexcept { return getCapacity() > 0; }
+
+    // Copies the output of the key into output, if found.
+    bool find(std::string const& key, Output* output) noexcept;
+
+    void insert(std::string key, Output output) noexcept;
+
+    void clear() noexcept;
+
+    size_t getSize() const noexcept;
+    size_t getHitCount() const noexcept;
+
+private:
+    struct Entry {
+        std::string key;
+        Output output;
+        size_t size;
+    };
+
+    void evict(size_t capacity) noexcept;
+
+    mutable utils::Mutex mLock;
+    std::list<Entry> mEntries; // most recently used first
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> mIndex; // views of the keys
+    size_t mCapacity = 32u * 1024u * 1024u;
+    size_t mSize = 0;
+    size_t mHitCount = 0;
+};
+
+} // namespace filamat
+
+#endif // TNT_FILAMAT_SHADERCACHE_H
@@ -21,6 +21,7 @@
 #include "shaders/ShaderGenerator.h"
 
 #include "MockIncluder.h"
+#include "ShaderCache.h"
 
 #include <filamat/Enums.h>
 #include <filamat/MaterialBuilder.h>
@@ -29,6 +30,8 @@
 
 #include <memory>
 
+#include <string.h>
+
 using namespace utils;
 using namespace ASTHelpers;
 using namespace filamat;
@@ -891,6 +894,84 @@ TEST_F(MaterialCompiler, FeatureLevel0Ess3CallFails) {
   EXPECT_FALSE(result.isValid());
 }
 
+TEST(ShaderCache, EvictsLeastRecentlyUsed) {
+    ShaderCache cache;
+    cache.setCapacity(50);
+    cache.insert("a", { std::string(20, 'a'), {}, {} });
+    cache.insert("b", { std::string(20, 'b'), {}, {} });
+
+    ShaderCache::Output output;
+    EXPECT_TRUE(cache.find("a", &output));
+    EXPECT_EQ(output.glsl, std::string(20, 'a'));
+
+    // "b" is now the least recently used entry
+    cache.insert("c", { {}, std::vector<uint32_t>(5, 1u), {} });
+    EXPECT_TRUE(cache.find("a", &output));
+    EXPECT_FALSE(cache.find("b", &output));
+    EXPECT_TRUE(cache.find("c", &output));
+    EXPECT_EQ(output.spirv.size(), 5u);
+    EXPECT_EQ(cache.getHitCount(), 3u);
+    EXPECT_LE(cache.getSize(), 50u);
+
+    // entries larger than the capacity are not cached
+    cache.insert("d", { std::string(100, 'd'), {}, {} });
+    EXPECT_FALSE(cache.find("d", &output));
+
+    cache.setCapacity(0);
+    EXPECT_FALSE(cache.isEnabled());
+    EXPECT_EQ(cache.getSize(), 0u);
+}
+
+TEST_F(MaterialCompiler, ShaderCacheReusesCompiledShaders) {
+    std::string shaderCode(R"(
+        void material(inout MaterialInputs material) {
+            prepareMaterial(material);
+            material.baseColor = materialParams.color;
+        }
+    )");
+    auto build = [&](MaterialBuilder::TargetApi targetApi) {
+        filamat::MaterialBuilder builder;
+        builder.parameter("color", UniformType::FLOAT4);
+        builder.shading(filament::Shading::UNLIT);
+        builder.platform(filamat::MaterialBuilder::Platform::MOBILE);
+        builder.targetApi(targetApi);
+        builder.material(shaderCode.c_str());
+        return builder.build(*jobSystem);
+    };
+    auto same = [](filamat::Package const& a, filamat::Package const& b) {
+        return a.getSize() == b.getSize() && !memcmp(a.getData(), b.getData(), a.getSize());
+    };
+
+    ShaderCache& cache = ShaderCache::get();
+    size_t const capacity = cache.getCapacity();
+
+    MaterialBuilder::setShaderCacheCapacity(0);
+    filamat::Package reference = build(MaterialBuilder::TargetApi::VULKAN);
+    EXPECT_TRUE(reference.isValid());
+
+    MaterialBuilder::setShaderCacheCapacity(32u * 1024u * 1024u);
+    filamat::Package first = build(MaterialBuilder::TargetApi::VULKAN);
+    size_t const hits = cache.getHitCount();
+    EXPECT_GT(cache.getSize(), 0u);
+
+    // a rebuild of the same material is served by the cache and yields the same package
+    filamat::Package second = build(MaterialBuilder::TargetApi::VULKAN);
+    EXPECT_GT(cache.getHitCount(), hits);
+    EXPECT_TRUE(same(reference, first));
+    EXPECT_TRUE(same(reference, second));
+
+    // an additional target only compiles the shaders of that target
+    size_t const size = cache.getSize();
+    size_t const vulkanHits = cache.getHitCount();
+    filamat::Package both = build(
+            MaterialBuilder::TargetApi::OPENGL | MaterialBuilder::TargetApi::VULKAN);
+    EXPECT_TRUE(both.isValid());
+    EXPECT_GT(cache.getHitCount(), vulkanHits);
+    EXPECT_GT(cache.getSize(), size);
+
+    MaterialBuilder::setShaderCacheCapacity(capacity);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <filament/Engine.h>
+#include <filament/TransformManager.h>
+
+#include <gltfio/Animator.h>
+#include <gltfio/AssetLoader.h>
+#include <gltfio/FilamentAsset.h>
+#include <gltfio/FilamentInstance.h>
+#include <gltfio/MaterialProvider.h>
+#include <gltfio/ResourceLoader.h>
+#include <gltfio/TextureProvider.h>
+
+#include <utils/EntityManager.h>
+#include <utils/JobSystem.h>
+#include <utils/NameComponentManager.h>
+
+#include <cgltf.h>
+
+#include "materials/uberarchive.h"
+
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <vector>
+
+using namespace filament;
+using namespace filament::gltfio;
+using namespace utils;
+
+// Per-frame cost of playing the first animation of many instances of an animated glTF, through
+// gltfio::Animator. The NOOP backend is used, so this measures the CPU side.
+class AnimatorFixture : public benchmark::Fixture {
+protected:
+    static constexpr size_t INSTANCE_COUNT = 64;
+    static constexpr float FRAME_TIME = 1.0f / 60.0f;
+
+    Engine* engine = nullptr;
+    NameComponentManager* names = nullptr;
+    MaterialProvider* materials = nullptr;
+    AssetLoader* assetLoader = nullptr;
+    ResourceLoader* resourceLoader = nullptr;
+    TextureProvider* stbDecoder = nullptr;
+    FilamentAsset* asset = nullptr;
+    std::vector<Animator*> animators;
+    size_t channelCount = 0;            // channels of the first animation, per instance
+    float duration = 0.0f;
+    float time = 0.0f;
+
+    static size_t getChannelCount(std::vector<uint8_t> const& content) {
+        cgltf_options options{};
+        cgltf_data* gltf = nullptr;
+        if (cgltf_parse(&options, content.data(), content.size(), &gltf) != cgltf_result_success) {
+            return 0;
+        }
+        size_t const count = gltf->animations_count ? gltf->animations[0].channels_count : 0;
+        cgltf_free(gltf);
+        return count;
+    }
+
+    void advance() {
+        time = std::fmod(time + FRAME_TIME, duration);
+    }
+
+public:
+    void SetUp(const benchmark::State& state) override {
+        Engine::Config config;
+        config.jobSystemThreadCount = uint32_t(state.range(0));
+        engine = Engine::Builder()
+                .backend(Engine::Backend::NOOP)
+                .config(&config)
+                .build();
+
+        names = new NameComponentManager(EntityManager::get());
+        materials = createUbershaderProvider(engine,
+                UBERARCHIVE_DEFAULT_DATA, UBERARCHIVE_DEFAULT_SIZE);
+        assetLoader = AssetLoader::create({ engine, materials, names });
+        resourceLoader = new ResourceLoader({ engine, GLTFIO_BENCHMARK_MODEL, false });
+        stbDecoder = createStbProvider(engine);
+        resourceLoader->addTextureProvider("image/png", stbDecoder);
+        resourceLoader->addTextureProvider("image/jpeg", stbDecoder);
+
+        std::ifstream in(GLTFIO_BENCHMARK_MODEL, std::ifstream::binary | std::ifstream::in);
+        std::vector<uint8_t> const content(
+                (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (content.empty()) {
+            return;
+        }
+        channelCount = getChannelCount(content);
+        FilamentInstance* instances[INSTANCE_COUNT];
+        asset = assetLoader->createInstancedAsset(content.data(), uint32_t(content.size()),
+                instances, INSTANCE_COUNT);
+        if (!asset || !resourceLoader->loadResources(asset)) {
+            return;
+        }
+        for (FilamentInstance* instance : instances) {
+            animators.push_back(instance->getAnimator());
+        }
+        duration = animators[0]->getAnimationCount() ? animators[0]->getAnimationDuration(0) : 0.0f;
+        time = 0.0f;
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        animators.clear();
+        if (asset) {
+            assetLoader->destroyAsset(asset);
+            asset = nullptr;
+        }
+        delete resourceLoader;
+        delete stbDecoder;
+        AssetLoader::destroy(&assetLoader);
+        materials->destroyMaterials();
+        delete materials;
+        delete names;
+        Engine::destroy(&engine);
+    }
+};
+
+// Each instance samples its channels within its own local transform transaction (a world
+// transform commit per instance), then computes its bone matrices.
+BENCHMARK_DEFINE_F(AnimatorFixture, updateSerial)(benchmark::State& state) {
+    if (duration <= 0.0f) {
+        state.SkipWithError("Unable to load the animation of " GLTFIO_BENCHMARK_MODEL);
+        return;
+    }
+    for (auto _ : state) {
+        advance();
+        for (Animator* animator : animators) {
+            animator->applyAnimation(0, time);
+            animator->updateBoneMatrices();
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * animators.size()));
+}
+
+// The staged API, as VzRenderer drives it: the instances are sampled as parallel jobs within a
+// single transaction, the world transforms are committed once, the bone matrices are computed
+// as parallel jobs, then the staged data is uploaded on this thread.
+BENCHMARK_DEFINE_F(AnimatorFixture, updateJobs)(benchmark::State& state) {
+    if (duration <= 0.0f) {
+        state.SkipWithError("Unable to load the animation of " GLTFIO_BENCHMARK_MODEL);
+        return;
+    }
+    TransformManager& tcm = engine->getTransformManager();
+    JobSystem& js = engine->getJobSystem();
+    auto sampleAnimations = [this](Animator** first, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            first[i]->sampleAnimation(0, time);
+        }
+    };
+    auto computeBoneMatrices = [](Animator** first, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            first[i]->computeBoneMatrices();
+        }
+    };
+    for (auto _ : state) {
+        advance();
+        tcm.openLocalTransformTransaction();
+        JobSystem::Job* job = jobs::parallel_for(js, nullptr, animators.data(),
+                uint32_t(animators.size()), std::cref(sampleAnimations), jobs::CountSplitter<1>());
+        js.runAndWait(job);
+        tcm.commitLocalTransformTransaction();
+        job = jobs::parallel_for(js, nullptr, animators.data(),
+                uint32_t(animators.size()), std::cref(computeBoneMatrices), jobs::CountSplitter<1>());
+        js.runAndWait(job);
+        for (Animator* animator : animators) {
+            animator->uploadStagedData();
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * animators.size()));
+}
+
+// Keyframe evaluation alone: the local transforms are written within a single transaction that
+// is committed after the timed loop. The model has no morph target, so nothing is left staged.
+//  - playback : the time moves forward by a frame, so the keyframe cursor of each channel is hit
+//  - seek : the time is random, so each channel falls back to a binary search
+BENCHMARK_DEFINE_F(AnimatorFixture, samplePlayback)(benchmark::State& state) {
+    if (duration <= 0.0f) {
+        state.SkipWithError("Unable to load the animation of " GLTFIO_BENCHMARK_MODEL);
+        return;
+    }
+    TransformManager& tcm = engine->getTransformManager();
+    tcm.openLocalTransformTransaction();
+    for (auto _ : state) {
+        advance();
+        for (Animator* animator : animators) {
+            animator->sampleAnimation(0, time);
+        }
+    }
+    tcm.commitLocalTransformTransaction();
+    state.SetItemsProcessed(int64_t(state.iterations() * animators.size() * channelCount));
+}
+
+BENCHMARK_DEFINE_F(AnimatorFixture, sampleSeek)(benchmark::State& state) {
+    if (duration <= 0.0f) {
+        state.SkipWithError("Unable to load the animation of " GLTFIO_BENCHMARK_MODEL);
+        return;
+    }
+    std::default_random_engine gen; // NOLINT
+    std::uniform_real_distribution<float> rand(0.0f, duration);
+    std::vector<float> times(1024);
+    for (float& t : times) {
+        t = rand(gen);
+    }
+    TransformManager& tcm = engine->getTransformManager();
+    tcm.openLocalTransformTransaction();
+    size_t i = 0;
+    for (auto _ : state) {
+        float const t = times[i++ % times.size()];
+        for (Animator* animator : animators) {
+            animator->sampleAnimation(0, t);
+        }
+    }
+    tcm.commitLocalTransformTransaction();
+    state.SetItemsProcessed(int64_t(state.iterations() * animators.size() * channelCount));
+}
+
+// The argument is the number of JobSystem worker threads, to show the scaling with core count.
+BENCHMARK_REGISTER_F(AnimatorFixture, updateSerial)->Arg(1);
+BENCHMARK_REGISTER_F(AnimatorFixture, updateJobs)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+BENCHMARK_REGISTER_F(AnimatorFixture, samplePlayback)->Arg(0);
+BENCHMARK_REGISTER_F(AnimatorFixture, sampleSeek)->Arg(0);
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <filament/Engine.h>
+
+#include <gltfio/AssetLoader.h>
+#include <gltfio/FilamentAsset.h>
+#include <gltfio/MaterialProvider.h>
+#include <gltfio/ResourceLoader.h>
+#include <gltfio/TextureProvider.h>
+
+#include <utils/EntityManager.h>
+#include <utils/NameComponentManager.h>
+
+#include <cgltf.h>
+
+#include "materials/uberarchive.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <vector>
+
+using namespace filament;
+using namespace filament::gltfio;
+using namespace utils;
+
+// Cost of ResourceLoader::loadResources() on a glTF with Draco-compressed meshes and jpeg
+// textures, the geometry and the textures being decoded on the JobSystem.
+// The argument is the number of JobSystem worker threads, to show the scaling with core count.
+// The timed region is the whole loadResources(), including the jpeg decoding and the wait for the
+// textures, not the geometry decoding alone. So the counters report the size of the compressed
+// geometry over the load time (i.e. the load throughput of this model), in total and per thread.
+class ResourceLoaderFixture : public benchmark::Fixture {
+protected:
+    Engine* engine = nullptr;
+    NameComponentManager* names = nullptr;
+    MaterialProvider* materials = nullptr;
+    AssetLoader* assetLoader = nullptr;
+    ResourceLoader* resourceLoader = nullptr;
+    TextureProvider* stbDecoder = nullptr;
+    TextureProvider* ktxDecoder = nullptr;
+    std::vector<uint8_t> content;
+    size_t compressedSize = 0;
+
+    // size of the Draco and meshopt data, each compressed buffer view is counted once
+    static size_t getCompressedSize(std::vector<uint8_t> const& content) {
+        cgltf_options options{};
+        cgltf_data* gltf = nullptr;
+        if (cgltf_parse(&options, content.data(), content.size(), &gltf) != cgltf_result_success) {
+            return 0;
+        }
+        std::set<cgltf_buffer_view const*> views;
+        for (cgltf_size i = 0; i < gltf->meshes_count; i++) {
+            cgltf_mesh const& mesh = gltf->meshes[i];
+            for (cgltf_size j = 0; j < mesh.primitives_count; j++) {
+                if (mesh.primitives[j].has_draco_mesh_compression) {
+                    views.insert(mesh.primitives[j].draco_mesh_compression.buffer_view);
+                }
+            }
+        }
+        size_t size = 0;
+        for (cgltf_buffer_view const* view : views) {
+            size += view->size;
+        }
+        for (cgltf_size i = 0; i < gltf->buffer_views_count; i++) {
+            if (gltf->buffer_views[i].has_meshopt_compression) {
+                size += gltf->buffer_views[i].meshopt_compression.size;
+            }
+        }
+        cgltf_free(gltf);
+        return size;
+    }
+
+public:
+    void SetUp(const benchmark::State& state) override {
+        Engine::Config config;
+        config.jobSystemThreadCount = uint32_t(state.range(0));
+        engine = Engine::Builder()
+                .backend(Engine::Backend::NOOP)
+                .config(&config)
+                .build();
+
+        names = new NameComponentManager(EntityManager::get());
+        materials = createUbershaderProvider(engine,
+                UBERARCHIVE_DEFAULT_DATA, UBERARCHIVE_DEFAULT_SIZE);
+        assetLoader = AssetLoader::create({ engine, materials, names });
+        resourceLoader = new ResourceLoader({ engine, GLTFIO_BENCHMARK_MODEL, false });
+        stbDecoder = createStbProvider(engine);
+        ktxDecoder = createKtx2Provider(engine);
+        resourceLoader->addTextureProvider("image/png", stbDecoder);
+        resourceLoader->addTextureProvider("image/jpeg", stbDecoder);
+        resourceLoader->addTextureProvider("image/ktx2", ktxDecoder);
+
+        std::ifstream in(GLTFIO_BENCHMARK_MODEL, std::ifstream::binary | std::ifstream::in);
+        content.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        compressedSize = getCompressedSize(content);
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        delete resourceLoader;
+        delete stbDecoder;
+        delete ktxDecoder;
+        AssetLoader::destroy(&assetLoader);
+        materials->destroyMaterials();
+        delete materials;
+        delete names;
+        Engine::destroy(&engine);
+    }
+};
+
+BENCHMARK_DEFINE_F(ResourceLoaderFixture, loadResources)(benchmark::State& state) {
+    if (content.empty()) {
+        state.SkipWithError("Unable to read " GLTFIO_BENCHMARK_MODEL);
+        return;
+    }
+    for (auto _ : state) {
+        state.PauseTiming();
+        FilamentAsset* asset = assetLoader->createAsset(content.data(), content.size());
+        state.ResumeTiming();
+
+        resourceLoader->loadResources(asset);
+
+        state.PauseTiming();
+        resourceLoader->evictResourceData();
+        assetLoader->destroyAsset(asset);
+        engine->flushAndWait();
+        state.ResumeTiming();
+    }
+    double const threads = double(std::max(state.range(0), int64_t(1)));
+    state.counters["compressedLoad"] = benchmark::Counter(double(compressedSize),
+            benchmark::Counter::kIsIterationInvariantRate, benchmark::Counter::kIs1024);
+    state.counters["compressedLoad/thread"] = benchmark::Counter(double(compressedSize) / threads,
+            benchmark::Counter::kIsIterationInvariantRate, benchmark::Counter::kIs1024);
+}
+
+BENCHMARK_REGISTER_F(ResourceLoaderFixture, loadResources)
+        ->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond);
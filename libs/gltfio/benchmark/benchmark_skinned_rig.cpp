@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <filament/Engine.h>
+
+#include <gltfio/Animator.h>
+#include <gltfio/AssetLoader.h>
+#include <gltfio/FilamentAsset.h>
+#include <gltfio/FilamentInstance.h>
+#include <gltfio/MaterialProvider.h>
+#include <gltfio/ResourceLoader.h>
+
+#include <utils/EntityManager.h>
+#include <utils/NameComponentManager.h>
+
+#include <math/mat4.h>
+#include <math/quat.h>
+#include <math/vec3.h>
+
+#include "materials/uberarchive.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace filament;
+using namespace filament::gltfio;
+using namespace filament::math;
+using namespace utils;
+
+// Evaluation of the rotation channels of a skinned rig, one channel per bone, through the public
+// Animator API only (applyAnimation and updateBoneMatrices), so that this file also builds against
+// the trees that predate the flattened keyframe tracks. The evaluators are compared by running it
+// before and after that change.
+//  - playback : the time moves forward by a frame
+//  - seek : the time is random
+class SkinnedRigFixture : public benchmark::Fixture {
+protected:
+    static constexpr uint32_t BONE_COUNT = 200;
+    static constexpr uint32_t KEYFRAME_COUNT = 30;
+    static constexpr float DURATION = 1.0f;
+    static constexpr float BONE_LENGTH = 0.1f;
+    static constexpr float FRAME_TIME = 1.0f / 60.0f;
+
+    Engine* engine = nullptr;
+    NameComponentManager* names = nullptr;
+    MaterialProvider* materials = nullptr;
+    AssetLoader* assetLoader = nullptr;
+    ResourceLoader* resourceLoader = nullptr;
+    FilamentAsset* asset = nullptr;
+    Animator* animator = nullptr;
+    float time = 0.0f;
+
+    // A chain of BONE_COUNT joints skinning one triangle each, with a rotation channel per joint.
+    static std::vector<uint8_t> createRig() {
+        constexpr uint32_t vertexCount = BONE_COUNT * 3;
+        std::vector<uint8_t> bin;
+        auto append = [&bin](const void* data, size_t size) {
+            size_t const offset = bin.size();
+            bin.resize(offset + size);
+            memcpy(bin.data() + offset, data, size);
+            return offset;
+        };
+
+        std::vector<float3> positions(vertexCount);
+        std::vector<ushort4> joints(vertexCount);
+        std::vector<float4> weights(vertexCount, float4{ 1, 0, 0, 0 });
+        std::vector<uint16_t> indices(vertexCount);
+        std::vector<mat4f> inverseBindMatrices(BONE_COUNT);
+        for (uint32_t j = 0; j < BONE_COUNT; j++) {
+            float const y = BONE_LENGTH * float(j + 1);
+            positions[j * 3 + 0] = { -0.05f, y, 0 };
+            positions[j * 3 + 1] = { 0.05f, y, 0 };
+            positions[j * 3 + 2] = { 0, y + BONE_LENGTH, 0 };
+            for (uint32_t k = 0; k < 3; k++) {
+                joints[j * 3 + k] = { uint16_t(j), 0, 0, 0 };
+                indices[j * 3 + k] = uint16_t(j * 3 + k);
+            }
+            inverseBindMatrices[j] = mat4f::translation(float3{ 0, -y, 0 });
+        }
+        std::vector<float> times(KEYFRAME_COUNT);
+        std::vector<quatf> rotations(BONE_COUNT * KEYFRAME_COUNT);
+        for (uint32_t k = 0; k < KEYFRAME_COUNT; k++) {
+            times[k] = DURATION * float(k) / float(KEYFRAME_COUNT - 1);
+            for (uint32_t j = 0; j < BONE_COUNT; j++) {
+                float const angle = 0.2f * std::sin(6.2831853f * times[k] + 0.1f * float(j));
+                rotations[j * KEYFRAME_COUNT + k] = quatf::fromAxisAngle(float3{ 0, 0, 1 }, angle);
+            }
+        }
+
+        size_t const positionsOffset = append(positions.data(), positions.size() * sizeof(float3));
+        size_t const jointsOffset = append(joints.data(), joints.size() * sizeof(ushort4));
+        size_t const weightsOffset = append(weights.data(), weights.size() * sizeof(float4));
+        size_t const indicesOffset = append(indices.data(), indices.size() * sizeof(uint16_t));
+        size_t const ibmOffset = append(inverseBindMatrices.data(), BONE_COUNT * sizeof(mat4f));
+        size_t const timesOffset = append(times.data(), times.size() * sizeof(float));
+        size_t const rotationsOffset = append(rotations.data(), rotations.size() * sizeof(quatf));
+
+        auto view = [](size_t offset, size_t length) {
+            return R"({"buffer":0,"byteOffset":)" + std::to_string(offset) +
+                    R"(,"byteLength":)" + std::to_string(length) + "}";
+        };
+        std::string nodes = R"({"mesh":0,"skin":0})";
+        std::string skinJoints;
+        std::string channels;
+        std::string samplers;
+        std::string rotationAccessors;
+        for (uint32_t j = 0; j < BONE_COUNT; j++) {
+            uint32_t const node = j + 1;
+            nodes += R"(,{"translation":[0,)" + std::to_string(BONE_LENGTH) + ",0]";
+            if (j + 1 < BONE_COUNT) {
+                nodes += R"(,"children":[)" + std::to_string(node + 1) + "]";
+            }
+            nodes += "}";
+            std::string const sep = j ? "," : "";
+            skinJoints += sep + std::to_string(node);
+            channels += sep + R"({"sampler":)" + std::to_string(j) +
+                    R"(,"target":{"node":)" + std::to_string(node) + R"(,"path":"rotation"}})";
+            samplers += sep + R"({"input":5,"output":)" + std::to_string(6 + j) + "}";
+            rotationAccessors += R"(,{"bufferView":6,"byteOffset":)" +
+                    std::to_string(j * KEYFRAME_COUNT * sizeof(quatf)) +
+                    R"(,"componentType":5126,"count":)" + std::to_string(KEYFRAME_COUNT) +
+                    R"(,"type":"VEC4"})";
+        }
+        float const top = BONE_LENGTH * float(BONE_COUNT + 1);
+        std::string json = R"({"asset":{"version":"2.0"},"scene":0,"scenes":[{"nodes":[0,1]}],)"
+                R"("nodes":[)" + nodes + "],"
+                R"("meshes":[{"primitives":[{"attributes":{"POSITION":0,"JOINTS_0":1,"WEIGHTS_0":2},"indices":3}]}],)"
+                R"("skins":[{"inverseBindMatrices":4,"joints":[)" + skinJoints + "]}],"
+                R"("animations":[{"channels":[)" + channels + R"(],"samplers":[)" + samplers + "]}],"
+                R"("accessors":[)"
+                R"({"bufferView":0,"componentType":5126,"count":)" + std::to_string(vertexCount) +
+                R"(,"type":"VEC3","min":[-0.05,)" + std::to_string(BONE_LENGTH) +
+                R"(,0],"max":[0.05,)" + std::to_string(top) + ",0]},"
+                R"({"bufferView":1,"componentType":5123,"count":)" + std::to_string(vertexCount) +
+                R"(,"type":"VEC4"},)"
+                R"({"bufferView":2,"componentType":5126,"count":)" + std::to_string(vertexCount) +
+                R"(,"type":"VEC4"},)"
+                R"({"bufferView":3,"componentType":5123,"count":)" + std::to_string(vertexCount) +
+                R"(,"type":"SCALAR"},)"
+                R"({"bufferView":4,"componentType":5126,"count":)" + std::to_string(BONE_COUNT) +
+                R"(,"type":"MAT4"},)"
+                R"({"bufferView":5,"componentType":5126,"count":)" + std::to_string(KEYFRAME_COUNT) +
+                R"(,"type":"SCALAR","min":[0],"max":[)" + std::to_string(DURATION) + "]}" +
+                rotationAccessors + "],"
+                R"("bufferViews":[)" +
+                view(positionsOffset, positions.size() * sizeof(float3)) + "," +
+                view(jointsOffset, joints.size() * sizeof(ushort4)) + "," +
+                view(weightsOffset, weights.size() * sizeof(float4)) + "," +
+                view(indicesOffset, indices.size() * sizeof(uint16_t)) + "," +
+                view(ibmOffset, BONE_COUNT * sizeof(mat4f)) + "," +
+                view(timesOffset, times.size() * sizeof(float)) + "," +
+                view(rotationsOffset, rotations.size() * sizeof(quatf)) + "],"
+                R"("buffers":[{"byteLength":)" + std::to_string(bin.size()) + "}]}";
+
+        // GLB container: the chunks are padded to 4 bytes
+        json.resize((json.size() + 3) & ~size_t(3), ' ');
+        bin.resize((bin.size() + 3) & ~size_t(3), 0);
+        std::vector<uint8_t> glb;
+        auto appendU32 = [&glb](uint32_t value) {
+            uint8_t const* bytes = (uint8_t const*) &value;
+            glb.insert(glb.end(), bytes, bytes + 4);
+        };
+        appendU32(0x46546C67);  // "glTF"
+        appendU32(2);
+        appendU32(uint32_t(12 + 8 + json.size() + 8 + bin.size()));
+        appendU32(uint32_t(json.size()));
+        appendU32(0x4E4F534A);  // "JSON"
+        glb.insert(glb.end(), json.begin(), json.end());
+        appendU32(uint32_t(bin.size()));
+        appendU32(0x004E4942);  // "BIN"
+        glb.insert(glb.end(), bin.begin(), bin.end());
+        return glb;
+    }
+
+public:
+    void SetUp(const benchmark::State& state) override {
+        engine = Engine::create(Engine::Backend::NOOP);
+        names = new NameComponentManager(EntityManager::get());
+        materials = createUbershaderProvider(engine,
+                UBERARCHIVE_DEFAULT_DATA, UBERARCHIVE_DEFAULT_SIZE);
+        assetLoader = AssetLoader::create({ engine, materials, names });
+        resourceLoader = new ResourceLoader({ engine, nullptr, false });
+
+        std::vector<uint8_t> const glb = createRig();
+        asset = assetLoader->createAsset(glb.data(), uint32_t(glb.size()));
+        if (!asset || !resourceLoader->loadResources(asset)) {
+            return;
+        }
+        animator = asset->getInstance()->getAnimator();
+        time = 0.0f;
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        animator = nullptr;
+        if (asset) {
+            assetLoader->destroyAsset(asset);
+            asset = nullptr;
+        }
+        delete resourceLoader;
+        AssetLoader::destroy(&assetLoader);
+        materials->destroyMaterials();
+        delete materials;
+        delete names;
+        Engine::destroy(&engine);
+    }
+};
+
+BENCHMARK_DEFINE_F(SkinnedRigFixture, playback)(benchmark::State& state) {
+    if (!animator || animator->getAnimationCount() == 0) {
+        state.SkipWithError("Unable to load the skinned rig");
+        return;
+    }
+    for (auto _ : state) {
+        time = std::fmod(time + FRAME_TIME, DURATION);
+        animator->applyAnimation(0, time);
+        animator->updateBoneMatrices();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * BONE_COUNT));
+}
+
+BENCHMARK_DEFINE_F(SkinnedRigFixture, seek)(benchmark::State& state) {
+    if (!animator || animator->getAnimationCount() == 0) {
+        state.SkipWithError("Unable to load the skinned rig");
+        return;
+    }
+    std::default_random_engine gen; // NOLINT
+    std::uniform_real_distribution<float> rand(0.0f, DURATION);
+    std::vector<float> times(1024);
+    for (float& t : times) {
+        t = rand(gen);
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        animator->applyAnimation(0, times[i++ % times.size()]);
+        animator->updateBoneMatrices();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * BONE_COUNT));
+}
+
+BENCHMARK_REGISTER_F(SkinnedRigFixture, playback);
+BENCHMARK_REGISTER_F(SkinnedRigFixture, seek);
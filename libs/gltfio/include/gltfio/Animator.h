@@ -82,6 +82,38 @@ public:
      */
     void resetBoneMatrices();
 
+    /**
+     * Staged counterpart of applyAnimation(), for updating many animators from a job system.
+     *
+     * Local transforms are written without opening or committing a local transform transaction,
+     * so the caller is expected to wrap the sampling of all animators between
+     * TransformManager::openLocalTransformTransaction() and commitLocalTransformTransaction().
+     * Morph weights are staged rather than sent to the RenderableManager, see uploadStagedData().
+     *
+     * Distinct animators (with disjoint target entities) may be sampled concurrently.
+     */
+    void sampleAnimation(size_t animationIndex, float time) const;
+
+    /**
+     * Staged counterpart of applyCrossFade(), with the same requirements as sampleAnimation().
+     */
+    void sampleCrossFade(size_t previousAnimIndex, float previousAnimTime, float alpha);
+
+    /**
+     * Staged counterpart of updateBoneMatrices(). The bone matrices are computed from the
+     * current world transforms and kept until uploadStagedData() is called.
+     *
+     * This only reads the TransformManager, so distinct animators may be computed concurrently
+     * once the local transform transaction has been committed.
+     */
+    void computeBoneMatrices();
+
+    /**
+     * Passes the staged morph weights and bone matrices into the RenderableManager, then clears
+     * the staging. This must be called from the thread that owns the Engine.
+     */
+    void uploadStagedData();
+
     /** Returns the number of \c animation definitions in the glTF asset. */
     size_t getAnimationCount() const;
 
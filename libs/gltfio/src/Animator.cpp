@@ -34,7 +34,7 @@
 #include <math/vec3.h>
 #include <math/vec4.h>
 
-#include <map>
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -45,12 +45,15 @@ using namespace utils;
 
 namespace filament::gltfio {
 
-using TimeValues = map<float, size_t>;
+using TimeValues = vector<float>;
 using SourceValues = vector<float>;
 using BoneVector = vector<mat4f>;
 
+// Keyframes are flattened into contiguous arrays: times are sorted and unique, keys[i] is the
+// index of the values of times[i] in the source data.
 struct Sampler {
     TimeValues times;
+    vector<uint32_t> keys;
     SourceValues values;
     enum { LINEAR, STEP, CUBIC } interpolation;
 };
@@ -59,6 +62,9 @@ struct Channel {
     const Sampler* sourceData;
     Entity targetEntity;
     enum { TRANSLATION, ROTATION, SCALE, WEIGHTS } transformType;
+    // index of the keyframe found by the last evaluation, which is where the next search
+    // starts from (playback is usually monotonic)
+    uint32_t cursor = 0;
 };
 
 struct Animation {
@@ -68,6 +74,13 @@ struct Animation {
     vector<Channel> channels;
 };
 
+// Morph weights or bone matrices waiting for uploadStagedData().
+struct StagedUpload {
+    RenderableManager::Instance renderable;
+    uint32_t offset;
+    uint32_t count;
+};
+
 struct AnimatorImpl {
     vector<Animation> animations;
     BoneVector boneMatrices;
@@ -77,10 +90,19 @@ struct AnimatorImpl {
     TransformManager* transformManager;
     TrsTransformManager* trsTransformManager;
     vector<float> weights;
+    vector<Entity> dirtyTargets;
     FixedCapacityVector<mat4f> crossFade;
+    bool stageUploads = false;
+    vector<StagedUpload> stagedWeights;
+    vector<float> stagedWeightValues;
+    vector<StagedUpload> stagedBones;
+    BoneVector stagedBoneValues;
     void addChannels(const FixedCapacityVector<Entity>& nodeMap, const cgltf_animation& srcAnim,
             Animation& dst);
     void applyAnimation(const Channel& channel, float t, size_t prevIndex, size_t nextIndex);
+    void sampleAnimation(size_t animationIndex, float time);
+    void setMorphWeights(RenderableManager::Instance renderable);
+    void setBones(RenderableManager::Instance renderable);
     void stashCrossFade();
     void applyCrossFade(float alpha);
     void resetBoneMatrices(FFilamentInstance* instance);
@@ -88,7 +110,7 @@ struct AnimatorImpl {
 };
 
 static void createSampler(const cgltf_animation_sampler& src, Sampler& dst) {
-    // Copy the time values into a red-black tree.
+    // Copy the time values into sorted arrays.
     const cgltf_accessor* timelineAccessor = src.input;
     const uint8_t* timelineBlob = nullptr;
     const float* timelineFloats = nullptr;
@@ -100,8 +122,27 @@ static void createSampler(const cgltf_animation_sampler& src, Sampler& dst) {
         timelineFloats = (const float*) (timelineBlob + timelineAccessor->offset +
                 timelineAccessor->buffer_view->offset);
     }
-    for (size_t i = 0, len = timelineAccessor->count; i < len; ++i) {
-        dst.times[timelineFloats[i]] = i;
+    // glTF requires strictly increasing times, but this tolerates unsorted or repeated times
+    // (the last keyframe of a repeated time is used).
+    const size_t timeCount = timelineAccessor->count;
+    vector<uint32_t> order(timeCount);
+    for (size_t i = 0; i < timeCount; ++i) {
+        order[i] = uint32_t(i);
+    }
+    if (!std::is_sorted(timelineFloats, timelineFloats + timeCount)) {
+        std::stable_sort(order.begin(), order.end(), [timelineFloats](uint32_t a, uint32_t b) {
+            return timelineFloats[a] < timelineFloats[b];
+        });
+    }
+    dst.times.reserve(timeCount);
+    dst.keys.reserve(timeCount);
+    for (uint32_t i : order) {
+        if (!dst.times.empty() && dst.times.back() == timelineFloats[i]) {
+            dst.keys.back() = i;
+            continue;
+        }
+        dst.times.push_back(timelineFloats[i]);
+        dst.keys.push_back(i);
     }
 
     // Convert source data to float.
@@ -160,6 +201,22 @@ static void setTransformType(const cgltf_animation_channel& src, Channel& dst) {
     }
 }
 
+// Returns the index of the first keyframe at or after the given time (times.size() if none).
+// The cursor of the previous evaluation is checked first, along with the keyframe after it,
+// before falling back to a binary search.
+static size_t findKeyframe(const TimeValues& times, float time, uint32_t& cursor) {
+    const size_t count = times.size();
+    auto isLowerBound = [&times, count, time](size_t i) {
+        return i <= count && (i == 0 || times[i - 1] < time) && (i == count || times[i] >= time);
+    };
+    size_t index = cursor;
+    if (!isLowerBound(index) && !isLowerBound(++index)) {
+        index = std::lower_bound(times.begin(), times.end(), time) - times.begin();
+    }
+    cursor = uint32_t(index);
+    return index;
+}
+
 static bool validateAnimation(const cgltf_animation& anim) {
     for (cgltf_size j = 0; j < anim.channels_count; ++j) {
         const cgltf_animation_channel& channel = anim.channels[j];
@@ -222,7 +279,7 @@ Animator::Animator(FFilamentAsset const* asset, FFilamentInstance* instance) {
             Sampler& dstSampler = dstAnim.samplers[j];
             createSampler(srcSampler, dstSampler);
             if (dstSampler.times.size() > 1) {
-                float maxtime = (--dstSampler.times.end())->first;
+                float maxtime = dstSampler.times.back();
                 dstAnim.duration = std::max(dstAnim.duration, maxtime);
             }
         }
@@ -263,51 +320,24 @@ size_t Animator::getAnimationCount() const {
 }
 
 void Animator::applyAnimation(size_t animationIndex, float time) const {
-    const Animation& anim = mImpl->animations[animationIndex];
-    time = fmod(time, anim.duration);
     TransformManager& transformManager = *mImpl->transformManager;
     transformManager.openLocalTransformTransaction();
-    for (const auto& channel : anim.channels) {
-        const Sampler* sampler = channel.sourceData;
-        if (sampler->times.size() < 2) {
-            continue;
-        }
-
-        const TimeValues& times = sampler->times;
-
-        // Find the first keyframe after the given time, or the keyframe that matches it exactly.
-        TimeValues::const_iterator iter = times.lower_bound(time);
-
-        // Compute the interpolant (between 0 and 1) and determine the keyframe pair.
-        float t = 0.0f;
-        size_t nextIndex;
-        size_t prevIndex;
-        if (iter == times.end()) {
-            nextIndex = times.size() - 1;
-            prevIndex = nextIndex;
-        } else if (iter == times.begin()) {
-            nextIndex = 0;
-            prevIndex = 0;
-        } else {
-            TimeValues::const_iterator prev = iter; --prev;
-            nextIndex = iter->second;
-            prevIndex = prev->second;
-            const float nextTime = iter->first;
-            const float prevTime = prev->first;
-            float deltaTime = nextTime - prevTime;
-            assert(deltaTime >= 0);
-            if (deltaTime > 0) {
-                t = (time - prevTime) / deltaTime;
-            }
-        }
+    mImpl->sampleAnimation(animationIndex, time);
+    transformManager.commitLocalTransformTransaction();
+}
 
-        if (sampler->interpolation == Sampler::STEP) {
-            t = 0.0f;
-        }
+void Animator::sampleAnimation(size_t animationIndex, float time) const {
+    mImpl->stageUploads = true;
+    mImpl->sampleAnimation(animationIndex, time);
+    mImpl->stageUploads = false;
+}
 
-        mImpl->applyAnimation(channel, t, prevIndex, nextIndex);
-    }
-    transformManager.commitLocalTransformTransaction();
+void Animator::sampleCrossFade(size_t previousAnimIndex, float previousAnimTime, float alpha) {
+    mImpl->stageUploads = true;
+    mImpl->stashCrossFade();
+    mImpl->sampleAnimation(previousAnimIndex, previousAnimTime);
+    mImpl->applyCrossFade(alpha);
+    mImpl->stageUploads = false;
 }
 
 void Animator::resetBoneMatrices() {
@@ -336,6 +366,28 @@ void Animator::updateBoneMatrices() {
     }
 }
 
+void Animator::computeBoneMatrices() {
+    mImpl->stageUploads = true;
+    updateBoneMatrices();
+    mImpl->stageUploads = false;
+}
+
+void Animator::uploadStagedData() {
+    RenderableManager& renderableManager = *mImpl->renderableManager;
+    for (const StagedUpload& upload : mImpl->stagedWeights) {
+        renderableManager.setMorphWeights(upload.renderable,
+                mImpl->stagedWeightValues.data() + upload.offset, upload.count);
+    }
+    for (const StagedUpload& upload : mImpl->stagedBones) {
+        renderableManager.setBones(upload.renderable,
+                mImpl->stagedBoneValues.data() + upload.offset, upload.count);
+    }
+    mImpl->stagedWeights.clear();
+    mImpl->stagedWeightValues.clear();
+    mImpl->stagedBones.clear();
+    mImpl->stagedBoneValues.clear();
+}
+
 float Animator::getAnimationDuration(size_t animationIndex) const {
     return mImpl->animations[animationIndex].duration;
 }
@@ -344,6 +396,63 @@ const char* Animator::getAnimationName(size_t animationIndex) const {
     return mImpl->animations[animationIndex].name.c_str();
 }
 
+void AnimatorImpl::sampleAnimation(size_t animationIndex, float time) {
+    Animation& anim = animations[animationIndex];
+    time = fmod(time, anim.duration);
+    dirtyTargets.clear();
+    for (auto& channel : anim.channels) {
+        const Sampler* sampler = channel.sourceData;
+        if (sampler->times.size() < 2) {
+            continue;
+        }
+
+        const TimeValues& times = sampler->times;
+
+        // Find the first keyframe after the given time, or the keyframe that matches it exactly.
+        const size_t iter = findKeyframe(times, time, channel.cursor);
+
+        // Compute the interpolant (between 0 and 1) and determine the keyframe pair.
+        float t = 0.0f;
+        size_t nextIndex;
+        size_t prevIndex;
+        if (iter == times.size()) {
+            nextIndex = sampler->keys[times.size() - 1];
+            prevIndex = nextIndex;
+        } else if (iter == 0) {
+            nextIndex = sampler->keys[0];
+            prevIndex = nextIndex;
+        } else {
+            nextIndex = sampler->keys[iter];
+            prevIndex = sampler->keys[iter - 1];
+            const float nextTime = times[iter];
+            const float prevTime = times[iter - 1];
+            float deltaTime = nextTime - prevTime;
+            assert(deltaTime >= 0);
+            if (deltaTime > 0) {
+                t = (time - prevTime) / deltaTime;
+            }
+        }
+
+        if (sampler->interpolation == Sampler::STEP) {
+            t = 0.0f;
+        }
+
+        applyAnimation(channel, t, prevIndex, nextIndex);
+
+        // The translation, rotation and scale channels of a node are usually adjacent, so its
+        // transform is composed once rather than once per channel.
+        if (channel.transformType != Channel::WEIGHTS &&
+                (dirtyTargets.empty() || dirtyTargets.back() != channel.targetEntity)) {
+            dirtyTargets.push_back(channel.targetEntity);
+        }
+    }
+    for (Entity target : dirtyTargets) {
+        TrsTransformManager::Instance trsNode = trsTransformManager->getInstance(target);
+        TransformManager::Instance node = transformManager->getInstance(target);
+        transformManager->setTransform(node, trsTransformManager->getTransform(trsNode));
+    }
+}
+
 void AnimatorImpl::stashCrossFade() {
     using Instance = TransformManager::Instance;
     auto& tm = *this->transformManager;
@@ -436,7 +545,6 @@ void AnimatorImpl::applyAnimation(const Channel& channel, float t, size_t prevIn
     const Sampler* sampler = channel.sourceData;
     const TimeValues& times = sampler->times;
     TrsTransformManager::Instance trsNode = trsTransformManager->getInstance(channel.targetEntity);
-    TransformManager::Instance node = transformManager->getInstance(channel.targetEntity);
 
     switch (channel.transformType) {
 
@@ -517,13 +625,30 @@ void AnimatorImpl::applyAnimation(const Channel& channel, float t, size_t prevIn
                 }
             }
 
-            auto ci = renderableManager->getInstance(channel.targetEntity);
-            renderableManager->setMorphWeights(ci, weights.data(), weights.size());
+            setMorphWeights(renderableManager->getInstance(channel.targetEntity));
             return;
         }
     }
+}
 
-    transformManager->setTransform(node, trsTransformManager->getTransform(trsNode));
+void AnimatorImpl::setMorphWeights(RenderableManager::Instance renderable) {
+    if (!stageUploads) {
+        renderableManager->setMorphWeights(renderable, weights.data(), weights.size());
+        return;
+    }
+    stagedWeights.push_back({ renderable, uint32_t(stagedWeightValues.size()),
+            uint32_t(weights.size()) });
+    stagedWeightValues.insert(stagedWeightValues.end(), weights.begin(), weights.end());
+}
+
+void AnimatorImpl::setBones(RenderableManager::Instance renderable) {
+    if (!stageUploads) {
+        renderableManager->setBones(renderable, boneMatrices.data(), boneMatrices.size());
+        return;
+    }
+    stagedBones.push_back({ renderable, uint32_t(stagedBoneValues.size()),
+            uint32_t(boneMatrices.size()) });
+    stagedBoneValues.insert(stagedBoneValues.end(), boneMatrices.begin(), boneMatrices.end());
 }
 
 void AnimatorImpl::resetBoneMatrices(FFilamentInstance* instance) {
@@ -568,7 +693,7 @@ void AnimatorImpl::updateBoneMatrices(FFilamentInstance* instance) {
                         mat4f{ inverseGlobalTransform * globalJointTransform } *
                         inverseBindMatrix;
             }
-            renderableManager->setBones(renderable, boneMatrices.data(), boneMatrices.size());
+            setBones(renderable);
         }
     }
 }
@@ -38,15 +38,22 @@ using namespace utils;
 namespace filament::gltfio {
 
 DracoMesh* DracoCache::findOrCreateMesh(const cgltf_buffer_view* key) {
-    auto iter = mCache.find(key);
-    if (iter != mCache.end()) {
-        return iter->second.get();
+    Entry* entry;
+    {
+        std::lock_guard<std::mutex> const lock(mLock);
+        auto iter = mCache.find(key);
+        if (iter == mCache.end()) {
+            iter = mCache.emplace(key, std::make_unique<Entry>()).first;
+        }
+        entry = iter->second.get();
     }
-    assert(key->buffer && key->buffer->data);
-    const uint8_t* compressedData = key->offset + (uint8_t*) key->buffer->data;
-    DracoMesh* mesh = DracoMesh::decode(compressedData, key->size);
-    mCache.emplace(key, mesh);
-    return mesh;
+    // The decoding happens outside of the lock, so that different meshes are decoded in parallel.
+    std::call_once(entry->decoded, [entry, key] {
+        assert(key->buffer && key->buffer->data);
+        const uint8_t* compressedData = key->offset + (uint8_t*) key->buffer->data;
+        entry->mesh.reset(DracoMesh::decode(compressedData, key->size));
+    });
+    return entry->mesh.get();
 }
 
 DracoMesh::DracoMesh(struct DracoMeshDetails* details) : mDetails(details) {}
@@ -22,6 +22,7 @@
 #include <tsl/robin_map.h>
 
 #include <memory>
+#include <mutex>
 
 #ifndef GLTFIO_DRACO_SUPPORTED
 #define GLTFIO_DRACO_SUPPORTED 0
@@ -35,11 +36,19 @@ class DracoMesh;
 //
 // The cache key is the buffer view that holds the compressed data. This allows the loader to
 // avoid duplicated work when a single Draco mesh is referenced from multiple primitives.
+//
+// findOrCreateMesh can be called from several threads: a mesh is decoded only once, by the first
+// caller, while the other callers of the same key wait for it.
 class DracoCache {
 public:
     DracoMesh* findOrCreateMesh(const cgltf_buffer_view* key);
 private:
-    tsl::robin_map<const cgltf_buffer_view*, std::unique_ptr<DracoMesh>> mCache;
+    struct Entry {
+        std::once_flag decoded;
+        std::unique_ptr<DracoMesh> mesh;
+    };
+    std::mutex mLock;
+    tsl::robin_map<const cgltf_buffer_view*, std::unique_ptr<Entry>> mCache;
 };
 
 // Decodes a Draco mesh upon construction and retains the results.
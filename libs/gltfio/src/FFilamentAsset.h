@@ -290,6 +290,9 @@ struct FFilamentAsset : public FilamentAsset {
         cgltf_data* hierarchy;
         DracoCache dracoCache;
         utils::FixedCapacityVector<uint8_t> glbData;
+        // Keeps an external source blob alive (e.g. a memory-mapped file) when it is parsed in place
+        // rather than copied into glbData. Released after the hierarchy.
+        std::shared_ptr<void> glbOwner;
     };
 
     // We used shared ownership for the raw cgltf data in order to permit ResourceLoader to
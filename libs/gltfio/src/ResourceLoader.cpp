@@ -48,11 +48,15 @@
 #include <math/vec4.h>
 
 #include <tsl/robin_map.h>
+#include <tsl/robin_set.h>
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 
 using namespace filament;
 using namespace filament::math;
@@ -81,11 +85,13 @@ struct ResourceLoader::Impl {
     explicit Impl(const ResourceConfiguration& config) :
         mEngine(config.engine),
         mNormalizeSkinningWeights(config.normalizeSkinningWeights),
+        mOptimizeMeshes(config.optimizeMeshes),
         mGltfPath(config.gltfPath ? config.gltfPath : ""),
         mUriDataCache(std::make_shared<UriDataCache>()) {}
 
     Engine* const mEngine;
     bool mNormalizeSkinningWeights;
+    bool mOptimizeMeshes;
     std::string mGltfPath;
 
     // User-provided resource data with URI string keys, populated with addResourceData().
@@ -103,8 +109,11 @@ struct ResourceLoader::Impl {
     size_t mRemainingTextureDownloads = 0;
 
     void addResourceData(const char* uri, BufferDescriptor&& buffer);
+    void decodeGeometry(FFilamentAsset* asset);
+    void optimizeGeometry(FFilamentAsset* asset);
     void computeTangents(FFilamentAsset* asset);
-    void createTextures(FFilamentAsset* asset, bool async);
+    void createTextures(FFilamentAsset* asset);
+    void waitForTextures();
     void cancelTextureDecoding();
     std::pair<Texture*, CacheResult> getOrCreateTexture(FFilamentAsset* asset, size_t textureIndex,
             TextureProvider::TextureFlags flags);
@@ -328,6 +337,7 @@ ResourceLoader::~ResourceLoader() {
 
 void ResourceLoader::setConfiguration(const ResourceConfiguration& config) {
     pImpl->mNormalizeSkinningWeights = config.normalizeSkinningWeights;
+    pImpl->mOptimizeMeshes = config.optimizeMeshes;
     pImpl->mGltfPath = config.gltfPath;
 }
 
@@ -378,7 +388,7 @@ void ResourceLoader::Impl::addResourceData(const char* uri, BufferDescriptor&& b
 
     // If this is a texture and async loading has already started, add a new decoder job.
     if (isTexture(uri) && mAsyncAsset && mRemainingTextureDownloads > 0) {
-        createTextures(mAsyncAsset, true);
+        createTextures(mAsyncAsset);
     }
 }
 
@@ -427,21 +437,26 @@ bool ResourceLoader::loadResources(FFilamentAsset* asset, bool async) {
 
     cgltf_data const* gltf = asset->mSourceAsset->hierarchy;
 
+    // If any decoding jobs are still underway from a previous load, wait for them to finish.
+    for (const auto& iter: pImpl->mTextureProviders) {
+        iter.second->waitForCompletion();
+        iter.second->updateQueue();
+    }
+
     if (!isExtendedAlgo) {
         utility::loadCgltfBuffers(gltf, pImpl->mGltfPath.c_str(), pImpl->mUriDataCache);
 
+        // Create Filament Textures and begin decoding image files, which happens on the JobSystem
+        // while the geometry is decoded below.
+        pImpl->createTextures(asset);
+
         // Decompress Draco meshes early on, which allows us to exploit subsequent processing such
         // as tangent generation.
-        DracoCache* dracoCache = &asset->mSourceAsset->dracoCache;
-        auto& primitives = std::get<FFilamentAsset::ResourceInfo>(asset->mResourceInfo).mPrimitives;
-        // Go through every primitive and check if it has a Draco mesh.
-        for (auto& [prim, vertexBuffer]: primitives) {
-            if (!prim->has_draco_mesh_compression) {
-                continue;
-            }
-            utility::decodeDracoMeshes(gltf, prim, dracoCache);
+        pImpl->decodeGeometry(asset);
+
+        if (pImpl->mOptimizeMeshes) {
+            pImpl->optimizeGeometry(asset);
         }
-        utility::decodeMeshoptCompression((cgltf_data*) gltf);
 
         uploadBuffers(asset, *pImpl->mEngine, pImpl->mUriDataCache);
 
@@ -455,18 +470,19 @@ bool ResourceLoader::loadResources(FFilamentAsset* asset, bool async) {
     } else {
         auto& slots = std::get<FFilamentAsset::ResourceInfoExtended>(asset->mResourceInfo).slots;
         ResourceLoaderExtended::loadResources(slots, pImpl->mEngine, asset->mBufferObjects);
+
+        // Create Filament Textures and begin loading image files.
+        pImpl->createTextures(asset);
     }
 
     createSkins(gltf, pImpl->mNormalizeSkinningWeights, asset->mSkins);
 
-    // If any decoding jobs are still underway from a previous load, wait for them to finish.
-    for (const auto& iter: pImpl->mTextureProviders) {
-        iter.second->waitForCompletion();
-        iter.second->updateQueue();
-    }
+    // Non-threaded systems are required to use the asynchronous API.
+    assert_invariant(UTILS_HAS_THREADING || async);
 
-    // Finally, create Filament Textures and begin loading image files.
-    pImpl->createTextures(asset, async);
+    if (!async) {
+        pImpl->waitForTextures();
+    }
 
     // Non-textured renderables are now considered ready, and we can guarantee that no new
     // materials or textures will be added. Notify the dependency graph.
@@ -633,7 +649,7 @@ void ResourceLoader::Impl::cancelTextureDecoding() {
     mAsyncAsset = nullptr;
 }
 
-void ResourceLoader::Impl::createTextures(FFilamentAsset* asset, bool async) {
+void ResourceLoader::Impl::createTextures(FFilamentAsset* asset) {
     mRemainingTextureDownloads = 0;
 
     // Create new texture objects if they are not cached and kick off decoding jobs.
@@ -659,20 +675,222 @@ void ResourceLoader::Impl::createTextures(FFilamentAsset* asset, bool async) {
             asset->applyTextureBinding(textureIndex, slot);
         }
     }
+}
 
-    // Non-threaded systems are required to use the asynchronous API.
-    assert_invariant(UTILS_HAS_THREADING || async);
-
-    if (async) {
-        return;
-    }
-
+void ResourceLoader::Impl::waitForTextures() {
     for (const auto& iter : mTextureProviders) {
         iter.second->waitForCompletion();
         iter.second->updateQueue();
     }
 }
 
+void ResourceLoader::Impl::decodeGeometry(FFilamentAsset* asset) {
+    SYSTRACE_CALL();
+
+    cgltf_data* const gltf = asset->mSourceAsset->hierarchy;
+    DracoCache* const dracoCache = &asset->mSourceAsset->dracoCache;
+    auto const& primitives = std::get<FFilamentAsset::ResourceInfo>(asset->mResourceInfo).mPrimitives;
+
+    // Group the primitives by Draco mesh. A mesh is decoded once, and its primitives are processed
+    // by the same job because the decompressed data is converted into buffers owned by the mesh.
+    using DracoPrimitives = std::vector<const cgltf_primitive*>;
+    tsl::robin_map<const cgltf_buffer_view*, DracoPrimitives> dracoMeshes;
+    tsl::robin_map<const cgltf_accessor*, const cgltf_buffer_view*> accessorMeshes;
+    bool sharedAccessors = false;
+    for (auto const& [prim, vertexBuffer] : primitives) {
+        if (!prim->has_draco_mesh_compression) {
+            continue;
+        }
+        const cgltf_buffer_view* mesh = prim->draco_mesh_compression.buffer_view;
+        DracoPrimitives& meshPrimitives = dracoMeshes[mesh];
+        if (std::find(meshPrimitives.begin(), meshPrimitives.end(), prim) != meshPrimitives.end()) {
+            continue;
+        }
+        meshPrimitives.push_back(prim);
+
+        // An accessor filled by two different meshes (which is unusual) would be written by two
+        // jobs, in which case the meshes are decoded in parallel but converted serially.
+        auto addAccessor = [&](const cgltf_accessor* accessor) {
+            if (accessor) {
+                auto [iter, inserted] = accessorMeshes.try_emplace(accessor, mesh);
+                sharedAccessors = sharedAccessors || iter->second != mesh;
+            }
+        };
+        addAccessor(prim->indices);
+        for (cgltf_size i = 0; i < prim->attributes_count; i++) {
+            addAccessor(prim->attributes[i].data);
+        }
+    }
+
+    JobSystem& js = mEngine->getJobSystem();
+    JobSystem::Job* parent = js.createJob();
+    for (auto const& [mesh, meshPrimitives] : dracoMeshes) {
+        DracoPrimitives const* pprims = &meshPrimitives;
+        const cgltf_buffer_view* const key = mesh;
+        js.run(jobs::createJob(js, parent, [gltf, dracoCache, pprims, key, sharedAccessors] {
+            if (sharedAccessors) {
+                dracoCache->findOrCreateMesh(key);
+                return;
+            }
+            for (const cgltf_primitive* prim : *pprims) {
+                utility::decodeDracoMeshes(gltf, prim, dracoCache);
+            }
+        }));
+    }
+
+    // Each meshopt buffer view is decoded into its own memory.
+    for (cgltf_size i = 0; i < gltf->buffer_views_count; ++i) {
+        cgltf_buffer_view* const view = &gltf->buffer_views[i];
+        if (view->has_meshopt_compression) {
+            js.run(jobs::createJob(js, parent, [view] {
+                utility::decodeMeshoptCompression(view);
+            }));
+        }
+    }
+    js.runAndWait(parent);
+
+    if (sharedAccessors) {
+        // The meshes are in the cache at this point.
+        for (auto const& [mesh, meshPrimitives] : dracoMeshes) {
+            for (const cgltf_primitive* prim : meshPrimitives) {
+                utility::decodeDracoMeshes(gltf, prim, dracoCache);
+            }
+        }
+    }
+}
+
+void ResourceLoader::Impl::optimizeGeometry(FFilamentAsset* asset) {
+    SYSTRACE_CALL();
+
+    cgltf_data const* gltf = asset->mSourceAsset->hierarchy;
+
+    // The vertices of an accessor used by several primitives keep their order, and so do the
+    // triangles of a shared index buffer.
+    tsl::robin_map<const cgltf_accessor*, uint32_t> accessorUses;
+    for (cgltf_size i = 0; i < gltf->meshes_count; ++i) {
+        const cgltf_mesh& mesh = gltf->meshes[i];
+        for (cgltf_size j = 0; j < mesh.primitives_count; ++j) {
+            const cgltf_primitive& prim = mesh.primitives[j];
+            if (prim.indices) {
+                accessorUses[prim.indices]++;
+            }
+            for (cgltf_size k = 0; k < prim.attributes_count; ++k) {
+                accessorUses[prim.attributes[k].data]++;
+            }
+            for (cgltf_size t = 0; t < prim.targets_count; ++t) {
+                for (cgltf_size k = 0; k < prim.targets[t].attributes_count; ++k) {
+                    accessorUses[prim.targets[t].attributes[k].data]++;
+                }
+            }
+        }
+    }
+    auto isExclusive = [&accessorUses](const cgltf_accessor* accessor) {
+        return accessorUses[accessor] == 1;
+    };
+
+    struct PrimitiveOptimization {
+        const cgltf_mesh* mesh;
+        const cgltf_primitive* prim;
+        bool reorderVertices;
+        bool optimized;
+        utility::MeshStatistics before;
+        utility::MeshStatistics after;
+    };
+    std::vector<PrimitiveOptimization> optimizations;
+    for (cgltf_size i = 0; i < gltf->meshes_count; ++i) {
+        const cgltf_mesh& mesh = gltf->meshes[i];
+        for (cgltf_size j = 0; j < mesh.primitives_count; ++j) {
+            const cgltf_primitive& prim = mesh.primitives[j];
+            if (prim.has_draco_mesh_compression || !prim.indices || !isExclusive(prim.indices)) {
+                continue;
+            }
+            bool reorderVertices = true;
+            for (cgltf_size k = 0; k < prim.attributes_count; ++k) {
+                reorderVertices = reorderVertices && isExclusive(prim.attributes[k].data);
+            }
+            for (cgltf_size t = 0; t < prim.targets_count; ++t) {
+                for (cgltf_size k = 0; k < prim.targets[t].attributes_count; ++k) {
+                    reorderVertices = reorderVertices &&
+                            isExclusive(prim.targets[t].attributes[k].data);
+                }
+            }
+            optimizations.push_back({ &mesh, &prim, reorderVertices, false, {}, {} });
+        }
+    }
+
+    // The primitives are optimized in place, so the buffers that are written must belong to the
+    // loader. Those supplied by the application (through addResourceData, or a glb parsed in place
+    // from an external blob such as a mapped file) are replaced by a copy that cgltf will free.
+    auto const& sourceAsset = asset->mSourceAsset;
+    auto isLoaderOwned = [&sourceAsset](const cgltf_buffer* buffer) {
+        switch (buffer->data_free_method) {
+            case cgltf_data_free_method_memory_free:
+                return true;
+            case cgltf_data_free_method_file_release:
+                return bool(GLTFIO_USE_FILESYSTEM);
+            default: {
+                const uint8_t* data = (const uint8_t*) buffer->data;
+                const uint8_t* glb = sourceAsset->glbData.data();
+                return glb && data >= glb && data < glb + sourceAsset->glbData.size();
+            }
+        }
+    };
+    tsl::robin_set<cgltf_buffer*> writtenBuffers;
+    auto addWrittenBuffer = [&writtenBuffers](const cgltf_accessor* accessor) {
+        cgltf_buffer_view const* view = accessor->buffer_view;
+        if (view && !view->has_meshopt_compression && view->buffer->data) {
+            writtenBuffers.insert(view->buffer);
+        }
+    };
+    for (PrimitiveOptimization const& po : optimizations) {
+        addWrittenBuffer(po.prim->indices);
+        if (!po.reorderVertices) {
+            continue;
+        }
+        for (cgltf_size k = 0; k < po.prim->attributes_count; ++k) {
+            addWrittenBuffer(po.prim->attributes[k].data);
+        }
+        for (cgltf_size t = 0; t < po.prim->targets_count; ++t) {
+            for (cgltf_size k = 0; k < po.prim->targets[t].attributes_count; ++k) {
+                addWrittenBuffer(po.prim->targets[t].attributes[k].data);
+            }
+        }
+    }
+    cgltf_memory_options const& memory = gltf->memory;
+    for (cgltf_buffer* buffer : writtenBuffers) {
+        if (isLoaderOwned(buffer)) {
+            continue;
+        }
+        void* const copy = memory.alloc_func(memory.user_data, buffer->size);
+        memcpy(copy, buffer->data, buffer->size);
+        buffer->data = copy;
+        buffer->data_free_method = cgltf_data_free_method_memory_free;
+    }
+
+    JobSystem& js = mEngine->getJobSystem();
+    JobSystem::Job* parent = js.createJob();
+    for (PrimitiveOptimization& optimization : optimizations) {
+        PrimitiveOptimization* const po = &optimization;
+        js.run(jobs::createJob(js, parent, [po] {
+            po->optimized = utility::optimizePrimitive(po->prim, po->reorderVertices,
+                    &po->before, &po->after);
+        }));
+    }
+    js.runAndWait(parent);
+
+    for (PrimitiveOptimization const& po : optimizations) {
+        if (!po.optimized) {
+            continue;
+        }
+        slog.i << "Mesh " << (po.mesh->name ? po.mesh->name : "(unnamed)")
+               << " primitive " << (po.prim - po.mesh->primitives)
+               << ": ACMR " << po.before.acmr << " -> " << po.after.acmr
+               << ", overdraw " << po.before.overdraw << " -> " << po.after.overdraw
+               << ", bytes fetched " << po.before.bytesFetched << " -> " << po.after.bytesFetched
+               << io::endl;
+    }
+}
+
 void ResourceLoader::Impl::computeTangents(FFilamentAsset* asset) {
     SYSTRACE_CALL();
 
@@ -27,10 +27,47 @@
 #include <cgltf.h>
 #include <meshoptimizer.h>
 
+#include <math/vec3.h>
+
+#include <vector>
+
+#include <string.h>
+
 namespace filament::gltfio::utility {
 
 using namespace utils;
 
+namespace {
+
+// Writable data of an accessor, which has been loaded (or decoded) in memory.
+uint8_t* getAccessorData(cgltf_accessor const* accessor) {
+    cgltf_buffer_view const* view = accessor->buffer_view;
+    if (!view || accessor->is_sparse) {
+        return nullptr;
+    }
+    if (view->has_meshopt_compression) {
+        return view->data ? (uint8_t*) view->data + accessor->offset : nullptr;
+    }
+    if (!view->buffer->data) {
+        return nullptr;
+    }
+    return (uint8_t*) view->buffer->data + view->offset + accessor->offset;
+}
+
+MeshStatistics analyze(std::vector<uint32_t> const& indices,
+        std::vector<math::float3> const& positions, size_t vertexSize) {
+    return {
+        .acmr = meshopt_analyzeVertexCache(indices.data(), indices.size(), positions.size(),
+                16, 0, 0).acmr,
+        .overdraw = meshopt_analyzeOverdraw(indices.data(), indices.size(), &positions[0].x,
+                positions.size(), sizeof(math::float3)).overdraw,
+        .bytesFetched = meshopt_analyzeVertexFetch(indices.data(), indices.size(),
+                positions.size(), vertexSize).bytes_fetched,
+    };
+}
+
+} // anonymous namespace
+
 void decodeDracoMeshes(cgltf_data const* gltf, cgltf_primitive const* prim,
         DracoCache* dracoCache) {
     if (!prim->has_draco_mesh_compression) {
@@ -85,59 +122,63 @@ void decodeDracoMeshes(cgltf_data const* gltf, cgltf_primitive const* prim,
 
 void decodeMeshoptCompression(cgltf_data* data) {
     for (size_t i = 0; i < data->buffer_views_count; ++i) {
-        if (!data->buffer_views[i].has_meshopt_compression) {
-            continue;
-        }
-        cgltf_meshopt_compression* compression = &data->buffer_views[i].meshopt_compression;
-        const uint8_t* source = (const uint8_t*) compression->buffer->data;
-        assert_invariant(source);
-        source += compression->offset;
-
-        // This memory is freed by cgltf.
-        void* destination = malloc(compression->count * compression->stride);
-        assert_invariant(destination);
-
-        UTILS_UNUSED_IN_RELEASE int error = 0;
-        switch (compression->mode) {
-            case cgltf_meshopt_compression_mode_invalid:
-                break;
-            case cgltf_meshopt_compression_mode_attributes:
-                error = meshopt_decodeVertexBuffer(destination, compression->count,
-                        compression->stride, source, compression->size);
-                break;
-            case cgltf_meshopt_compression_mode_triangles:
-                error = meshopt_decodeIndexBuffer(destination, compression->count,
-                        compression->stride, source, compression->size);
-                break;
-            case cgltf_meshopt_compression_mode_indices:
-                error = meshopt_decodeIndexSequence(destination, compression->count,
-                        compression->stride, source, compression->size);
-                break;
-            default:
-                assert_invariant(false);
-                break;
-        }
-        assert_invariant(!error);
+        decodeMeshoptCompression(&data->buffer_views[i]);
+    }
+}
 
-        switch (compression->filter) {
-            case cgltf_meshopt_compression_filter_none:
-                break;
-            case cgltf_meshopt_compression_filter_octahedral:
-                meshopt_decodeFilterOct(destination, compression->count, compression->stride);
-                break;
-            case cgltf_meshopt_compression_filter_quaternion:
-                meshopt_decodeFilterQuat(destination, compression->count, compression->stride);
-                break;
-            case cgltf_meshopt_compression_filter_exponential:
-                meshopt_decodeFilterExp(destination, compression->count, compression->stride);
-                break;
-            default:
-                assert_invariant(false);
-                break;
-        }
+void decodeMeshoptCompression(cgltf_buffer_view* view) {
+    if (!view->has_meshopt_compression) {
+        return;
+    }
+    cgltf_meshopt_compression* compression = &view->meshopt_compression;
+    const uint8_t* source = (const uint8_t*) compression->buffer->data;
+    assert_invariant(source);
+    source += compression->offset;
+
+    // This memory is freed by cgltf.
+    void* destination = malloc(compression->count * compression->stride);
+    assert_invariant(destination);
+
+    UTILS_UNUSED_IN_RELEASE int error = 0;
+    switch (compression->mode) {
+        case cgltf_meshopt_compression_mode_invalid:
+            break;
+        case cgltf_meshopt_compression_mode_attributes:
+            error = meshopt_decodeVertexBuffer(destination, compression->count,
+                    compression->stride, source, compression->size);
+            break;
+        case cgltf_meshopt_compression_mode_triangles:
+            error = meshopt_decodeIndexBuffer(destination, compression->count,
+                    compression->stride, source, compression->size);
+            break;
+        case cgltf_meshopt_compression_mode_indices:
+            error = meshopt_decodeIndexSequence(destination, compression->count,
+                    compression->stride, source, compression->size);
+            break;
+        default:
+            assert_invariant(false);
+            break;
+    }
+    assert_invariant(!error);
 
-        data->buffer_views[i].data = destination;
+    switch (compression->filter) {
+        case cgltf_meshopt_compression_filter_none:
+            break;
+        case cgltf_meshopt_compression_filter_octahedral:
+            meshopt_decodeFilterOct(destination, compression->count, compression->stride);
+            break;
+        case cgltf_meshopt_compression_filter_quaternion:
+            meshopt_decodeFilterQuat(destination, compression->count, compression->stride);
+            break;
+        case cgltf_meshopt_compression_filter_exponential:
+            meshopt_decodeFilterExp(destination, compression->count, compression->stride);
+            break;
+        default:
+            assert_invariant(false);
+            break;
     }
+
+    view->data = destination;
 }
 
 bool primitiveHasVertexColor(cgltf_primitive* inPrim) {
@@ -262,4 +303,112 @@ bool loadCgltfBuffers(cgltf_data const* gltf, char const* gltfPath,
     return true;
 }
 
+bool optimizePrimitive(cgltf_primitive const* prim, bool reorderVertices,
+        MeshStatistics* before, MeshStatistics* after) {
+    cgltf_accessor const* indices = prim->indices;
+    cgltf_accessor const* positions = nullptr;
+    for (cgltf_size i = 0; i < prim->attributes_count; i++) {
+        const cgltf_attribute& attr = prim->attributes[i];
+        if (attr.type == cgltf_attribute_type_position && attr.index == 0) {
+            positions = attr.data;
+        }
+    }
+    if (prim->type != cgltf_primitive_type_triangles || !indices || !positions ||
+            indices->count % 3 != 0) {
+        return false;
+    }
+    uint8_t* const indexData = getAccessorData(indices);
+    if (!indexData || !getAccessorData(positions)) {
+        return false;
+    }
+
+    const size_t indexCount = indices->count;
+    const size_t vertexCount = positions->count;
+    std::vector<uint32_t> triangles(indexCount);
+    for (size_t i = 0; i < indexCount; i++) {
+        triangles[i] = uint32_t(cgltf_accessor_read_index(indices, i));
+        if (triangles[i] >= vertexCount) {
+            return false;
+        }
+    }
+    std::vector<math::float3> points(vertexCount);
+    cgltf_accessor_unpack_floats(positions, &points[0].x, vertexCount * 3);
+
+    // Every vertex attribute of the primitive is remapped, or none is.
+    std::vector<cgltf_accessor const*> vertexAccessors;
+    size_t vertexSize = 0;
+    for (cgltf_size i = 0; i < prim->attributes_count; i++) {
+        cgltf_accessor const* accessor = prim->attributes[i].data;
+        vertexAccessors.push_back(accessor);
+        vertexSize += cgltf_calc_size(accessor->type, accessor->component_type);
+    }
+    for (cgltf_size t = 0; t < prim->targets_count; t++) {
+        for (cgltf_size i = 0; i < prim->targets[t].attributes_count; i++) {
+            vertexAccessors.push_back(prim->targets[t].attributes[i].data);
+        }
+    }
+    for (cgltf_accessor const* accessor : vertexAccessors) {
+        if (accessor->count != vertexCount || !getAccessorData(accessor)) {
+            reorderVertices = false;
+        }
+    }
+
+    if (before) {
+        *before = analyze(triangles, points, vertexSize);
+    }
+
+    meshopt_optimizeVertexCache(triangles.data(), triangles.data(), indexCount, vertexCount);
+    meshopt_optimizeOverdraw(triangles.data(), triangles.data(), indexCount, &points[0].x,
+            vertexCount, sizeof(math::float3), 1.05f);
+
+    if (reorderVertices) {
+        std::vector<uint32_t> remap(vertexCount);
+        size_t next = meshopt_optimizeVertexFetchRemap(remap.data(), triangles.data(), indexCount,
+                vertexCount);
+        // Unreferenced vertices are moved at the end, so that the accessors keep their size.
+        for (uint32_t& index : remap) {
+            if (index == ~0u) {
+                index = uint32_t(next++);
+            }
+        }
+        meshopt_remapIndexBuffer(triangles.data(), triangles.data(), indexCount, remap.data());
+        meshopt_remapVertexBuffer(points.data(), points.data(), vertexCount, sizeof(math::float3),
+                remap.data());
+
+        std::vector<uint8_t> scratch;
+        for (cgltf_accessor const* accessor : vertexAccessors) {
+            uint8_t* const data = getAccessorData(accessor);
+            const size_t elementSize = cgltf_calc_size(accessor->type, accessor->component_type);
+            scratch.resize(elementSize * vertexCount);
+            for (size_t i = 0; i < vertexCount; i++) {
+                memcpy(scratch.data() + remap[i] * elementSize, data + i * accessor->stride,
+                        elementSize);
+            }
+            for (size_t i = 0; i < vertexCount; i++) {
+                memcpy(data + i * accessor->stride, scratch.data() + i * elementSize, elementSize);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < indexCount; i++) {
+        uint8_t* const element = indexData + i * indices->stride;
+        switch (indices->component_type) {
+            case cgltf_component_type_r_8u:
+                *element = uint8_t(triangles[i]);
+                break;
+            case cgltf_component_type_r_16u:
+                *(uint16_t*) element = uint16_t(triangles[i]);
+                break;
+            default:
+                *(uint32_t*) element = triangles[i];
+                break;
+        }
+    }
+
+    if (after) {
+        *after = analyze(triangles, points, vertexSize);
+    }
+    return true;
+}
+
 } // namespace filament::gltfio::utility
@@ -27,6 +27,7 @@
 struct FFilamentAsset;
 struct cgltf_primitive;
 struct cgltf_data;
+struct cgltf_buffer_view;
 class DracoCache;
 
 struct cgltf_accessor;
@@ -45,6 +46,8 @@ namespace filament::gltfio::utility {
 // Functions that are shared between the original implementation and the extended implementation.
 void decodeDracoMeshes(cgltf_data const* gltf, cgltf_primitive const* prim, DracoCache* dracoCache);
 void decodeMeshoptCompression(cgltf_data* data);
+// Decodes a single buffer view, buffer views can be decoded concurrently.
+void decodeMeshoptCompression(cgltf_buffer_view* view);
 bool primitiveHasVertexColor(cgltf_primitive* inPrim);
 uint32_t computeBindingSize(cgltf_accessor const* accessor);
 void convertBytesToShorts(uint16_t* dst, uint8_t const* src, size_t count);
@@ -54,6 +57,22 @@ bool requiresPacking(cgltf_accessor const* accessor);
 bool loadCgltfBuffers(cgltf_data const* gltf, char const* gltfPath,
         UriDataCacheHandle uriDataCacheHandle);
 
+// Vertex processing efficiency of a primitive, as estimated by meshoptimizer.
+struct MeshStatistics {
+    float acmr;           // average number of vertices transformed per triangle (16-entry cache)
+    float overdraw;       // average number of times a covered pixel is shaded
+    size_t bytesFetched;  // vertex data fetched from memory when the triangles are drawn
+};
+
+// Reorders the triangles of an indexed TRIANGLES primitive for the post-transform vertex cache,
+// then for overdraw, in place in its index buffer. If reorderVertices is true, its vertices
+// (including morph targets) are also reordered for fetch locality, in which case the caller
+// guarantees that no other primitive references its accessors. Primitives that cannot be
+// processed (e.g. sparse or unloaded accessors) are left untouched and false is returned.
+// Primitives that do not share any accessor can be optimized concurrently.
+bool optimizePrimitive(cgltf_primitive const* prim, bool reorderVertices,
+        MeshStatistics* before = nullptr, MeshStatistics* after = nullptr);
+
 } // namespace filament::gltfio::utility
 
 #endif
@@ -33,9 +33,15 @@
 #include <utils/NameComponentManager.h>
 #include <utils/Path.h>
 
+#include <cgltf.h>
+
 #include "materials/uberarchive.h"
+#include "../src/Utility.h"
 
+#include <algorithm>
+#include <array>
 #include <fstream>
+#include <random>
 #include <unordered_map>
 
 using namespace filament;
@@ -236,6 +242,109 @@ TEST_F(glTFIOTest, AnimatedMorphCubeRenderables) {
     EXPECT_EQ(morphTargetBuffer->getVertexCount(), 24u);
 }
 
+// A grid whose triangles are shuffled is reordered for the vertex cache and for fetch locality,
+// keeping its triangles and the association of its attributes.
+TEST(glTFIOUtilityTest, OptimizePrimitive) {
+    constexpr uint16_t N = 128; // quads per side, the vertices exceed the fetch cache
+    constexpr uint16_t V = N + 1;
+    std::vector<math::float3> positions;
+    std::vector<math::float2> uvs;
+    for (uint16_t y = 0; y < V; y++) {
+        for (uint16_t x = 0; x < V; x++) {
+            positions.push_back({ x, y, 0 });
+            uvs.push_back({ x, y });
+        }
+    }
+    std::vector<std::array<uint16_t, 3>> triangles;
+    for (uint16_t y = 0; y < N; y++) {
+        for (uint16_t x = 0; x < N; x++) {
+            const uint16_t i = y * V + x;
+            triangles.push_back({ i, uint16_t(i + 1), uint16_t(i + V) });
+            triangles.push_back({ uint16_t(i + 1), uint16_t(i + V + 1), uint16_t(i + V) });
+        }
+    }
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(1234));
+
+    const size_t positionsSize = positions.size() * sizeof(math::float3);
+    const size_t uvsSize = uvs.size() * sizeof(math::float2);
+    const size_t indicesSize = triangles.size() * sizeof(triangles[0]);
+    std::vector<uint8_t> storage(positionsSize + uvsSize + indicesSize);
+    memcpy(storage.data(), positions.data(), positionsSize);
+    memcpy(storage.data() + positionsSize, uvs.data(), uvsSize);
+    memcpy(storage.data() + positionsSize + uvsSize, triangles.data(), indicesSize);
+
+    cgltf_buffer buffer{};
+    buffer.size = storage.size();
+    buffer.data = storage.data();
+    cgltf_buffer_view views[3]{};
+    cgltf_accessor accessors[3]{};
+    const size_t offsets[3] = { 0, positionsSize, positionsSize + uvsSize };
+    const size_t sizes[3] = { positionsSize, uvsSize, indicesSize };
+    for (int i = 0; i < 3; i++) {
+        views[i].buffer = &buffer;
+        views[i].offset = offsets[i];
+        views[i].size = sizes[i];
+        accessors[i].buffer_view = &views[i];
+    }
+    accessors[0].type = cgltf_type_vec3;
+    accessors[0].component_type = cgltf_component_type_r_32f;
+    accessors[0].count = positions.size();
+    accessors[0].stride = sizeof(math::float3);
+    accessors[1].type = cgltf_type_vec2;
+    accessors[1].component_type = cgltf_component_type_r_32f;
+    accessors[1].count = uvs.size();
+    accessors[1].stride = sizeof(math::float2);
+    accessors[2].type = cgltf_type_scalar;
+    accessors[2].component_type = cgltf_component_type_r_16u;
+    accessors[2].count = triangles.size() * 3;
+    accessors[2].stride = sizeof(uint16_t);
+
+    cgltf_attribute attributes[2]{};
+    attributes[0].type = cgltf_attribute_type_position;
+    attributes[0].data = &accessors[0];
+    attributes[1].type = cgltf_attribute_type_texcoord;
+    attributes[1].data = &accessors[1];
+    cgltf_primitive prim{};
+    prim.type = cgltf_primitive_type_triangles;
+    prim.indices = &accessors[2];
+    prim.attributes = attributes;
+    prim.attributes_count = 2;
+
+    utility::MeshStatistics before{}, after{};
+    ASSERT_TRUE(utility::optimizePrimitive(&prim, true, &before, &after));
+    EXPECT_LT(after.acmr, before.acmr);
+    EXPECT_LT(after.bytesFetched, before.bytesFetched);
+
+    auto const* optimizedPositions = (math::float3 const*) storage.data();
+    auto const* optimizedUvs = (math::float2 const*) (storage.data() + positionsSize);
+    auto const* optimizedIndices = (uint16_t const*) (storage.data() + positionsSize + uvsSize);
+    for (size_t i = 0; i < positions.size(); i++) {
+        EXPECT_EQ(optimizedUvs[i], optimizedPositions[i].xy);
+    }
+
+    // Triangles are compared by the grid coordinates of their vertices, with their winding.
+    using Triangle = std::array<uint32_t, 3>;
+    auto canonical = [](Triangle t) {
+        std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+        return t;
+    };
+    std::vector<Triangle> expected, actual;
+    for (auto const& t : triangles) {
+        expected.push_back(canonical({ t[0], t[1], t[2] }));
+    }
+    for (size_t i = 0; i < triangles.size(); i++) {
+        Triangle t;
+        for (int k = 0; k < 3; k++) {
+            math::float3 const p = optimizedPositions[optimizedIndices[i * 3 + k]];
+            t[k] = uint32_t(p.y) * V + uint32_t(p.x);
+        }
+        actual.push_back(canonical(t));
+    }
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    EXPECT_EQ(expected, actual);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();